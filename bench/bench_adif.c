@@ -0,0 +1,254 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ *
+ *  ADIF import benchmark: regex reader with per record autocommit
+ *  vs streaming reader with prepared insert and batched transactions
+ *
+ *  Usage: bench_adif [records] [dir]
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "src/adif.h"
+
+#include <regex.h>
+#include <sqlite3.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BATCH_SIZE  500
+
+static const char *create_sql =
+    "CREATE TABLE IF NOT EXISTS qso_log( "
+        "ts TIMESTAMP DEFAULT CURRENT_TIMESTAMP, freq REAL CHECK ( freq > 0 ), band INT NOT NULL, "
+        "mode INT NOT NULL, local_callsign TEXT NOT NULL, remote_callsign TEXT NOT NULL, "
+        "canonized_remote_callsign TEXT NOT NULL, rsts INTEGER NOT NULL, rstr INTEGER NOT NULL, "
+        "local_qth TEXT, remote_qth TEXT, local_grid TEXT, remote_grid TEXT, op_name TEXT, comment TEXT);"
+    "CREATE INDEX IF NOT EXISTS qso_log_idx_canonized_remote_callsign ON qso_log(canonized_remote_callsign COLLATE NOCASE);"
+    "CREATE UNIQUE INDEX IF NOT EXISTS qso_log_idx_ts_call ON qso_log(ts, remote_callsign);";
+
+static const char *insert_sql =
+    "INSERT OR IGNORE INTO qso_log ("
+        "ts, freq, band, mode, local_callsign, remote_callsign, rsts, rstr, "
+        "local_grid, remote_grid, op_name, canonized_remote_callsign"
+    ") VALUES (datetime(?, 'unixepoch'), ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+
+/* Same as in qso_log.c */
+qso_log_band_t qso_log_freq_to_band(uint64_t freq_hz) {
+    uint32_t freq_khz = freq_hz / 1000;
+
+    switch (freq_khz) {
+        case 1800 ... 2000: return BAND_160M;
+        case 3500 ... 4000: return BAND_80M;
+        case 5351 ... 5367: return BAND_60M;
+        case 7000 ... 7300: return BAND_40M;
+        case 10100 ... 10150: return BAND_30M;
+        case 14000 ... 14350: return BAND_20M;
+        case 18068 ... 18168: return BAND_17M;
+        case 21000 ... 21450: return BAND_15M;
+        case 24890 ... 24990: return BAND_12M;
+        case 28000 ... 29700: return BAND_10M;
+        case 50000 ... 54000: return BAND_6M;
+        default: return BAND_OTHER;
+    }
+}
+
+static double now_s() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void generate(const char *path, size_t count) {
+    FILE *fd = fopen(path, "w");
+    adif_log log;
+
+    fprintf(fd, "<PROGRAMID:5>BENCH\r\n<ADIF_VER:4>3.14\r\n<EOH>\r\n");
+    fclose(fd);
+
+    log = adif_log_init(path);
+    for (size_t i = 0; i < count; i++) {
+        char call[16];
+
+        snprintf(call, sizeof(call), "R%zuAB%c", i % 10, 'A' + (int)(i % 26));
+        qso_log_record_t rec = {
+            .time = 1700000000 + i * 60,
+            .mode = (i % 3) ? MODE_FT8 : MODE_CW,
+            .rsts = -10,
+            .rstr = -12,
+            .freq_mhz = 14.074f,
+            .band = BAND_20M,
+        };
+        strcpy(rec.local_call, "X6100");
+        strcpy(rec.remote_call, call);
+        strcpy(rec.local_grid, "LO02");
+        strcpy(rec.remote_grid, "KN23");
+        adif_add_qso(log, rec);
+    }
+    adif_log_close(log);
+}
+
+static sqlite3 * open_db(const char *path) {
+    sqlite3 *db;
+
+    unlink(path);
+    sqlite3_open(path, &db);
+    sqlite3_exec(db, create_sql, NULL, NULL, NULL);
+    return db;
+}
+
+static void bind_record(sqlite3_stmt *stmt, const qso_log_record_t *r) {
+    sqlite3_bind_int64(stmt, 1, r->time);
+    sqlite3_bind_double(stmt, 2, r->freq_mhz);
+    sqlite3_bind_int(stmt, 3, r->band);
+    sqlite3_bind_int(stmt, 4, r->mode);
+    sqlite3_bind_text(stmt, 5, r->local_call, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 6, r->remote_call, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 7, r->rsts);
+    sqlite3_bind_int(stmt, 8, r->rstr);
+    sqlite3_bind_text(stmt, 9, r->local_grid, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 10, r->remote_grid, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 11, r->name, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 12, r->remote_call, -1, SQLITE_STATIC);
+}
+
+/* Previous adif_read(): whole file to array with regex matching */
+static size_t legacy_read(const char *path, qso_log_record_t **records) {
+    char        *line = NULL;
+    size_t      len = 0;
+    ssize_t     read;
+    FILE        *fp = fopen(path, "r");
+    regex_t     regex;
+    regmatch_t  pmatch[3];
+    size_t      arr_size = 128, cnt = 0;
+
+    regcomp(&regex, "<([A-Za-z_]+):([0-9]+)>", REG_NEWLINE | REG_EXTENDED);
+    *records = malloc(arr_size * sizeof(qso_log_record_t));
+
+    while ((read = getline(&line, &len, fp)) != -1) {
+        if (read < 7 || strcmp(line + read - 7, "<EOR>\r\n") != 0) continue;
+
+        char                *s = line;
+        qso_log_record_t    *rec = &(*records)[cnt];
+        struct tm           qso_ts = {0};
+
+        memset(rec, 0, sizeof(*rec));
+        while (!regexec(&regex, s, 3, pmatch, 0)) {
+            size_t      val_len = atoi(s + pmatch[2].rm_so);
+            const char  *tag = s + pmatch[1].rm_so;
+            size_t      tag_len = pmatch[1].rm_eo - pmatch[1].rm_so;
+            const char  *val = s + pmatch[0].rm_eo;
+
+            if (val_len > 0) {
+                if (strncmp(tag, "OPERATOR", tag_len) == 0) {
+                    strncpy(rec->local_call, val, val_len < 31 ? val_len : 31);
+                } else if (strncmp(tag, "CALL", tag_len) == 0) {
+                    strncpy(rec->remote_call, val, val_len < 31 ? val_len : 31);
+                } else if (strncmp(tag, "QSO_DATE", tag_len) == 0) {
+                    strptime(val, "%Y%m%d", &qso_ts);
+                } else if (strncmp(tag, "TIME_ON", tag_len) == 0) {
+                    strptime(val, "%H%M", &qso_ts);
+                } else if (strncmp(tag, "FREQ", tag_len) == 0) {
+                    rec->freq_mhz = strtof(val, NULL);
+                } else if (strncmp(tag, "GRIDSQUARE", tag_len) == 0) {
+                    strncpy(rec->remote_grid, val, val_len < 7 ? val_len : 7);
+                }
+            }
+            s += pmatch[0].rm_eo;
+        }
+        rec->time = mktime(&qso_ts);
+        if (++cnt >= arr_size) {
+            arr_size *= 2;
+            *records = realloc(*records, arr_size * sizeof(qso_log_record_t));
+        }
+    }
+    free(line);
+    fclose(fp);
+    regfree(&regex);
+    return cnt;
+}
+
+static void bench_legacy(const char *adi, const char *db_path) {
+    qso_log_record_t    *records;
+    sqlite3             *db = open_db(db_path);
+    double              start = now_s();
+    size_t              cnt = legacy_read(adi, &records);
+    double              parsed = now_s();
+
+    for (size_t i = 0; i < cnt; i++) {
+        sqlite3_stmt *stmt;
+
+        sqlite3_prepare_v2(db, insert_sql, -1, &stmt, 0);
+        bind_record(stmt, &records[i]);
+        sqlite3_step(stmt);
+        sqlite3_finalize(stmt);
+    }
+    double done = now_s();
+
+    printf("%-10s %8zu records, parse %7.3f s, insert %7.3f s, total %7.3f s\n",
+           "legacy", cnt, parsed - start, done - parsed, done - start);
+    free(records);
+    sqlite3_close(db);
+}
+
+static void bench_stream(const char *adi, const char *db_path) {
+    sqlite3             *db = open_db(db_path);
+    sqlite3_stmt        *stmt;
+    qso_log_record_t    rec;
+    size_t              cnt = 0;
+    double              parse = 0.0;
+    double              start = now_s();
+    adif_reader         reader = adif_reader_open(adi);
+    bool                more = true;
+
+    sqlite3_prepare_v3(db, insert_sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, 0);
+    while (more) {
+        sqlite3_exec(db, "BEGIN", NULL, NULL, NULL);
+        for (size_t batch = 0; batch < BATCH_SIZE; batch++) {
+            double t = now_s();
+
+            more = adif_reader_next(reader, &rec);
+            parse += now_s() - t;
+            if (!more) {
+                break;
+            }
+            sqlite3_reset(stmt);
+            bind_record(stmt, &rec);
+            sqlite3_step(stmt);
+            cnt++;
+        }
+        sqlite3_exec(db, "COMMIT", NULL, NULL, NULL);
+    }
+    double done = now_s();
+
+    printf("%-10s %8zu records, parse %7.3f s, insert %7.3f s, total %7.3f s\n",
+           "stream", cnt, parse, done - start - parse, done - start);
+    adif_reader_close(reader);
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+}
+
+int main(int argc, char **argv) {
+    size_t      count = argc > 1 ? atoi(argv[1]) : 50000;
+    const char  *dir = argc > 2 ? argv[2] : ".";
+    char        adi[256], db[256];
+
+    snprintf(adi, sizeof(adi), "%s/bench_adif.adi", dir);
+    snprintf(db, sizeof(db), "%s/bench_adif.db", dir);
+
+    generate(adi, count);
+    bench_stream(adi, db);
+    bench_legacy(adi, db);
+
+    unlink(adi);
+    unlink(db);
+    return 0;
+}
@@ -0,0 +1,257 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ *
+ *  CW skimmer cost: filter bank channels vs CPU. Synthesized stations go through
+ *  the same Hilbert transform as dsp_put_audio_samples() and then the skimmer
+ *  with different count of channels
+ *
+ *  Usage: bench_cw_skimmer [-c] [-s snr] [-n stations] [-l seconds] [-d decoders] [-r seed]
+ *
+ *  SNR is in 500 Hz. With -c exit code is 1 if some callsigns are missed or
+ *  there are false ones with the channels of cw.cpp
+ */
+
+#include "src/skimmer/skimmer.h"
+#include "src/cw_decoder.h"
+#include "src/audio.h"
+
+#include <complex.h>
+#include <liquid/liquid.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CW_CHANNELS     512     /* Same as in cw.cpp */
+#define FREQ_FROM       150
+#define FREQ_TO         3000
+#define MAX_STATIONS    16
+#define RAMP            0.005f  /* s, keying edges */
+#define SIGNAL_AMP      0.05f
+#define REF_BANDWIDTH   500.0f
+#define BLOCK           1024
+
+typedef struct {
+    float   freq;
+    int     wpm;
+    float   start;              /* s */
+    char    text[64];
+    char    *keying;            /* Per 1 ms */
+    size_t  keying_len;
+} station_t;
+
+static const char *calls[] = {
+    "R1CBU", "R2RFE", "UA3ABC", "DL1ABC", "G4XYZ", "K1ABC", "JA1XYZ", "RA1XYZ",
+    "OH2BH", "W1AW", "VK2ABC", "EA8XYZ", "SP5ABC", "OK1XYZ", "HA5ABC", "F5XYZ",
+};
+
+static const uint16_t channels_list[] = { 128, 256, 512, 1024 };
+
+static station_t    stations[MAX_STATIONS];
+static int          n_stations = 8;
+
+static double cpu_ms() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static float randn() {
+    float u1 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+    float u2 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * M_PI * u2);
+}
+
+static const char * morse_code(char c) {
+    for (cw_characters_t *ch = &cw_characters[0]; ch->morse; ch++) {
+        if (ch->character[0] == c && ch->character[1] == '\0') {
+            return ch->morse;
+        }
+    }
+    return NULL;
+}
+
+static void key(station_t *st, bool on, int ms) {
+    st->keying = realloc(st->keying, st->keying_len + ms);
+    memset(st->keying + st->keying_len, on, ms);
+    st->keying_len += ms;
+}
+
+static void make_keying(station_t *st) {
+    int dot = 1200 / st->wpm;
+
+    key(st, false, st->start * 1000);
+
+    for (const char *c = st->text; *c; c++) {
+        if (*c == ' ') {
+            key(st, false, dot * 4);
+            continue;
+        }
+        for (const char *e = morse_code(*c); *e; e++) {
+            key(st, true, *e == '.' ? dot : dot * 3);
+            key(st, false, dot);
+        }
+        key(st, false, dot * 2);
+    }
+}
+
+static void make_stations() {
+    float step = 2500.0f / n_stations;
+
+    for (int i = 0; i < n_stations; i++) {
+        station_t *st = &stations[i];
+
+        /* Spread over the passband with a random offset from the channel centers */
+        st->freq = 300.0f + step * i + (rand() % 1000) / 1000.0f * step / 2.0f;
+        st->wpm = 16 + rand() % 15;
+        st->start = (rand() % 3000) / 1000.0f;
+        snprintf(st->text, sizeof(st->text), "CQ CQ DE %s %s K", calls[i], calls[i]);
+        make_keying(st);
+    }
+}
+
+/* Real audio like from the codec, then analytic as in dsp.cpp */
+static cfloat * synth_audio(float snr, float sec, size_t *n) {
+    firhilbf    hilb = firhilbf_create(7, 60.0f);
+    float       noise = SIGNAL_AMP / sqrtf(2.0f) / powf(10.0f, snr / 20.0f) * sqrtf(AUDIO_CAPTURE_RATE / 2.0f / REF_BANDWIDTH);
+    float       env[MAX_STATIONS] = { 0 };
+
+    *n = sec * AUDIO_CAPTURE_RATE;
+
+    cfloat *samples = malloc(*n * sizeof(cfloat));
+
+    for (size_t i = 0; i < *n; i++) {
+        size_t  ms = i * 1000 / AUDIO_CAPTURE_RATE;
+        float   x = noise * randn();
+
+        for (int k = 0; k < n_stations; k++) {
+            station_t   *st = &stations[k];
+            bool        on = ms < st->keying_len && st->keying[ms];
+
+            env[k] += on ? 1.0f / (RAMP * AUDIO_CAPTURE_RATE) : -1.0f / (RAMP * AUDIO_CAPTURE_RATE);
+            env[k] = fminf(1.0f, fmaxf(0.0f, env[k]));
+
+            x += SIGNAL_AMP * env[k] * cosf(2.0f * M_PI * st->freq * i / AUDIO_CAPTURE_RATE);
+        }
+        firhilbf_r2c_execute(hilb, x, &samples[i]);
+    }
+
+    firhilbf_destroy(hilb);
+    return samples;
+}
+
+static int found_calls(skimmer_item_t *items, size_t n, uint16_t channels, int *false_calls) {
+    int found = 0;
+
+    *false_calls = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        bool ok = false;
+
+        for (int k = 0; k < n_stations; k++) {
+            if (strcmp(items[i].call, calls[k]) == 0 && fabsf(items[i].freq - stations[k].freq) <= (float) AUDIO_CAPTURE_RATE / channels) {
+                ok = true;
+            }
+        }
+
+        if (ok) {
+            found++;
+        } else if (items[i].call[0]) {
+            (*false_calls)++;
+            printf("  false call: %s (%u Hz)\n", items[i].call, items[i].freq);
+        }
+    }
+    return found;
+}
+
+int main(int argc, char *argv[]) {
+    bool    check = false;
+    float   snr = 20.0f;
+    float   sec = 30.0f;
+    int     decoders = 16;
+    int     seed = 1;
+    int     opt;
+    int     result = 0;
+
+    while ((opt = getopt(argc, argv, "cs:n:l:d:r:")) != -1) {
+        switch (opt) {
+            case 'c':
+                check = true;
+                break;
+            case 's':
+                snr = atof(optarg);
+                break;
+            case 'n':
+                n_stations = atoi(optarg);
+                break;
+            case 'l':
+                sec = atof(optarg);
+                break;
+            case 'd':
+                decoders = atoi(optarg);
+                break;
+            case 'r':
+                seed = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-c] [-s snr] [-n stations] [-l seconds] [-d decoders] [-r seed]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (n_stations < 1 || n_stations > MAX_STATIONS) {
+        fprintf(stderr, "Stations should be 1..%d\n", MAX_STATIONS);
+        return 1;
+    }
+
+    srand(seed);
+    make_stations();
+
+    size_t  n;
+    cfloat  *samples = synth_audio(snr, sec, &n);
+
+    for (int k = 0; k < n_stations; k++) {
+        printf("%6.0f Hz %2d WPM %s\n", stations[k].freq, stations[k].wpm, calls[k]);
+    }
+
+    printf("\n%8s %8s %8s %8s %9s %6s %8s %7s\n", "channels", "width Hz", "scanned", "decoders", "found", "false", "cpu ms", "cpu %");
+
+    for (size_t c = 0; c < sizeof(channels_list) / sizeof(channels_list[0]); c++) {
+        uint16_t        channels = channels_list[c];
+        skimmer_t       *s = skimmer_create(AUDIO_CAPTURE_RATE, channels, FREQ_FROM, FREQ_TO, decoders);
+        skimmer_item_t  items[MAX_STATIONS * 2];
+        int             false_calls;
+
+        double start = cpu_ms();
+
+        for (size_t pos = 0; pos < n; pos += BLOCK) {
+            skimmer_put_audio_samples(s, n - pos < BLOCK ? n - pos : BLOCK, &samples[pos]);
+        }
+
+        double  spent = cpu_ms() - start;
+        uint8_t active = skimmer_active(s);
+        size_t  heard = skimmer_list(s, items, MAX_STATIONS * 2);
+        int     found = found_calls(items, heard, channels, &false_calls);
+        int     scanned = lroundf(FREQ_TO * channels / (float) AUDIO_CAPTURE_RATE) - lroundf(FREQ_FROM * channels / (float) AUDIO_CAPTURE_RATE) + 1;
+
+        printf("%8u %8.1f %8d %8u %4d/%-4d %6d %8.1f %7.2f\n", channels, (float) AUDIO_CAPTURE_RATE / channels,
+               scanned, active, found, n_stations, false_calls, spent, spent / (sec * 10.0));
+
+        if (check && channels == CW_CHANNELS && (found < n_stations || false_calls > 0)) {
+            result = 1;
+        }
+        skimmer_destroy(s);
+    }
+
+    for (int k = 0; k < n_stations; k++) {
+        free(stations[k].keying);
+    }
+    free(samples);
+    return result;
+}
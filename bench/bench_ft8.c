@@ -0,0 +1,343 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ *
+ *  FT8/FT4 replay harness: recorded or synthesized slots go through the same
+ *  Hilbert transform, decimation and worker calls as rx_worker() in dialog_ft8.c
+ *
+ *  Usage: bench_ft8 [-4] [-c] [-t threads] slot.wav ...
+ *         bench_ft8 [-4] [-c] [-t threads] -s snr [-n messages] [-l slots] [-r seed]
+ *
+ *  WAV at AUDIO_CAPTURE_RATE is processed as the radio audio, other rates
+ *  are fed to the worker directly. Expected messages for slot.wav could be
+ *  listed in slot.wav.txt, one per line. With -c exit code is 1 if some
+ *  expected messages are missed or there are false decodes.
+ */
+
+#include "src/ft8/worker.h"
+#include "src/audio.h"
+
+#include <complex.h>
+#include <ft8lib/message.h>
+#include <liquid/liquid.h>
+#include <math.h>
+#include <sndfile.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DECIM           6       /* Same as in dialog_ft8.c */
+#define SAMPLE_RATE     (AUDIO_CAPTURE_RATE / DECIM)
+#define MAX_MESSAGES    16
+#define SIGNAL_AMP      0.01f
+#define REF_BANDWIDTH   2500.0f /* SNR reference bandwidth, Hz */
+
+typedef struct {
+    char    expected[MAX_MESSAGES][FTX_MAX_MESSAGE_LENGTH];
+    size_t  n_expected;
+    bool    found[MAX_MESSAGES];
+
+    size_t  messages;
+    size_t  false_decodes;
+    double  cpu_ms;
+    double  final_ms;
+} slot_stats_t;
+
+static const char *synth_texts[] = {
+    "CQ R2RFE KO85", "CQ DX R1CBU KO85", "R2RFE R1CBU KO85", "R1CBU R2RFE -12",
+    "R2RFE R1CBU R-08", "R1CBU R2RFE RR73", "CQ DL1ABC JO62", "DL1ABC G4XYZ IO91",
+    "G4XYZ DL1ABC -05", "CQ K1ABC FN42", "K1ABC JA1XYZ PM95", "UA3ABC RA1XYZ KP40",
+};
+
+static ftx_protocol_t   protocol = FTX_PROTOCOL_FT8;
+static int              max_threads = 2;
+
+static double cpu_ms() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static double now_ms() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static float randn() {
+    float u1 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+    float u2 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * M_PI * u2);
+}
+
+static void msg_cb(const char *text, int snr, float freq_hz, float time_sec, void *user_data) {
+    slot_stats_t *stats = (slot_stats_t *) user_data;
+
+    stats->messages++;
+
+    if (stats->n_expected == 0) {
+        return;
+    }
+    for (size_t i = 0; i < stats->n_expected; i++) {
+        if (strcmp(stats->expected[i], text) == 0) {
+            stats->found[i] = true;
+            return;
+        }
+    }
+    stats->false_decodes++;
+    printf("  false decode: %s (%.0f Hz, %.1f s)\n", text, freq_hz, time_sec);
+}
+
+/* Same sequence of calls as rx_worker() in dialog_ft8.c */
+static void replay(const float *samples, size_t n, int rate, int threads, slot_stats_t *stats) {
+    bool            radio_rate = rate == AUDIO_CAPTURE_RATE;
+    firhilbf        hilb = firhilbf_create(7, 60.0f);
+    firdecim_crcf   decim = firdecim_crcf_create_kaiser(DECIM, 8, 40.0f);
+
+    firdecim_crcf_set_scale(decim, 1.0f / DECIM);
+
+    ftx_worker_set_threads(threads);
+    ftx_worker_init(radio_rate ? SAMPLE_RATE : rate, protocol);
+
+    int             block_size = ftx_worker_get_block_size();
+    size_t          size = radio_rate ? block_size * DECIM : block_size;
+    float complex   *buf = malloc(size * sizeof(float complex));
+    float complex   *decim_buf = malloc(block_size * sizeof(float complex));
+
+    stats->messages = 0;
+    stats->false_decodes = 0;
+    memset(stats->found, 0, sizeof(stats->found));
+
+    double cpu_start = cpu_ms();
+
+    for (size_t pos = 0; pos + size <= n && !ftx_worker_is_full(); pos += size) {
+        if (radio_rate) {
+            for (size_t i = 0; i < size; i++) {
+                firhilbf_r2c_execute(hilb, samples[pos + i], &buf[i]);
+            }
+            firdecim_crcf_execute_block(decim, buf, block_size, decim_buf);
+        } else {
+            for (size_t i = 0; i < size; i++) {
+                decim_buf[i] = samples[pos + i];
+            }
+        }
+        ftx_worker_put_rx_samples(decim_buf, block_size);
+        ftx_worker_decode(msg_cb, false, stats);
+    }
+
+    double t = now_ms();
+    ftx_worker_decode(msg_cb, true, stats);
+    stats->final_ms = now_ms() - t;
+    stats->cpu_ms = cpu_ms() - cpu_start;
+
+    ftx_worker_reset();
+    ftx_worker_free();
+    firhilbf_destroy(hilb);
+    firdecim_crcf_destroy(decim);
+    free(buf);
+    free(decim_buf);
+}
+
+static float * read_wav(const char *path, int *rate, size_t *n) {
+    SF_INFO info = { 0 };
+    SNDFILE *f = sf_open(path, SFM_READ, &info);
+
+    if (!f) {
+        fprintf(stderr, "Can't open %s: %s\n", path, sf_strerror(NULL));
+        return NULL;
+    }
+
+    float *frames = malloc(info.frames * info.channels * sizeof(float));
+    float *mono = malloc(info.frames * sizeof(float));
+
+    sf_readf_float(f, frames, info.frames);
+    sf_close(f);
+
+    for (sf_count_t i = 0; i < info.frames; i++) {
+        mono[i] = frames[i * info.channels];
+    }
+    free(frames);
+
+    *rate = info.samplerate;
+    *n = info.frames;
+    return mono;
+}
+
+static void read_expected(const char *wav_path, slot_stats_t *stats) {
+    char path[512];
+    char line[128];
+
+    stats->n_expected = 0;
+    snprintf(path, sizeof(path), "%s.txt", wav_path);
+
+    FILE *f = fopen(path, "r");
+
+    if (!f) {
+        return;
+    }
+    while (stats->n_expected < MAX_MESSAGES && fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = 0;
+
+        if (strlen(line) > 0) {
+            strncpy(stats->expected[stats->n_expected++], line, FTX_MAX_MESSAGE_LENGTH - 1);
+        }
+    }
+    fclose(f);
+}
+
+/**
+ * Mix messages with random frequency and time offsets into white noise at AUDIO_CAPTURE_RATE
+ */
+static float * synth_slot(float snr, size_t n_msg, slot_stats_t *stats, size_t *n) {
+    float   slot_time = (protocol == FTX_PROTOCOL_FT8) ? FT8_SLOT_TIME : FT4_SLOT_TIME;
+    float   noise_var = SIGNAL_AMP * SIGNAL_AMP / 2.0f * (AUDIO_CAPTURE_RATE / 2.0f) / REF_BANDWIDTH / powf(10.0f, snr / 10.0f);
+    float   noise_amp = sqrtf(noise_var);
+    size_t  n_synth = sizeof(synth_texts) / sizeof(synth_texts[0]);
+    size_t  first = rand() % n_synth;
+
+    *n = slot_time * AUDIO_CAPTURE_RATE;
+
+    float *samples = malloc(*n * sizeof(float));
+
+    for (size_t i = 0; i < *n; i++) {
+        samples[i] = randn() * noise_amp;
+    }
+
+    /* Worker for the encoder only */
+    ftx_worker_set_threads(1);
+    ftx_worker_init(SAMPLE_RATE, protocol);
+
+    stats->n_expected = 0;
+
+    for (size_t m = 0; m < n_msg && m < n_synth && m < MAX_MESSAGES; m++) {
+        const char  *text = synth_texts[(first + m) % n_synth];
+        float       band = 2400.0f / n_msg;
+        uint16_t    freq = 300 + m * band + rand() % (int) (band / 2);
+        float       time = (rand() % 1000) / 1000.0f;  /* 0.5 s nominal start +- 0.5 s */
+        int16_t     *tx;
+        uint32_t    n_tx;
+
+        if (!ftx_worker_generate_tx_samples(text, freq, AUDIO_CAPTURE_RATE, &tx, &n_tx)) {
+            continue;
+        }
+
+        size_t offset = time * AUDIO_CAPTURE_RATE;
+
+        for (uint32_t i = 0; i < n_tx && offset + i < *n; i++) {
+            samples[offset + i] += tx[i] * SIGNAL_AMP / (32767.0f * 0.8f);
+        }
+        free(tx);
+        strcpy(stats->expected[stats->n_expected++], text);
+    }
+    ftx_worker_free();
+    return samples;
+}
+
+static size_t found_count(const slot_stats_t *stats) {
+    size_t found = 0;
+
+    for (size_t i = 0; i < stats->n_expected; i++) {
+        found += stats->found[i];
+    }
+    return found;
+}
+
+int main(int argc, char *argv[]) {
+    bool    synth = false;
+    bool    check = false;
+    float   snr = 0.0f;
+    int     n_msg = 8;
+    int     n_slots = 10;
+    int     seed = 1;
+    int     opt;
+
+    while ((opt = getopt(argc, argv, "4ct:s:n:l:r:")) != -1) {
+        switch (opt) {
+            case '4':
+                protocol = FTX_PROTOCOL_FT4;
+                break;
+            case 'c':
+                check = true;
+                break;
+            case 't':
+                max_threads = atoi(optarg);
+                break;
+            case 's':
+                synth = true;
+                snr = atof(optarg);
+                break;
+            case 'n':
+                n_msg = atoi(optarg);
+                break;
+            case 'l':
+                n_slots = atoi(optarg);
+                break;
+            case 'r':
+                seed = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-4] [-c] [-t threads] slot.wav ...\n"
+                                "       %s [-4] [-c] [-t threads] -s snr [-n messages] [-l slots] [-r seed]\n",
+                        argv[0], argv[0]);
+                return 1;
+        }
+    }
+
+    if (!synth && optind >= argc) {
+        fprintf(stderr, "No input, use slot.wav or -s snr\n");
+        return 1;
+    }
+
+    srand(seed);
+
+    size_t  total_expected = 0, total_found = 0, total_false = 0;
+    int     n_inputs = synth ? n_slots : argc - optind;
+
+    printf("%-24s %7s %9s %9s %6s %8s %9s\n", "slot", "threads", "messages", "found", "false", "cpu ms", "final ms");
+
+    for (int i = 0; i < n_inputs; i++) {
+        slot_stats_t    stats;
+        char            name[64];
+        int             rate = AUDIO_CAPTURE_RATE;
+        size_t          n;
+        float           *samples;
+
+        if (synth) {
+            samples = synth_slot(snr, n_msg, &stats, &n);
+            snprintf(name, sizeof(name), "synth %i (%.0f dB)", i, snr);
+        } else {
+            const char *path = argv[optind + i];
+
+            samples = read_wav(path, &rate, &n);
+            read_expected(path, &stats);
+            snprintf(name, sizeof(name), "%s", path);
+        }
+
+        if (!samples) {
+            continue;
+        }
+        for (int threads = 1; threads <= max_threads; threads++) {
+            replay(samples, n, rate, threads, &stats);
+
+            printf("%-24s %7d %9zu %4zu/%-4zu %6zu %8.1f %9.1f\n", name, threads, stats.messages,
+                   found_count(&stats), stats.n_expected, stats.false_decodes, stats.cpu_ms, stats.final_ms);
+        }
+        total_expected += stats.n_expected;
+        total_found += found_count(&stats);
+        total_false += stats.false_decodes;
+        free(samples);
+    }
+
+    printf("Found %zu of %zu, false %zu\n", total_found, total_expected, total_false);
+
+    if (check && (total_found < total_expected || total_false > 0)) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ *
+ *  Waterfall renderer benchmark: full frame redraw per row vs ring of rows
+ */
+
+#include "src/render/wf_render.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define WIDTH       800
+#define NFFT        1024
+#define WIDTH_HZ    100000
+#define FRAMES      200
+
+static uint32_t palette[256];
+
+static double now_us() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void fill_row(uint8_t *row, uint32_t seed) {
+    for (uint16_t x = 0; x < NFFT; x++) {
+        row[x] = (x * 7 + seed * 13) & 0xFF;
+    }
+}
+
+/* Copy of the previous redraw_cb() from waterfall.c */
+static void legacy_redraw(lv_color_t *frame, uint8_t *cache, int32_t *freq_offsets, uint16_t height,
+                          uint16_t last_row_id, int32_t wf_center_freq, uint8_t zoom) {
+    int32_t src_x_offset;
+    uint16_t src_y, src_x0, dst_y, dst_x;
+    lv_color_t black = lv_color_black();
+    lv_color_t px_color;
+    uint16_t x0_arr[WIDTH];
+    uint8_t x0_dist[WIDTH];
+
+    for (uint16_t i = 0; i < WIDTH; i++) {
+        float rel_screen_position = (((float) i + 0.5) / WIDTH) - 0.5f;
+        float src_px = ((rel_screen_position / zoom) + 0.5f) * NFFT + 0.5f;
+        x0_arr[i] = src_px;
+        x0_dist[i] = (src_px - x0_arr[i]) * 8;
+    }
+
+    for (src_y = 0; src_y < height; src_y++) {
+        dst_y = ((height - src_y + last_row_id) % height);
+        src_x_offset = (freq_offsets[src_y] - wf_center_freq) * NFFT / WIDTH_HZ;
+        if ((src_x_offset > NFFT) || (src_x_offset < -NFFT)) {
+            memset(frame + dst_y * WIDTH, 0, WIDTH * sizeof(lv_color_t));
+        } else {
+            for (dst_x = 0; dst_x < WIDTH; dst_x++) {
+                src_x0 = x0_arr[dst_x] - src_x_offset;
+                if ((src_x0 < 0) || (src_x0 >= NFFT - 1)) {
+                    px_color = black;
+                } else {
+                    uint8_t * y0_p = cache + (src_y * NFFT + src_x0);
+                    uint8_t y = *y0_p + ((x0_dist[dst_x] * (*(y0_p+1) - *y0_p)) >> 3);
+                    px_color = (lv_color_t)palette[y];
+                }
+                frame[dst_y * WIDTH + dst_x] = px_color;
+            }
+        }
+    }
+}
+
+static double bench_legacy(uint16_t height) {
+    lv_color_t  *frame = malloc(WIDTH * height * sizeof(lv_color_t));
+    uint8_t     *cache = calloc(height, NFFT);
+    int32_t     *freq_offsets = calloc(height, sizeof(int32_t));
+    uint16_t    last_row_id = 0;
+
+    double start = now_us();
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        last_row_id = (last_row_id + 1) % height;
+        fill_row(cache + last_row_id * NFFT, i);
+        freq_offsets[last_row_id] = 0;
+        legacy_redraw(frame, cache, freq_offsets, height, last_row_id, 0, 1);
+    }
+    double res = (now_us() - start) / FRAMES;
+
+    free(frame);
+    free(cache);
+    free(freq_offsets);
+    return res;
+}
+
+static double bench_ring(uint16_t height, bool scroll) {
+    wf_render_t *r = wf_render_create(WIDTH, height, NFFT, WIDTH_HZ);
+    volatile lv_color_t *top;
+
+    wf_render_clear(r, 0);
+    wf_render_set_view(r, 0, 1, palette);
+    wf_render_frame(r);
+
+    double start = now_us();
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        fill_row(wf_render_row_buf(r), i);
+        wf_render_commit_row(r, 0);
+        wf_render_set_view(r, scroll ? (int32_t) i * 10 : 0, 1, palette);
+        top = wf_render_frame(r);
+    }
+    double res = (now_us() - start) / FRAMES;
+
+    (void) top;
+    wf_render_destroy(r);
+    return res;
+}
+
+int main() {
+    const uint16_t heights[] = {100, 200, 300, 400};
+
+    for (uint16_t i = 0; i < 256; i++) {
+        palette[i] = i * 0x010101;
+    }
+
+    printf("%8s %14s %14s %14s\n", "height", "legacy us/fr", "ring us/fr", "ring+scroll");
+    for (size_t i = 0; i < sizeof(heights) / sizeof(heights[0]); i++) {
+        uint16_t h = heights[i];
+        printf("%8u %14.1f %14.1f %14.1f\n", h, bench_legacy(h), bench_ring(h, false), bench_ring(h, true));
+    }
+    return 0;
+}
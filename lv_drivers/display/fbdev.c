@@ -9,7 +9,11 @@
 #include "fbdev.h"
 #if USE_FBDEV || USE_BSD_FBDEV
 
+#include "fbdev_rotate.h"
+
 #include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
 #include <unistd.h>
 #include <stddef.h>
 #include <stdio.h>
@@ -33,6 +37,9 @@
 #define FBDEV_PATH  "/dev/fb0"
 #endif
 
+/*Max areas of one frame to copy to the other page, whole page is copied if there are more*/
+#define FBDEV_SYNC_AREAS    32
+
 #ifndef DIV_ROUND_UP
 #define DIV_ROUND_UP(n, d) (((n) + (d) - 1) / (d))
 #endif
@@ -61,6 +68,9 @@ struct bsd_fb_fix_info{
 /**********************
  *  STATIC PROTOTYPES
  **********************/
+static void double_buf_init(void);
+static void flush_32bpp(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p);
+static void page_flip(void);
 
 /**********************
  *  STATIC VARIABLES
@@ -76,6 +86,13 @@ static char *fbp = 0;
 static long int screensize = 0;
 static int fbfd = 0;
 
+/*Page flipping with FBIOPAN_DISPLAY*/
+static bool double_buf = false;
+static long int page_size = 0;
+static uint32_t back_page = 0;
+static lv_area_t sync_areas[FBDEV_SYNC_AREAS];
+static uint32_t sync_areas_cnt = 0;
+
 /**********************
  *      MACROS
  **********************/
@@ -159,6 +176,24 @@ void fbdev_init(void)
 
     LV_LOG_INFO("The framebuffer device was mapped to memory successfully");
 
+    double_buf_init();
+
+}
+
+void fbdev_init_mem(void * mem, uint32_t xres, uint32_t yres)
+{
+    memset(&vinfo, 0, sizeof(vinfo));
+    memset(&finfo, 0, sizeof(finfo));
+
+    vinfo.xres = xres;
+    vinfo.yres = yres;
+    vinfo.bits_per_pixel = 32;
+    finfo.line_length = xres * 4;
+    finfo.smem_len = finfo.line_length * yres;
+
+    fbp = mem;
+    screensize = 0;
+    double_buf = false;
 }
 
 void fbdev_exit(void)
@@ -175,6 +210,13 @@ void fbdev_exit(void)
  */
 void fbdev_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p)
 {
+    /*32 bit with rotation and page flipping. Area is in logical (rotated) coordinates, it is clipped there*/
+    if(fbp != NULL && vinfo.bits_per_pixel == 32) {
+        flush_32bpp(drv, area, color_p);
+        lv_disp_flush_ready(drv);
+        return;
+    }
+
     if(fbp == NULL ||
             area->x2 < 0 ||
             area->y2 < 0 ||
@@ -269,8 +311,185 @@ void fbdev_set_offset(uint32_t xoffset, uint32_t yoffset) {
     vinfo.yoffset = yoffset;
 }
 
+bool fbdev_rotation_supported(void) {
+    return vinfo.bits_per_pixel == 32;
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
 
+/**
+ * Use the second page of the framebuffer, if driver allows panning.
+ * Otherwise everything is drawn to the visible page.
+ */
+static void double_buf_init(void)
+{
+#if !USE_BSD_FBDEV
+    if(fbp == NULL || vinfo.bits_per_pixel != 32) {
+        return;
+    }
+
+    page_size = finfo.line_length * vinfo.yres;
+
+    if(vinfo.yres_virtual < vinfo.yres * 2) {
+        struct fb_var_screeninfo v = vinfo;
+
+        v.yres_virtual = vinfo.yres * 2;
+        v.yoffset = 0;
+
+        if(ioctl(fbfd, FBIOPUT_VSCREENINFO, &v) != 0 ||
+           ioctl(fbfd, FBIOGET_VSCREENINFO, &vinfo) != 0 ||
+           ioctl(fbfd, FBIOGET_FSCREENINFO, &finfo) != 0) {
+            LV_LOG_WARN("Can't set virtual resolution, single buffer is used");
+            return;
+        }
+    }
+
+    if(vinfo.yres_virtual < vinfo.yres * 2 || finfo.smem_len < page_size * 2 || finfo.ypanstep == 0) {
+        LV_LOG_WARN("Framebuffer panning is not supported, single buffer is used");
+        return;
+    }
+
+    /*Mapping could be smaller than the both pages*/
+    if(screensize < page_size * 2) {
+        munmap(fbp, screensize);
+        screensize = finfo.smem_len;
+        fbp = (char *)mmap(0, screensize, PROT_READ | PROT_WRITE, MAP_SHARED, fbfd, 0);
+        if((intptr_t)fbp == -1) {
+            perror("Error: failed to map framebuffer device to memory");
+            fbp = NULL;
+            return;
+        }
+    }
+
+    /*Keep the current picture on both pages*/
+    uint32_t front = vinfo.yoffset >= vinfo.yres ? 1 : 0;
+
+    memcpy(fbp + (front ^ 1) * page_size, fbp + front * page_size, page_size);
+
+    vinfo.xoffset = 0;
+    vinfo.yoffset = front * vinfo.yres;
+
+    if(ioctl(fbfd, FBIOPAN_DISPLAY, &vinfo) != 0) {
+        perror("ioctl(FBIOPAN_DISPLAY)");
+        return;
+    }
+
+    back_page = front ^ 1;
+    double_buf = true;
+    LV_LOG_INFO("Framebuffer page flipping is enabled");
+#endif
+}
+
+/**
+ * Copy area to the back page (or visible page without double buffering).
+ * Without LVGL's software rotation the area is rotated here.
+ */
+static void flush_32bpp(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p)
+{
+    int rot = drv->sw_rotate ? LV_DISP_ROT_NONE : drv->rotated;
+    bool swap = (rot == LV_DISP_ROT_90 || rot == LV_DISP_ROT_270);
+
+    /*Screen size in area coordinates*/
+    int32_t scr_w = swap ? vinfo.yres : vinfo.xres;
+    int32_t scr_h = swap ? vinfo.xres : vinfo.yres;
+
+    if(area->x2 >= 0 && area->y2 >= 0 && area->x1 < scr_w && area->y1 < scr_h) {
+        /*Truncate the area to the screen*/
+        int32_t act_x1 = area->x1 < 0 ? 0 : area->x1;
+        int32_t act_y1 = area->y1 < 0 ? 0 : area->y1;
+        int32_t act_x2 = area->x2 > scr_w - 1 ? scr_w - 1 : area->x2;
+        int32_t act_y2 = area->y2 > scr_h - 1 ? scr_h - 1 : area->y2;
+
+        uint32_t src_stride = lv_area_get_width(area);
+        uint32_t w = act_x2 - act_x1 + 1;
+        uint32_t h = act_y2 - act_y1 + 1;
+        const uint32_t * src = (const uint32_t *)color_p + (act_y1 - area->y1) * src_stride + (act_x1 - area->x1);
+
+        /*Same mapping of coordinates as in LVGL's software rotation*/
+        lv_area_t fb_area;
+
+        switch(rot) {
+            case LV_DISP_ROT_90:
+                fb_area.x1 = act_y1;
+                fb_area.y1 = vinfo.yres - 1 - act_x2;
+                break;
+            case LV_DISP_ROT_180:
+                fb_area.x1 = vinfo.xres - 1 - act_x2;
+                fb_area.y1 = vinfo.yres - 1 - act_y2;
+                break;
+            case LV_DISP_ROT_270:
+                fb_area.x1 = vinfo.xres - 1 - act_y2;
+                fb_area.y1 = act_x1;
+                break;
+            default:
+                fb_area.x1 = act_x1;
+                fb_area.y1 = act_y1;
+                break;
+        }
+        fb_area.x2 = fb_area.x1 + (swap ? h : w) - 1;
+        fb_area.y2 = fb_area.y1 + (swap ? w : h) - 1;
+
+        uint32_t stride = finfo.line_length / 4;
+        uint32_t * page;
+
+        if(double_buf) {
+            page = (uint32_t *)(fbp + back_page * page_size);
+        }
+        else {
+            page = (uint32_t *)fbp + vinfo.xoffset + vinfo.yoffset * stride;
+        }
+
+        fbdev_rotate_copy(page + fb_area.y1 * stride + fb_area.x1, stride, src, src_stride, w, h, rot);
+
+        if(double_buf) {
+            if(sync_areas_cnt < FBDEV_SYNC_AREAS) {
+                sync_areas[sync_areas_cnt] = fb_area;
+            }
+            sync_areas_cnt++;
+        }
+    }
+
+    if(double_buf && lv_disp_flush_is_last(drv)) {
+        page_flip();
+    }
+}
+
+/**
+ * Show the back page, then bring the new back page up to date with the areas of this frame
+ */
+static void page_flip(void)
+{
+#if !USE_BSD_FBDEV
+    vinfo.yoffset = back_page * vinfo.yres;
+
+    if(ioctl(fbfd, FBIOPAN_DISPLAY, &vinfo) != 0) {
+        perror("ioctl(FBIOPAN_DISPLAY)");
+    }
+
+    char * front = fbp + back_page * page_size;
+    char * back = fbp + (back_page ^ 1) * page_size;
+
+    if(sync_areas_cnt > FBDEV_SYNC_AREAS) {
+        memcpy(back, front, page_size);
+    }
+    else {
+        for(uint32_t i = 0; i < sync_areas_cnt; i++) {
+            const lv_area_t * a = &sync_areas[i];
+            uint32_t len = lv_area_get_width(a) * 4;
+
+            for(int32_t y = a->y1; y <= a->y2; y++) {
+                long int offset = y * finfo.line_length + a->x1 * 4;
+
+                memcpy(back + offset, front + offset, len);
+            }
+        }
+    }
+
+    sync_areas_cnt = 0;
+    back_page ^= 1;
+#endif
+}
+
 #endif
@@ -41,6 +41,12 @@ extern "C" {
  * GLOBAL PROTOTYPES
  **********************/
 void fbdev_init(void);
+/**
+ * Use memory instead of the framebuffer device: 32 bit, single page, no panning.
+ * For tests of flush
+ * @param mem buffer of xres * yres pixels
+ */
+void fbdev_init_mem(void * mem, uint32_t xres, uint32_t yres);
 void fbdev_exit(void);
 void fbdev_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p);
 void fbdev_get_sizes(uint32_t *width, uint32_t *height, uint32_t *dpi);
@@ -51,6 +57,13 @@ void fbdev_get_sizes(uint32_t *width, uint32_t *height, uint32_t *dpi);
  */
 void fbdev_set_offset(uint32_t xoffset, uint32_t yoffset);
 
+/**
+ * Check that flush could rotate areas by itself, so LVGL's `sw_rotate` is not required.
+ * Flush rotates areas according to `rotated` of the driver when `sw_rotate` is 0.
+ * @return true for 32 bit framebuffer
+ */
+bool fbdev_rotation_supported(void);
+
 
 /**********************
  *      MACROS
@@ -0,0 +1,208 @@
+/**
+ * @file fbdev_rotate.c
+ *
+ * Rotated copy into the framebuffer. 90/270 degrees are done with 4x4
+ * transposes over cache sized tiles, so the source is read in short runs of
+ * rows and every framebuffer line is written sequentially.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "fbdev_rotate.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FBDEV_ROTATE_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define FBDEV_ROTATE_SSE 1
+#endif
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/*Tile size in pixels, 32x32x4 bytes of source fits in L1 along with the output lines*/
+#define TILE    32
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void rotate_90(uint32_t * dst, uint32_t dst_stride, const uint32_t * src, uint32_t src_stride,
+                      uint32_t w, uint32_t h, bool inv);
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void fbdev_rotate_copy(uint32_t * dst, uint32_t dst_stride, const uint32_t * src, uint32_t src_stride,
+                       uint32_t w, uint32_t h, int rot)
+{
+    switch(rot) {
+        case FBDEV_ROT_90:
+            rotate_90(dst, dst_stride, src, src_stride, w, h, false);
+            break;
+
+        case FBDEV_ROT_270:
+            rotate_90(dst, dst_stride, src, src_stride, w, h, true);
+            break;
+
+        case FBDEV_ROT_180:
+            for(uint32_t y = 0; y < h; y++) {
+                const uint32_t * s = src + (h - 1 - y) * src_stride + w - 1;
+                uint32_t * d = dst + y * dst_stride;
+
+                for(uint32_t x = 0; x < w; x++) {
+                    d[x] = *s--;
+                }
+            }
+            break;
+
+        default:
+            for(uint32_t y = 0; y < h; y++) {
+                memcpy(dst + y * dst_stride, src + y * src_stride, w * 4);
+            }
+            break;
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Source pixel for the output (r, c) of the rotated block
+ * 90:  src(c, w - 1 - r)
+ * 270: src(h - 1 - c, r)
+ */
+static inline uint32_t rot_pixel(const uint32_t * src, uint32_t src_stride, uint32_t w, uint32_t h,
+                                 uint32_t r, uint32_t c, bool inv)
+{
+    if(inv) {
+        return src[(h - 1 - c) * src_stride + r];
+    }
+    return src[c * src_stride + (w - 1 - r)];
+}
+
+/**
+ * Transpose of 4x4 block. For 90 degrees the rows of the transposed block go
+ * to the output in reverse order, for 270 degrees the columns are reversed.
+ * @param d output for the row r of the block, 4 lines with dst_stride
+ * @param s source block, 4 lines with src_stride
+ */
+static inline void block_4x4(uint32_t * d, uint32_t dst_stride, const uint32_t * s, uint32_t src_stride, bool inv)
+{
+#if FBDEV_ROTATE_NEON
+    uint32x4_t r0 = vld1q_u32(s);
+    uint32x4_t r1 = vld1q_u32(s + src_stride);
+    uint32x4_t r2 = vld1q_u32(s + src_stride * 2);
+    uint32x4_t r3 = vld1q_u32(s + src_stride * 3);
+
+    if(inv) {
+        uint32x4_t t = r0; r0 = r3; r3 = t;
+        t = r1; r1 = r2; r2 = t;
+    }
+
+    uint32x4x2_t t01 = vtrnq_u32(r0, r1);
+    uint32x4x2_t t23 = vtrnq_u32(r2, r3);
+
+    uint32x4_t c0 = vcombine_u32(vget_low_u32(t01.val[0]), vget_low_u32(t23.val[0]));
+    uint32x4_t c1 = vcombine_u32(vget_low_u32(t01.val[1]), vget_low_u32(t23.val[1]));
+    uint32x4_t c2 = vcombine_u32(vget_high_u32(t01.val[0]), vget_high_u32(t23.val[0]));
+    uint32x4_t c3 = vcombine_u32(vget_high_u32(t01.val[1]), vget_high_u32(t23.val[1]));
+
+    if(inv) {
+        vst1q_u32(d, c0);
+        vst1q_u32(d + dst_stride, c1);
+        vst1q_u32(d + dst_stride * 2, c2);
+        vst1q_u32(d + dst_stride * 3, c3);
+    }
+    else {
+        vst1q_u32(d, c3);
+        vst1q_u32(d + dst_stride, c2);
+        vst1q_u32(d + dst_stride * 2, c1);
+        vst1q_u32(d + dst_stride * 3, c0);
+    }
+#elif FBDEV_ROTATE_SSE
+    __m128i r0 = _mm_loadu_si128((const __m128i *)s);
+    __m128i r1 = _mm_loadu_si128((const __m128i *)(s + src_stride));
+    __m128i r2 = _mm_loadu_si128((const __m128i *)(s + src_stride * 2));
+    __m128i r3 = _mm_loadu_si128((const __m128i *)(s + src_stride * 3));
+
+    if(inv) {
+        __m128i t = r0; r0 = r3; r3 = t;
+        t = r1; r1 = r2; r2 = t;
+    }
+
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+    __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+    __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+    __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+    __m128i c0 = _mm_unpacklo_epi64(t0, t1);
+    __m128i c1 = _mm_unpackhi_epi64(t0, t1);
+    __m128i c2 = _mm_unpacklo_epi64(t2, t3);
+    __m128i c3 = _mm_unpackhi_epi64(t2, t3);
+
+    if(inv) {
+        _mm_storeu_si128((__m128i *)d, c0);
+        _mm_storeu_si128((__m128i *)(d + dst_stride), c1);
+        _mm_storeu_si128((__m128i *)(d + dst_stride * 2), c2);
+        _mm_storeu_si128((__m128i *)(d + dst_stride * 3), c3);
+    }
+    else {
+        _mm_storeu_si128((__m128i *)d, c3);
+        _mm_storeu_si128((__m128i *)(d + dst_stride), c2);
+        _mm_storeu_si128((__m128i *)(d + dst_stride * 2), c1);
+        _mm_storeu_si128((__m128i *)(d + dst_stride * 3), c0);
+    }
+#else
+    for(uint32_t r = 0; r < 4; r++) {
+        for(uint32_t c = 0; c < 4; c++) {
+            d[r * dst_stride + c] = inv ? s[(3 - c) * src_stride + r] : s[c * src_stride + (3 - r)];
+        }
+    }
+#endif
+}
+
+static void rotate_90(uint32_t * dst, uint32_t dst_stride, const uint32_t * src, uint32_t src_stride,
+                      uint32_t w, uint32_t h, bool inv)
+{
+    /*Output block is h wide and w high*/
+    uint32_t out_w = h;
+    uint32_t out_h = w;
+    uint32_t out_w4 = out_w & ~3u;
+    uint32_t out_h4 = out_h & ~3u;
+
+    for(uint32_t tr = 0; tr < out_h4; tr += TILE) {
+        uint32_t tr_end = tr + TILE < out_h4 ? tr + TILE : out_h4;
+
+        for(uint32_t tc = 0; tc < out_w4; tc += TILE) {
+            uint32_t tc_end = tc + TILE < out_w4 ? tc + TILE : out_w4;
+
+            for(uint32_t r = tr; r < tr_end; r += 4) {
+                for(uint32_t c = tc; c < tc_end; c += 4) {
+                    /*Top left of the 4x4 source block*/
+                    const uint32_t * s = inv ? src + (h - 4 - c) * src_stride + r
+                                             : src + c * src_stride + (w - 4 - r);
+
+                    block_4x4(dst + r * dst_stride + c, dst_stride, s, src_stride, inv);
+                }
+            }
+        }
+    }
+
+    /*Right and bottom edges*/
+    for(uint32_t r = 0; r < out_h; r++) {
+        uint32_t * d = dst + r * dst_stride;
+        uint32_t c = r < out_h4 ? out_w4 : 0;
+
+        for(; c < out_w; c++) {
+            d[c] = rot_pixel(src, src_stride, w, h, r, c, inv);
+        }
+    }
+}
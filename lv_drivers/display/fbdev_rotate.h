@@ -0,0 +1,49 @@
+/**
+ * @file fbdev_rotate.h
+ *
+ */
+
+#ifndef FBDEV_ROTATE_H
+#define FBDEV_ROTATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/*Same values as lv_disp_rot_t*/
+#define FBDEV_ROT_NONE  0
+#define FBDEV_ROT_90    1
+#define FBDEV_ROT_180   2
+#define FBDEV_ROT_270   3
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Copy a block of 32 bit pixels rotating it the same way as LVGL's software rotation
+ * @param dst top left pixel of the rotated block in the destination
+ * @param dst_stride destination line length in pixels
+ * @param src source pixels
+ * @param src_stride source line length in pixels
+ * @param w width of the source block
+ * @param h height of the source block
+ * @param rot FBDEV_ROT_...
+ */
+void fbdev_rotate_copy(uint32_t * dst, uint32_t dst_stride, const uint32_t * src, uint32_t src_stride,
+                       uint32_t w, uint32_t h, int rot);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*FBDEV_ROTATE_H*/
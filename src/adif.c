@@ -11,26 +11,38 @@
 
 #include "adif.h"
 
-#include "util.h"
-
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <strings.h>
 #include <stdbool.h>
 #include <unistd.h>
-#include <regex.h>
+#include <sys/stat.h>
 
 #define MHZ 1000000
 #define KHZ 1000
 
-#define ARRAY_SIZE(arr) (sizeof((arr)) / sizeof((arr)[0]))
-#define COPY_STR(dst, src, len) (copy_str(dst, src, len, sizeof(dst)))
+#define READ_BUF_SIZE   (64 * 1024)
+#define TAG_SIZE        32
+#define VALUE_SIZE      128
+
+#define COPY_STR(dst, src) (copy_str(dst, src, sizeof(dst)))
 
 struct adif_log_s {
     FILE *fd;
 };
 
+struct adif_reader_s {
+    FILE    *fd;
+    char    *buf;
+    size_t  size;
+    char    tag[TAG_SIZE];
+    char    value[VALUE_SIZE];
+    char    mode[VALUE_SIZE];
+    char    submode[VALUE_SIZE];
+};
+
 static void write_header(FILE *fd);
 
 static void write_str(FILE *fd, const char * key, const char * val);
@@ -41,8 +53,7 @@ static void write_freq(FILE *fd, float freq_mhz);
 static void write_band(FILE *fd, qso_log_band_t band);
 static void write_mode(FILE *fd, qso_log_mode_t mode);
 
-static void copy_str(char * dst, char * src, size_t val_len, size_t dst_len);
-static char * extract_str(const char * src, size_t src_len);
+static void copy_str(char * dst, const char * src, size_t dst_len);
 
 static qso_log_band_t str_to_band(const char * s);
 static qso_log_mode_t create_mode(const char * mode, const char * submode);
@@ -92,97 +103,165 @@ void adif_add_qso(adif_log l, qso_log_record_t qso)
     fflush(l->fd);
 }
 
-int adif_read(const char * path, qso_log_record_t ** records) {
-    char * line = NULL;
-    size_t len = 0;
-    ssize_t read;
-
-    FILE *fp = fopen(path, "r");
+adif_reader adif_reader_open(const char * path) {
+    FILE *fd = fopen(path, "r");
 
-    if (fp == NULL) {
+    if (fd == NULL) {
         perror("Unable to open log file:");
+        return NULL;
+    }
+
+    adif_reader r = (adif_reader) calloc(1, sizeof(struct adif_reader_s));
+    struct stat st;
+
+    r->fd = fd;
+    r->buf = malloc(READ_BUF_SIZE);
+    setvbuf(fd, r->buf, _IOFBF, READ_BUF_SIZE);
+
+    if (fstat(fileno(fd), &st) == 0) {
+        r->size = st.st_size;
+    }
+    return r;
+}
+
+void adif_reader_close(adif_reader r) {
+    fclose(r->fd);
+    free(r->buf);
+    free(r);
+}
+
+uint8_t adif_reader_progress(adif_reader r) {
+    if (r->size == 0) {
         return 0;
     }
+    return (uint64_t) ftell(r->fd) * 100 / r->size;
+}
 
-    static regex_t  regex;
-    static const    char re[] = "<([A-Za-z_]+):([0-9]+)>";
-    regmatch_t      pmatch[3];
-    regoff_t        off, r_len;
-    char            *s;
+/**
+ * Read next `<NAME:LEN[:TYPE]>value` field. Tags without length get -1 as length.
+ * Value longer than buffer is truncated
+ */
+static bool read_field(adif_reader r, int *len) {
+    FILE    *fd = r->fd;
+    int     c;
+    size_t  i;
+
+    do {
+        c = getc_unlocked(fd);
+        if (c == EOF) {
+            return false;
+        }
+    } while (c != '<');
 
-    if (regcomp(&regex, re, REG_NEWLINE | REG_EXTENDED)) {
-        printf("Can't compile regexp");
-        return -2;
+    for (i = 0; ; ) {
+        c = getc_unlocked(fd);
+        if (c == EOF) {
+            return false;
+        }
+        if (c == ':' || c == '>') {
+            break;
+        }
+        if (i < TAG_SIZE - 1) {
+            r->tag[i++] = c;
+        }
     }
+    r->tag[i] = 0;
 
-    size_t arr_size = 128;
-    *records = malloc(arr_size * sizeof(qso_log_record_t));
-
-    qso_log_record_t *cur_record;
-    ssize_t cur_record_id = 0;
-    struct tm qso_ts;
-    size_t val_len;
-
-    while ((read = getline(&line, &len, fp)) != -1) {
-        if (strcmp(line + read - 7, "<EOR>\r\n") != 0) continue;
-        s = line;
-        cur_record = &(*records)[cur_record_id];
-        char * mode = NULL;
-        char * submode = NULL;
-        for (unsigned int i = 0; ; i++) {
-            if (regexec(&regex, s, ARRAY_SIZE(pmatch), pmatch, 0))
-                break;
-            val_len = atoi(s + pmatch[2].rm_so);
-            if (val_len > 0) {
-                if (strncmp(s + pmatch[1].rm_so, "OPERATOR", pmatch[1].rm_eo - pmatch[1].rm_so) == 0) {
-                    COPY_STR(cur_record->local_call, s + pmatch[0].rm_eo, val_len);
-                } else if (strncmp(s + pmatch[1].rm_so, "CALL", pmatch[1].rm_eo - pmatch[1].rm_so) == 0) {
-                    COPY_STR(cur_record->remote_call, s + pmatch[0].rm_eo, val_len);
-                } else if (strncmp(s + pmatch[1].rm_so, "QSO_DATE", pmatch[1].rm_eo - pmatch[1].rm_so) == 0) {
-                    strptime(s + pmatch[0].rm_eo, "%Y%m%d", &qso_ts);
-                } else if (strncmp(s + pmatch[1].rm_so, "TIME_ON", pmatch[1].rm_eo - pmatch[1].rm_so) == 0) {
-                    strptime(s + pmatch[0].rm_eo, "%H%M", &qso_ts);
-                } else if (strncmp(s + pmatch[1].rm_so, "MODE", pmatch[1].rm_eo - pmatch[1].rm_so) == 0) {
-                    mode = extract_str(s + pmatch[0].rm_eo, val_len);
-                } else if (strncmp(s + pmatch[1].rm_so, "SUBMODE", pmatch[1].rm_eo - pmatch[1].rm_so) == 0) {
-                    submode = extract_str(s + pmatch[0].rm_eo, val_len);
-                } else if (strncmp(s + pmatch[1].rm_so, "NAME", pmatch[1].rm_eo - pmatch[1].rm_so) == 0) {
-                    COPY_STR(cur_record->name, s + pmatch[0].rm_eo, val_len);
-                } else if (strncmp(s + pmatch[1].rm_so, "QTH", pmatch[1].rm_eo - pmatch[1].rm_so) == 0) {
-                    COPY_STR(cur_record->qth, s + pmatch[0].rm_eo, val_len);
-                } else if (strncmp(s + pmatch[1].rm_so, "RST_SENT", pmatch[1].rm_eo - pmatch[1].rm_so) == 0) {
-                    cur_record->rsts = atoi(s + pmatch[0].rm_eo);
-                } else if (strncmp(s + pmatch[1].rm_so, "RST_RCVD", pmatch[1].rm_eo - pmatch[1].rm_so) == 0) {
-                    cur_record->rstr = atoi(s + pmatch[0].rm_eo);
-                } else if (strncmp(s + pmatch[1].rm_so, "BAND", pmatch[1].rm_eo - pmatch[1].rm_so) == 0) {
-                    cur_record->band = str_to_band(s + pmatch[0].rm_eo);
-                } else if (strncmp(s + pmatch[1].rm_so, "FREQ", pmatch[1].rm_eo - pmatch[1].rm_so) == 0) {
-                    cur_record->freq_mhz = strtof(s + pmatch[0].rm_eo, NULL);
-                } else if (strncmp(s + pmatch[1].rm_so, "MY_GRIDSQUARE", pmatch[1].rm_eo - pmatch[1].rm_so) == 0) {
-                    COPY_STR(cur_record->local_grid, s + pmatch[0].rm_eo, val_len);
-                } else if (strncmp(s + pmatch[1].rm_so, "GRIDSQUARE", pmatch[1].rm_eo - pmatch[1].rm_so) == 0) {
-                    COPY_STR(cur_record->remote_grid, s + pmatch[0].rm_eo, val_len);
-                }
-            }
+    if (c == '>') {
+        *len = -1;
+        return true;
+    }
 
-            s += pmatch[0].rm_eo;
+    *len = 0;
+    while ((c = getc_unlocked(fd)) >= '0' && c <= '9') {
+        *len = *len * 10 + (c - '0');
+    }
+    /* Skip data type */
+    while (c != '>') {
+        if (c == EOF) {
+            return false;
         }
+        c = getc_unlocked(fd);
+    }
 
-        cur_record->time = mktime(&qso_ts);
-        cur_record->mode = create_mode(mode, submode);
-        if (mode) free(mode);
-        if (submode) free(submode);
-        if ((qso_log_freq_to_band(cur_record->freq_mhz * MHZ) != cur_record->band) &&
-            (qso_log_freq_to_band(cur_record->freq_mhz * KHZ) == cur_record->band)) {
-                cur_record->freq_mhz /= 1000;
+    for (i = 0; i < *len; i++) {
+        c = getc_unlocked(fd);
+        if (c == EOF) {
+            return false;
         }
-        cur_record_id++;
-        if (cur_record_id >= arr_size) {
-            arr_size *= 2;
-            (*records) = realloc((*records), arr_size * sizeof(qso_log_record_t));
+        if (i < VALUE_SIZE - 1) {
+            r->value[i] = c;
         }
     }
-    return cur_record_id--;
+    r->value[i < VALUE_SIZE - 1 ? i : VALUE_SIZE - 1] = 0;
+    return true;
+}
+
+static void apply_field(adif_reader r, qso_log_record_t *rec, struct tm *qso_ts) {
+    const char *tag = r->tag;
+    const char *val = r->value;
+
+    if (strcasecmp(tag, "OPERATOR") == 0) {
+        COPY_STR(rec->local_call, val);
+    } else if (strcasecmp(tag, "CALL") == 0) {
+        COPY_STR(rec->remote_call, val);
+    } else if (strcasecmp(tag, "QSO_DATE") == 0) {
+        strptime(val, "%Y%m%d", qso_ts);
+    } else if (strcasecmp(tag, "TIME_ON") == 0) {
+        strptime(val, "%H%M", qso_ts);
+    } else if (strcasecmp(tag, "MODE") == 0) {
+        COPY_STR(r->mode, val);
+    } else if (strcasecmp(tag, "SUBMODE") == 0) {
+        COPY_STR(r->submode, val);
+    } else if (strcasecmp(tag, "NAME") == 0) {
+        COPY_STR(rec->name, val);
+    } else if (strcasecmp(tag, "QTH") == 0) {
+        COPY_STR(rec->qth, val);
+    } else if (strcasecmp(tag, "RST_SENT") == 0) {
+        rec->rsts = atoi(val);
+    } else if (strcasecmp(tag, "RST_RCVD") == 0) {
+        rec->rstr = atoi(val);
+    } else if (strcasecmp(tag, "BAND") == 0) {
+        rec->band = str_to_band(val);
+    } else if (strcasecmp(tag, "FREQ") == 0) {
+        rec->freq_mhz = strtof(val, NULL);
+    } else if (strcasecmp(tag, "MY_GRIDSQUARE") == 0) {
+        COPY_STR(rec->local_grid, val);
+    } else if (strcasecmp(tag, "GRIDSQUARE") == 0) {
+        COPY_STR(rec->remote_grid, val);
+    }
+}
+
+bool adif_reader_next(adif_reader r, qso_log_record_t *rec) {
+    struct tm   qso_ts;
+    int         len;
+
+    memset(rec, 0, sizeof(*rec));
+    memset(&qso_ts, 0, sizeof(qso_ts));
+    r->mode[0] = 0;
+    r->submode[0] = 0;
+
+    while (read_field(r, &len)) {
+        if (len > 0) {
+            apply_field(r, rec, &qso_ts);
+        } else if (len < 0) {
+            if (strcasecmp(r->tag, "EOH") == 0) {
+                memset(rec, 0, sizeof(*rec));
+                memset(&qso_ts, 0, sizeof(qso_ts));
+                r->mode[0] = 0;
+                r->submode[0] = 0;
+            } else if (strcasecmp(r->tag, "EOR") == 0) {
+                rec->time = mktime(&qso_ts);
+                rec->mode = create_mode(r->mode[0] ? r->mode : NULL, r->submode[0] ? r->submode : NULL);
+                if ((qso_log_freq_to_band(rec->freq_mhz * MHZ) != rec->band) &&
+                    (qso_log_freq_to_band(rec->freq_mhz * KHZ) == rec->band)) {
+                        rec->freq_mhz /= 1000;
+                }
+                return true;
+            }
+        }
+    }
+    return false;
 }
 
 static void write_header(FILE *fd) {
@@ -264,20 +343,9 @@ static void write_mode(FILE *fd, qso_log_mode_t mode) {
 }
 
 
-static void copy_str(char * dst, char * src, size_t val_len, size_t dst_len) {
-    if (val_len > (dst_len - 1)) {
-        val_len = dst_len - 1;
-    }
-    strncpy(dst, src, val_len);
-    dst[val_len] = 0;
-}
-
-static char * extract_str(const char * src, size_t src_len) {
-    char * dst;
-    dst = malloc(src_len + 1);
-    memcpy(dst, src, src_len);
-    dst[src_len] = 0;
-    return dst;
+static void copy_str(char * dst, const char * src, size_t dst_len) {
+    strncpy(dst, src, dst_len - 1);
+    dst[dst_len - 1] = 0;
 }
 
 static qso_log_band_t str_to_band(const char * s) {
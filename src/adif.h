@@ -10,8 +10,11 @@
 #include "qso_log.h"
 
 #include <time.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 typedef struct adif_log_s *adif_log;
+typedef struct adif_reader_s *adif_reader;
 
 adif_log  adif_log_init(const char * path);
 
@@ -19,4 +22,19 @@ void adif_log_close(adif_log l);
 
 void adif_add_qso(adif_log l, qso_log_record_t qso);
 
-int adif_read(const char * path, qso_log_record_t ** records);
+/**
+ * Open ADI file for sequential reading of records
+ */
+adif_reader adif_reader_open(const char * path);
+
+void adif_reader_close(adif_reader r);
+
+/**
+ * Read next record. Returns false at the end of file
+ */
+bool adif_reader_next(adif_reader r, qso_log_record_t *rec);
+
+/**
+ * Read position in percents
+ */
+uint8_t adif_reader_progress(adif_reader r);
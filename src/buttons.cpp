@@ -84,6 +84,7 @@ static const char * key_ratio_label_getter();
 
 static const char * cw_decoder_label_getter();
 static const char * cw_tuner_label_getter();
+static const char * cw_skimmer_label_getter();
 static const char * cw_snr_label_getter();
 
 static const char * cw_peak_beta_label_getter();
@@ -233,6 +234,10 @@ static button_item_t btn_cw_tuner   = {.type     = BTN_TEXT_FN,
                                        .hold     = button_mfk_hold_cb,
                                        .data     = MFK_CW_TUNE,
                                        .subj     = &cfg.cw_tune.val};
+static button_item_t btn_cw_skimmer = {.type     = BTN_TEXT_FN,
+                                       .label_fn = cw_skimmer_label_getter,
+                                       .press    = controls_toggle_cw_skimmer,
+                                       .subj     = &cfg.cw_skimmer.val};
 static button_item_t btn_cw_snr     = make_btn(cw_snr_label_getter, MFK_CW_DECODER_SNR, &cfg.cw_decoder_snr.val);
 static button_item_t btn_cw_peak_beta =
     make_btn(cw_peak_beta_label_getter, MFK_CW_DECODER_PEAK_BETA, &cfg.cw_decoder_peak_beta.val);
@@ -370,7 +375,7 @@ static buttons_page_t page_cw_decoder_1 = {
     {&btn_cw_p1, &btn_cw_decoder, &btn_cw_tuner, &btn_cw_snr}
 };
 static buttons_page_t page_cw_decoder_2 = {
-    {&btn_cw_p2, &btn_cw_peak_beta, &btn_cw_noise_beta}
+    {&btn_cw_p2, &btn_cw_peak_beta, &btn_cw_noise_beta, &btn_cw_skimmer}
 };
 
 /* DFN pages */
@@ -930,6 +935,12 @@ static const char * cw_tuner_label_getter() {
     return buf;
 }
 
+static const char * cw_skimmer_label_getter() {
+    static char buf[22];
+    sprintf(buf, "Skimmer:\n%s", subject_get_int(cfg.cw_skimmer.val) ? "On": "Off");
+    return buf;
+}
+
 static const char * cw_snr_label_getter() {
     static char buf[22];
     sprintf(buf, "Dec SNR:\n%0.1f dB", subject_get_float(cfg.cw_decoder_snr.val));
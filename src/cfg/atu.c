@@ -1,6 +1,7 @@
 #include "atu.private.h"
 
 #include "cfg.h"
+#include "atu_index.h"
 
 #include "../lvgl/lvgl.h"
 #include <stdio.h>
@@ -17,29 +18,20 @@ static sqlite3_stmt   *insert_stmt;
 static sqlite3_stmt   *read_stmt;
 static sqlite3_stmt   *delete_adjacent_stmt;
 static pthread_mutex_t write_mutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_mutex_t read_mutex  = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t index_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-static void    update_atu_network(Subject *subj, void *user_data);
-static void    add_atu_net_to_cache(int32_t freq, uint32_t network);
-static void    load_all_atu_for_ant(int32_t ant_id);
-static int32_t find_atu_for_freq(int32_t freq);
+static void update_atu_network(Subject *subj, void *user_data);
+static void load_all_atu();
 
 atu_network_t atu_network;
 
-static struct atu_network_data_st {
-    int32_t  freq;
-    uint32_t network;
-} *atu_network_cache = NULL;
-
-static uint32_t atu_network_cache_size      = 0;
-static uint32_t atu_network_cache_allocated = 0;
-static uint32_t ant_id                      = -1;
+static atu_index_t *atu_index;
 
 void cfg_atu_init(sqlite3 *database) {
     db = database;
     int rc;
 
-    rc = sqlite3_prepare_v2(db, "SELECT freq, val FROM atu WHERE ant = :ant", -1, &read_stmt, 0);
+    rc = sqlite3_prepare_v2(db, "SELECT ant, freq, val FROM atu ORDER BY ant, freq", -1, &read_stmt, 0);
     if (rc != SQLITE_OK) {
         LV_LOG_ERROR("Failed prepare read statement: %s", sqlite3_errmsg(db));
         exit(1);
@@ -57,14 +49,11 @@ void cfg_atu_init(sqlite3 *database) {
         exit(1);
     }
 
-    atu_network_cache_allocated = 10;
-    atu_network_cache           = malloc(sizeof(*atu_network_cache) * atu_network_cache_allocated);
-
     atu_network.loaded        = subject_create_int(false);
     atu_network.network        = subject_create_int(0);
 
-    ant_id = subject_get_int(cfg.ant_id.val);
-    load_all_atu_for_ant(ant_id);
+    atu_index = atu_index_create();
+    load_all_atu();
 
     subject_add_observer(cfg_cur.fg_freq, update_atu_network, NULL);
     subject_add_observer(cfg.atu_enabled.val, update_atu_network, NULL);
@@ -145,7 +134,9 @@ int cfg_atu_save_network(uint32_t network) {
             LV_LOG_ERROR("Failed remove adjacent atu_params: %s", sqlite3_errmsg(db));
         } else {
             rc = 0;
-            load_all_atu_for_ant(ant_id);
+            pthread_mutex_lock(&index_mutex);
+            atu_index_put(atu_index, ant_id, freq, network, ATU_SAVE_STEP);
+            pthread_mutex_unlock(&index_mutex);
             subject_set_int(atu_network.loaded, true);
             subject_set_int(atu_network.network, network);
         }
@@ -159,17 +150,18 @@ static void update_atu_network(Subject *subj, void *user_data) {
     if (!subject_get_int(cfg.atu_enabled.val)) {
         return;
     }
-    int32_t new_ant_id = subject_get_int(cfg.ant_id.val);
-    if (ant_id != new_ant_id) {
-        ant_id = new_ant_id;
-        load_all_atu_for_ant(ant_id);
-    }
-    int32_t freq    = subject_get_int(cfg_cur.fg_freq);
-    int32_t min_pos = find_atu_for_freq(freq);
-    if (min_pos >= 0) {
+    int32_t  ant_id = subject_get_int(cfg.ant_id.val);
+    int32_t  freq   = subject_get_int(cfg_cur.fg_freq);
+    uint32_t network;
+
+    pthread_mutex_lock(&index_mutex);
+    bool found = atu_index_find(atu_index, ant_id, freq, ATU_SAVE_STEP, &network);
+    pthread_mutex_unlock(&index_mutex);
+
+    if (found) {
         subject_set_int(atu_network.loaded, true);
-        subject_set_int(atu_network.network, atu_network_cache[min_pos].network);
-        LV_LOG_INFO("Loaded ATU network for freq: %i, ant: %i -  %u", freq, ant_id, atu_network_cache[min_pos].network);
+        subject_set_int(atu_network.network, network);
+        LV_LOG_INFO("Loaded ATU network for freq: %i, ant: %i -  %u", freq, ant_id, network);
     } else {
         subject_set_int(atu_network.loaded, false);
         subject_set_int(atu_network.network, 0);
@@ -177,53 +169,20 @@ static void update_atu_network(Subject *subj, void *user_data) {
     }
 }
 
-static void add_atu_net_to_cache(int32_t freq, uint32_t network) {
-    if (atu_network_cache_size >= atu_network_cache_allocated) {
-        atu_network_cache_allocated += 10;
-        atu_network_cache = realloc(atu_network_cache, sizeof(*atu_network_cache) * atu_network_cache_allocated);
-    }
-    atu_network_cache[atu_network_cache_size].freq    = freq;
-    atu_network_cache[atu_network_cache_size].network = network;
-    atu_network_cache_size++;
-}
-
-static int32_t find_atu_for_freq(int32_t freq) {
-    int32_t min_diff = ATU_SAVE_STEP + 1;
-    int32_t diff, min_pos;
-    // search closest atu network
-    for (size_t i = 0; i < atu_network_cache_size; i++) {
-        diff = abs(atu_network_cache[i].freq - freq);
-        if (diff < min_diff) {
-            min_diff = diff;
-            min_pos  = i;
-        }
-    }
-    if (min_diff <= ATU_SAVE_STEP) {
-        return min_pos;
-    } else {
-        return -1;
-    }
-}
-
-static void load_all_atu_for_ant(int32_t ant_id) {
+/* All antennas are loaded once, rows go in order of the index */
+static void load_all_atu() {
     int           rc;
     sqlite3_stmt *stmt = read_stmt;
-    pthread_mutex_lock(&read_mutex);
-    rc = sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":ant"), ant_id);
-    if (rc != SQLITE_OK) {
-        LV_LOG_ERROR("Failed to bind ant_id %i: %s", ant_id, sqlite3_errmsg(db));
-        sqlite3_reset(stmt);
-        sqlite3_clear_bindings(stmt);
-        pthread_mutex_unlock(&read_mutex);
-        return;
-    }
+    uint32_t      count = 0;
 
-    atu_network_cache_size = 0;
+    pthread_mutex_lock(&index_mutex);
     while (1) {
         rc = sqlite3_step(stmt);
 
         if (rc == SQLITE_ROW) {
-            add_atu_net_to_cache(sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1));
+            atu_index_put(atu_index, sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1),
+                          sqlite3_column_int(stmt, 2), 0);
+            count++;
         } else if (rc == SQLITE_DONE) {
             break;
         } else {
@@ -232,6 +191,7 @@ static void load_all_atu_for_ant(int32_t ant_id) {
         }
     }
     sqlite3_reset(stmt);
-    sqlite3_clear_bindings(stmt);
-    pthread_mutex_unlock(&read_mutex);
+    pthread_mutex_unlock(&index_mutex);
+
+    LV_LOG_INFO("Loaded %u ATU networks", count);
 }
@@ -0,0 +1,129 @@
+/**
+ * Sorted per antenna index of ATU networks
+ */
+#include "atu_index.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    int32_t  freq;
+    uint32_t network;
+} point_t;
+
+typedef struct {
+    int32_t  ant;
+    point_t *points;        /* Sorted by freq */
+    uint32_t count;
+    uint32_t allocated;
+} antenna_t;
+
+struct atu_index_s {
+    antenna_t *antennas;    /* Sorted by ant */
+    uint32_t   count;
+};
+
+atu_index_t *atu_index_create() {
+    return calloc(1, sizeof(atu_index_t));
+}
+
+void atu_index_destroy(atu_index_t *idx) {
+    for (uint32_t i = 0; i < idx->count; i++) {
+        free(idx->antennas[i].points);
+    }
+    free(idx->antennas);
+    free(idx);
+}
+
+/* First position with key >= val */
+#define LOWER_BOUND(arr, n, field, val, res) { \
+        uint32_t lo = 0, hi = (n); \
+        while (lo < hi) { \
+            uint32_t mid = lo + (hi - lo) / 2; \
+            if ((arr)[mid].field < (val)) { \
+                lo = mid + 1; \
+            } else { \
+                hi = mid; \
+            } \
+        } \
+        res = lo; \
+    }
+
+static antenna_t *get_antenna(atu_index_t *idx, int32_t ant, bool create) {
+    uint32_t pos;
+
+    LOWER_BOUND(idx->antennas, idx->count, ant, ant, pos);
+
+    if (pos < idx->count && idx->antennas[pos].ant == ant) {
+        return &idx->antennas[pos];
+    }
+    if (!create) {
+        return NULL;
+    }
+
+    idx->antennas = realloc(idx->antennas, sizeof(antenna_t) * (idx->count + 1));
+    memmove(&idx->antennas[pos + 1], &idx->antennas[pos], sizeof(antenna_t) * (idx->count - pos));
+    memset(&idx->antennas[pos], 0, sizeof(antenna_t));
+    idx->antennas[pos].ant = ant;
+    idx->count++;
+
+    return &idx->antennas[pos];
+}
+
+void atu_index_put(atu_index_t *idx, int32_t ant, int32_t freq, uint32_t network, int32_t step) {
+    antenna_t *a = get_antenna(idx, ant, true);
+    uint32_t   from, to;
+
+    /* Points in [freq - step, freq + step] are replaced by the new one */
+    LOWER_BOUND(a->points, a->count, freq, (int64_t) freq - step, from);
+    LOWER_BOUND(a->points, a->count, freq, (int64_t) freq + step + 1, to);
+
+    if (from == to) {
+        if (a->count == a->allocated) {
+            a->allocated = a->allocated ? a->allocated * 2 : 16;
+            a->points = realloc(a->points, sizeof(point_t) * a->allocated);
+        }
+        memmove(&a->points[from + 1], &a->points[from], sizeof(point_t) * (a->count - from));
+        a->count++;
+    } else {
+        memmove(&a->points[from + 1], &a->points[to], sizeof(point_t) * (a->count - to));
+        a->count -= to - from - 1;
+    }
+
+    a->points[from].freq = freq;
+    a->points[from].network = network;
+}
+
+bool atu_index_find(atu_index_t *idx, int32_t ant, int32_t freq, int32_t max_diff, uint32_t *network) {
+    antenna_t *a = get_antenna(idx, ant, false);
+    uint32_t   pos;
+
+    if (!a || a->count == 0) {
+        return false;
+    }
+
+    LOWER_BOUND(a->points, a->count, freq, freq, pos);
+
+    int64_t  best_diff = (int64_t) max_diff + 1;
+    point_t *best = NULL;
+
+    if (pos > 0 && (int64_t) freq - a->points[pos - 1].freq < best_diff) {
+        best = &a->points[pos - 1];
+        best_diff = (int64_t) freq - best->freq;
+    }
+    if (pos < a->count && (int64_t) a->points[pos].freq - freq < best_diff) {
+        best = &a->points[pos];
+    }
+
+    if (best) {
+        *network = best->network;
+        return true;
+    }
+    return false;
+}
+
+uint32_t atu_index_count(atu_index_t *idx, int32_t ant) {
+    antenna_t *a = get_antenna(idx, ant, false);
+
+    return a ? a->count : 0;
+}
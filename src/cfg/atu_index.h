@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Tuned ATU networks of all antennas. Every antenna has own array sorted by freq,
+ * lookup is binary search of the nearest point, new tunes are inserted in place.
+ */
+
+typedef struct atu_index_s atu_index_t;
+
+atu_index_t *atu_index_create();
+void         atu_index_destroy(atu_index_t *idx);
+
+/**
+ * Store network for freq. Other points closer than step to freq are removed
+ */
+void atu_index_put(atu_index_t *idx, int32_t ant, int32_t freq, uint32_t network, int32_t step);
+
+/**
+ * Network of the nearest point not further than max_diff. On equal distance lower freq wins
+ */
+bool atu_index_find(atu_index_t *idx, int32_t ant, int32_t freq, int32_t max_diff, uint32_t *network);
+
+/**
+ * Count of points for antenna
+ */
+uint32_t atu_index_count(atu_index_t *idx, int32_t ant);
@@ -17,24 +17,24 @@
 static sqlite3      *db;
 static sqlite3_stmt *insert_stmt;
 static sqlite3_stmt *read_stmt;
-static sqlite3_stmt *read_band_by_pk_stmt;
-static sqlite3_stmt *read_band_by_freq_stmt;
-static sqlite3_stmt *find_up_band_stmt;
-static sqlite3_stmt *find_down_band_stmt;
 static sqlite3_stmt *read_all_bands_stmt;
 
 static pthread_mutex_t write_mutex             = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t read_mutex              = PTHREAD_MUTEX_INITIALIZER;
-static pthread_mutex_t read_band_by_pk_mutex   = PTHREAD_MUTEX_INITIALIZER;
-static pthread_mutex_t read_band_by_freq_mutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_mutex_t find_up_down_band_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t read_all_bands_mutex    = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t index_mutex             = PTHREAD_MUTEX_INITIALIZER;
 
-static band_info_t _band_info_cache = {.id = BAND_UNDEFINED, .start_freq = 0, .stop_freq = 0};
+/*
+ * All bands in memory, lookups on frequency change don't touch DB.
+ * Loaded once and never freed, so pointers returned by lookups stay valid
+ */
+static band_index_t *band_index = NULL;
+static band_info_t  *last_band_info = NULL;
 
 cfg_band_t cfg_band;
 
 static void init_db(sqlite3 *database);
+static void load_band_index();
 
 static void on_fg_freq_change(Subject *subj, void *user_data);
 static void on_bg_freq_change(Subject *subj, void *user_data);
@@ -57,6 +57,10 @@ static void fill_band_cfg_item(cfg_item_t *item, Subject * val, const char * db_
 void cfg_band_params_init(sqlite3 *database) {
     init_db(database);
 
+    pthread_mutex_lock(&index_mutex);
+    load_band_index();
+    pthread_mutex_unlock(&index_mutex);
+
     x6100_mode_t default_mode;
     int32_t      band_id      = subject_get_int(cfg.band_id.val);
     band_info_t *band_info    = get_band_info_by_pk(band_id);
@@ -185,151 +189,90 @@ void cfg_band_load_next(bool up) {
 }
 
 const char *cfg_band_label_get() {
-    if (_band_info_cache.id != BAND_UNDEFINED) {
-        return _band_info_cache.name;
-    } else {
-        return "";
+    const char *name = "";
+
+    pthread_mutex_lock(&index_mutex);
+    if (last_band_info && (last_band_info->id != BAND_UNDEFINED)) {
+        name = last_band_info->name;
     }
+    pthread_mutex_unlock(&index_mutex);
+    return name;
 }
 
-band_info_t *get_band_info_by_pk(int32_t band_id) {
-    int rc;
-    if (_band_info_cache.id == band_id) {
-        return &_band_info_cache;
+/**
+ * Load bands table to index. Call with index_mutex locked
+ */
+static void load_band_index() {
+    int32_t      cap   = 64;
+    band_info_t *bands = malloc(sizeof(*bands) * cap);
+    uint32_t     count = cfg_band_read_all_bands(&bands, &cap);
+
+    band_index = band_index_create(bands, count);
+
+    for (uint32_t i = 0; i < count; i++) {
+        free(bands[i].name);
     }
-    LV_LOG_USER("Loading band info for id: %i", band_id);
-    sqlite3_stmt *stmt = read_band_by_pk_stmt;
-    pthread_mutex_lock(&read_band_by_pk_mutex);
-    rc = sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":id"), band_id);
-    if (rc != SQLITE_OK) {
-        LV_LOG_ERROR("Failed to bind bands_id %i: %s", band_id, sqlite3_errmsg(db));
-        pthread_mutex_unlock(&read_band_by_pk_mutex);
-        return NULL;
+    free(bands);
+
+    LV_LOG_USER("Loaded %u bands to index", count);
+}
+
+static band_info_t *remember_band_info(band_info_t *band_info) {
+    if (band_info) {
+        last_band_info = band_info;
     }
-    rc = sqlite3_step(stmt);
-    if (rc == SQLITE_ROW) {
-        if (_band_info_cache.name) {
-            free(_band_info_cache.name);
-            _band_info_cache.name = NULL;
-        }
-        _band_info_cache.id         = band_id;
-        _band_info_cache.name       = strdup(sqlite3_column_text(stmt, 0));
-        _band_info_cache.start_freq = sqlite3_column_int(stmt, 1);
-        _band_info_cache.stop_freq  = sqlite3_column_int(stmt, 2);
-        _band_info_cache.active     = sqlite3_column_int(stmt, 3);
-        rc                          = 0;
-    } else {
+    return band_info;
+}
+
+band_info_t *get_band_info_by_pk(int32_t band_id) {
+    band_info_t *band_info;
+
+    pthread_mutex_lock(&index_mutex);
+    if (!band_index) {
+        load_band_index();
+    }
+    band_info = remember_band_info(band_index_by_pk(band_index, band_id));
+    pthread_mutex_unlock(&index_mutex);
+
+    if (!band_info) {
         LV_LOG_USER("No info for band with id: %i", band_id);
-        rc = -1;
     }
-    sqlite3_reset(stmt);
-    sqlite3_clear_bindings(stmt);
-    pthread_mutex_unlock(&read_band_by_pk_mutex);
-    if (rc == 0)
-        return &_band_info_cache;
-    else
-        return NULL;
+    return band_info;
 }
 
 band_info_t *get_band_info_by_freq(uint32_t freq) {
-    if ((freq > _band_info_cache.start_freq) && (freq <= _band_info_cache.stop_freq))
-        return &_band_info_cache;
-    LV_LOG_USER("Loading band info for freq: %u", freq);
-    int           rc;
-    sqlite3_stmt *stmt = read_band_by_freq_stmt;
-    pthread_mutex_lock(&read_band_by_freq_mutex);
-    rc = sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":freq"), freq);
-    if (rc != SQLITE_OK) {
-        LV_LOG_ERROR("Failed to bind freq %lu to read_band_by_freq_stmt: %s", freq, sqlite3_errmsg(db));
-        pthread_mutex_unlock(&read_band_by_freq_mutex);
-        return NULL;
-    }
-    rc = sqlite3_step(stmt);
-    if (rc == SQLITE_ROW) {
-        if (_band_info_cache.name) {
-            free(_band_info_cache.name);
-            _band_info_cache.name = NULL;
-        }
-        if (sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
-            _band_info_cache.id     = sqlite3_column_int(stmt, 0);
-            _band_info_cache.name   = strdup(sqlite3_column_text(stmt, 1));
-            _band_info_cache.active = true;
-        } else {
-            _band_info_cache.id     = BAND_UNDEFINED;
-            _band_info_cache.active = false;
-        }
-        _band_info_cache.start_freq = sqlite3_column_int(stmt, 2);
-        if (sqlite3_column_type(stmt, 3) == SQLITE_NULL) {
-            _band_info_cache.stop_freq = 0LU - 1;
-        } else {
-            _band_info_cache.stop_freq = sqlite3_column_int(stmt, 3);
-        }
-        rc = 0;
-    } else {
-        LV_LOG_WARN("No band info for freq: %lu", freq);
-        rc = -1;
-    }
-    sqlite3_reset(stmt);
-    sqlite3_clear_bindings(stmt);
-    pthread_mutex_unlock(&read_band_by_freq_mutex);
-    if (rc == 0) {
-        return &_band_info_cache;
-    } else {
-        return NULL;
+    band_info_t *band_info;
+
+    pthread_mutex_lock(&index_mutex);
+    if (!band_index) {
+        load_band_index();
     }
+    band_info = remember_band_info(band_index_by_freq(band_index, freq));
+    pthread_mutex_unlock(&index_mutex);
+    return band_info;
 }
 
 band_info_t *get_band_info_next(uint32_t freq, bool up, int32_t cur_id) {
-    int           rc;
-    sqlite3_stmt *stmt;
-    pthread_mutex_lock(&find_up_down_band_mutex);
-    if (up) {
-        stmt = find_up_band_stmt;
-    } else {
-        stmt = find_down_band_stmt;
-    }
-    rc = sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":freq"), freq);
-    if (rc != SQLITE_OK) {
-        LV_LOG_ERROR("Failed to bind freq %lu to find up/down stmt: %s", freq, sqlite3_errmsg(db));
-        pthread_mutex_unlock(&find_up_down_band_mutex);
-        return NULL;
-    }
-    rc = sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":id"), cur_id);
-    if (rc != SQLITE_OK) {
-        LV_LOG_ERROR("Failed to current band id %i to find up/down stmt: %s", cur_id, sqlite3_errmsg(db));
-        pthread_mutex_unlock(&find_up_down_band_mutex);
-        return NULL;
+    band_info_t *band_info;
+
+    pthread_mutex_lock(&index_mutex);
+    if (!band_index) {
+        load_band_index();
     }
-    rc = sqlite3_step(stmt);
-    if (rc == SQLITE_ROW) {
-        if (_band_info_cache.name) {
-            free(_band_info_cache.name);
-            _band_info_cache.name = NULL;
-        }
-        _band_info_cache.id         = sqlite3_column_int(stmt, 0);
-        _band_info_cache.name       = strdup(sqlite3_column_text(stmt, 1));
-        _band_info_cache.active     = true;
-        _band_info_cache.start_freq = sqlite3_column_int(stmt, 2);
-        _band_info_cache.stop_freq  = sqlite3_column_int(stmt, 3);
-        rc                          = 0;
-    } else {
+    band_info = remember_band_info(band_index_next(band_index, freq, up, cur_id));
+    pthread_mutex_unlock(&index_mutex);
+
+    if (!band_info) {
         LV_LOG_INFO("No next band info for freq: %lu, cur_id: %i and direction: %u", freq, cur_id, up);
-        rc = -1;
-    }
-    sqlite3_reset(stmt);
-    sqlite3_clear_bindings(stmt);
-    pthread_mutex_unlock(&find_up_down_band_mutex);
-    if (rc == 0) {
-        return &_band_info_cache;
-    } else {
-        return NULL;
     }
+    return band_info;
 }
 
 uint32_t cfg_band_read_all_bands(band_info_t **results, int32_t *cap) {
     int           rc;
     sqlite3_stmt *stmt = read_all_bands_stmt;
     uint32_t      i    = 0;
+    pthread_mutex_lock(&read_all_bands_mutex);
     while (1) {
         rc = sqlite3_step(stmt);
 
@@ -352,6 +295,7 @@ uint32_t cfg_band_read_all_bands(band_info_t **results, int32_t *cap) {
         }
     }
     sqlite3_reset(stmt);
+    pthread_mutex_unlock(&read_all_bands_mutex);
     return i;
 }
 
@@ -534,44 +478,6 @@ static void init_db(sqlite3 *database) {
         LV_LOG_ERROR("Failed prepare write statement: %s", sqlite3_errmsg(db));
         exit(1);
     }
-    rc = sqlite3_prepare_v2(db, "SELECT name, start_freq, stop_freq, type FROM bands WHERE id = :id", -1,
-                            &read_band_by_pk_stmt, 0);
-    if (rc != SQLITE_OK) {
-        LV_LOG_ERROR("Failed prepare read_band_by_pk_stmt statement: %s", sqlite3_errmsg(db));
-        exit(1);
-    }
-    rc = sqlite3_prepare_v2(
-        db,
-        "SELECT id, name, start_freq, stop_freq FROM bands WHERE "
-        "   (:freq >= start_freq) AND (:freq <= stop_freq) AND (type = 1) "
-        "UNION SELECT * FROM ("
-        "   SELECT NULL, NULL, a.stop_freq, b.start_freq FROM ("
-        "       SELECT stop_freq FROM bands WHERE :freq > stop_freq AND type = 1 ORDER BY stop_freq DESC LIMIT 1"
-        "   ) AS a FULL OUTER JOIN ("
-        "       SELECT start_freq FROM bands WHERE :freq < start_freq AND type = 1 ORDER BY start_freq LIMIT 1"
-        "   ) AS b"
-        ") ORDER BY id DESC NULLS LAST LIMIT 1",
-        -1, &read_band_by_freq_stmt, 0);
-    if (rc != SQLITE_OK) {
-        LV_LOG_ERROR("Failed prepare read_band_by_freq_stmt statement: %s", sqlite3_errmsg(db));
-        exit(1);
-    }
-    rc = sqlite3_prepare_v2(db,
-                            "SELECT id, name, start_freq, stop_freq, type FROM bands "
-                            "WHERE :freq <= start_freq AND id != :id AND type = 1 ORDER BY start_freq LIMIT 1",
-                            -1, &find_up_band_stmt, 0);
-    if (rc != SQLITE_OK) {
-        LV_LOG_ERROR("Failed prepare find_up_band_stmt statement: %s", sqlite3_errmsg(db));
-        exit(1);
-    }
-    rc = sqlite3_prepare_v2(db,
-                            "SELECT id, name, start_freq, stop_freq, type FROM bands "
-                            "WHERE :freq >= stop_freq AND id != :id AND type = 1 ORDER BY start_freq DESC LIMIT 1",
-                            -1, &find_down_band_stmt, 0);
-    if (rc != SQLITE_OK) {
-        LV_LOG_ERROR("Failed prepare find_down_band_stmt statement: %s", sqlite3_errmsg(db));
-        exit(1);
-    }
     rc = sqlite3_prepare_v2(db, "SELECT id, name, start_freq, stop_freq, type FROM bands", -1, &read_all_bands_stmt, 0);
     if (rc != SQLITE_OK) {
         LV_LOG_ERROR("Failed prepare read_all_bands statement: %s", sqlite3_errmsg(db));
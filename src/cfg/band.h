@@ -1,17 +1,10 @@
 #pragma once
 
 #include "common.h"
+#include "band_index.h"
 
 #include <aether_radio/x6100_control/control.h>
 
-typedef struct {
-    int32_t  id;
-    char    *name;
-    uint32_t start_freq;
-    uint32_t stop_freq;
-    int32_t  active;
-} band_info_t;
-
 struct vfo_params {
     cfg_item_t freq;
     cfg_item_t mode;
@@ -0,0 +1,261 @@
+/**
+ * Sorted interval index of bands
+ */
+#include "band_index.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint64_t     start;     /* First freq of segment */
+    band_info_t *info;      /* Band or gap */
+} segment_t;
+
+struct band_index_s {
+    band_info_t  *bands;        /* All bands, sorted by id */
+    size_t        bands_count;
+
+    /* Active bands and gaps between them, cover all frequencies */
+    segment_t    *segments;
+    size_t        segments_count;
+    band_info_t  *gaps;
+
+    /* Active bands */
+    band_info_t **by_start;     /* Sorted by start_freq */
+    band_info_t **by_stop;      /* Sorted by stop_freq */
+    band_info_t **down_best;    /* Two bands with max start_freq in by_stop[0..i] */
+    size_t        active_count;
+};
+
+static int cmp_id(const void *a, const void *b) {
+    const band_info_t *x = a;
+    const band_info_t *y = b;
+
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+static int cmp_start(const void *a, const void *b) {
+    const band_info_t *x = *(band_info_t **)a;
+    const band_info_t *y = *(band_info_t **)b;
+
+    if (x->start_freq != y->start_freq) {
+        return (x->start_freq > y->start_freq) - (x->start_freq < y->start_freq);
+    }
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+static int cmp_stop(const void *a, const void *b) {
+    const band_info_t *x = *(band_info_t **)a;
+    const band_info_t *y = *(band_info_t **)b;
+
+    if (x->stop_freq != y->stop_freq) {
+        return (x->stop_freq > y->stop_freq) - (x->stop_freq < y->stop_freq);
+    }
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(uint64_t *)a;
+    uint64_t y = *(uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * Active band with greater id covering freq
+ */
+static band_info_t *cover(band_index_t *idx, uint64_t freq) {
+    band_info_t *res = NULL;
+
+    for (size_t i = 0; i < idx->active_count && idx->by_start[i]->start_freq <= freq; i++) {
+        band_info_t *band = idx->by_start[i];
+
+        if (band->stop_freq >= freq && (!res || band->id > res->id)) {
+            res = band;
+        }
+    }
+    return res;
+}
+
+static void build_segments(band_index_t *idx) {
+    size_t    n = 0;
+    uint64_t *edges = malloc((idx->active_count * 2 + 1) * sizeof(uint64_t));
+
+    /* Segments are half-open [start, next start) */
+    edges[n++] = 0;
+
+    for (size_t i = 0; i < idx->active_count; i++) {
+        edges[n++] = idx->by_start[i]->start_freq;
+        edges[n++] = (uint64_t)idx->by_start[i]->stop_freq + 1;
+    }
+    qsort(edges, n, sizeof(uint64_t), cmp_u64);
+
+    idx->segments = malloc(n * sizeof(segment_t));
+    idx->gaps = calloc(n, sizeof(band_info_t));
+    idx->segments_count = 0;
+
+    size_t gaps_count = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        if (i > 0 && edges[i] == edges[i - 1]) {
+            continue;
+        }
+
+        band_info_t *band = cover(idx, edges[i]);
+
+        if (idx->segments_count > 0) {
+            segment_t *prev = &idx->segments[idx->segments_count - 1];
+
+            if (band && prev->info == band) {
+                continue;
+            }
+            if (prev->info->id < 0) {
+                prev->info->stop_freq = edges[i];
+            }
+        }
+
+        if (!band) {
+            band = &idx->gaps[gaps_count++];
+            band->id = -1;
+            band->name = NULL;
+            band->active = false;
+            band->start_freq = edges[i] > 0 ? edges[i] - 1 : 0;
+            band->stop_freq = UINT32_MAX;
+        }
+
+        idx->segments[idx->segments_count].start = edges[i];
+        idx->segments[idx->segments_count].info = band;
+        idx->segments_count++;
+    }
+
+    free(edges);
+}
+
+static void build_down_best(band_index_t *idx) {
+    band_info_t *best = NULL, *second = NULL;
+
+    idx->down_best = malloc(idx->active_count * 2 * sizeof(band_info_t *));
+
+    for (size_t i = 0; i < idx->active_count; i++) {
+        band_info_t *band = idx->by_stop[i];
+
+        if (!best || band->start_freq > best->start_freq) {
+            second = best;
+            best = band;
+        } else if (!second || band->start_freq > second->start_freq) {
+            second = band;
+        }
+        idx->down_best[i * 2] = best;
+        idx->down_best[i * 2 + 1] = second;
+    }
+}
+
+band_index_t *band_index_create(const band_info_t *bands, size_t count) {
+    band_index_t *idx = calloc(1, sizeof(band_index_t));
+
+    idx->bands = malloc((count ? count : 1) * sizeof(band_info_t));
+    idx->bands_count = count;
+    memcpy(idx->bands, bands, count * sizeof(band_info_t));
+
+    for (size_t i = 0; i < count; i++) {
+        idx->bands[i].name = bands[i].name ? strdup(bands[i].name) : NULL;
+    }
+    qsort(idx->bands, count, sizeof(band_info_t), cmp_id);
+
+    idx->by_start = malloc((count ? count : 1) * sizeof(band_info_t *));
+    idx->by_stop = malloc((count ? count : 1) * sizeof(band_info_t *));
+
+    for (size_t i = 0; i < count; i++) {
+        band_info_t *band = &idx->bands[i];
+
+        if (band->active == 1 && band->start_freq <= band->stop_freq) {
+            idx->by_start[idx->active_count] = band;
+            idx->by_stop[idx->active_count] = band;
+            idx->active_count++;
+        }
+    }
+    qsort(idx->by_start, idx->active_count, sizeof(band_info_t *), cmp_start);
+    qsort(idx->by_stop, idx->active_count, sizeof(band_info_t *), cmp_stop);
+
+    build_segments(idx);
+    build_down_best(idx);
+
+    return idx;
+}
+
+void band_index_destroy(band_index_t *idx) {
+    if (!idx) {
+        return;
+    }
+    for (size_t i = 0; i < idx->bands_count; i++) {
+        free(idx->bands[i].name);
+    }
+    free(idx->bands);
+    free(idx->segments);
+    free(idx->gaps);
+    free(idx->by_start);
+    free(idx->by_stop);
+    free(idx->down_best);
+    free(idx);
+}
+
+band_info_t *band_index_by_pk(band_index_t *idx, int32_t id) {
+    band_info_t key = { .id = id };
+
+    return bsearch(&key, idx->bands, idx->bands_count, sizeof(band_info_t), cmp_id);
+}
+
+band_info_t *band_index_by_freq(band_index_t *idx, uint32_t freq) {
+    size_t lo = 0, hi = idx->segments_count;
+
+    /* Last segment with start <= freq, first one starts from 0 */
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+
+        if (idx->segments[mid].start <= freq) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return idx->segments[lo].info;
+}
+
+band_info_t *band_index_next(band_index_t *idx, uint32_t freq, bool up, int32_t cur_id) {
+    size_t lo = 0, hi = idx->active_count;
+
+    if (up) {
+        /* First band with start_freq >= freq */
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+
+            if (idx->by_start[mid]->start_freq < freq) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo < idx->active_count && idx->by_start[lo]->id == cur_id) {
+            lo++;
+        }
+        return lo < idx->active_count ? idx->by_start[lo] : NULL;
+    }
+
+    /* Count of bands with stop_freq <= freq */
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+
+        if (idx->by_stop[mid]->stop_freq <= freq) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0) {
+        return NULL;
+    }
+
+    band_info_t *best = idx->down_best[(lo - 1) * 2];
+
+    return best->id != cur_id ? best : idx->down_best[(lo - 1) * 2 + 1];
+}
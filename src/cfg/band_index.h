@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    int32_t  id;
+    char    *name;
+    uint32_t start_freq;
+    uint32_t stop_freq;
+    int32_t  active;
+} band_info_t;
+
+/*
+ * Sorted interval index of bands table. Only active bands (type = 1) are used
+ * for frequency lookups, overlapped bands are resolved to the one with greater id.
+ * Returned pointers are valid until index is destroyed.
+ */
+
+typedef struct band_index_s band_index_t;
+
+/**
+ * Create index, bands and their names are copied
+ */
+band_index_t *band_index_create(const band_info_t *bands, size_t count);
+void          band_index_destroy(band_index_t *idx);
+
+band_info_t *band_index_by_pk(band_index_t *idx, int32_t id);
+
+/**
+ * Band containing freq (start_freq <= freq <= stop_freq). For freq outside of bands
+ * gap is returned: id is BAND_UNDEFINED (-1), start/stop are edges of nearest bands
+ * (0 and UINT32_MAX if there are no bands below/above)
+ */
+band_info_t *band_index_by_freq(band_index_t *idx, uint32_t freq);
+
+/**
+ * Nearest band above (start_freq >= freq) or below (stop_freq <= freq) excluding cur_id
+ */
+band_info_t *band_index_next(band_index_t *idx, uint32_t freq, bool up, int32_t cur_id);
@@ -7,6 +7,7 @@
 #include "transverter.private.h"
 #include "memory.private.h"
 #include "digital_modes.private.h"
+#include "persist.h"
 
 #include "../lvgl/lvgl.h"
 #include "../util.h"
@@ -29,8 +30,6 @@ static int init_params_cfg(sqlite3 *db);
 // static int init_mode_cfg(sqlite3 *db);
 
 
-static void *params_save_thread(void *arg);
-
 static void on_key_tone_change(Subject *subj, void *user_data);
 static void on_item_change(Subject *subj, void *user_data);
 static void on_vfo_change(Subject *subj, void *user_data);
@@ -114,6 +113,8 @@ cfg_mfk_mode_t cfg_encoder_mfk_modes[] = {
 int cfg_init(sqlite3 *db) {
     int rc;
 
+    cfg_persist_init(db);
+
     rc = init_params_cfg(db);
     if (rc != 0) {
         LV_LOG_ERROR("Error during loading params");
@@ -141,10 +142,6 @@ int cfg_init(sqlite3 *db) {
     cfg_memory_init(db);
     cfg_digital_modes_init(db);
 
-    pthread_t thread;
-    pthread_create(&thread, NULL, params_save_thread, NULL);
-    pthread_detach(thread);
-
 #ifdef TEST_CFG
     run_tests();
 #endif
@@ -155,13 +152,23 @@ int cfg_init(sqlite3 *db) {
  * Delayed save of item
  */
 static void on_item_change(Subject *subj, void *user_data) {
-    cfg_item_t *item = (cfg_item_t *)user_data;
+    cfg_item_t        *item = (cfg_item_t *)user_data;
+    enum item_state_t prev;
+
     pthread_mutex_lock(&item->dirty->mux);
-    if (item->dirty->val != ITEM_STATE_LOADING) {
+    prev = item->dirty->val;
+    if (prev == ITEM_STATE_CLEAN) {
         item->dirty->val = ITEM_STATE_CHANGED;
         LV_LOG_INFO("Set dirty %s (pk=%i)", item->db_name, item->pk);
     }
     pthread_mutex_unlock(&item->dirty->mux);
+
+    /* Changed item is already in the queue, just postpone the flush */
+    if (prev == ITEM_STATE_CLEAN) {
+        cfg_persist_item(item);
+    } else if (prev == ITEM_STATE_CHANGED) {
+        cfg_persist_touch();
+    }
 }
 
 /**
@@ -255,35 +262,6 @@ void fill_cfg_item_float(cfg_item_t *item, Subject * val, float db_scale, const
     item->val = val;
 }
 
-/**
- * Save thread
- */
-static void *params_save_thread(void *arg) {
-    cfg_item_t *cfg_arr;
-    cfg_arr           = (cfg_item_t *)&cfg;
-    uint32_t cfg_size = sizeof(cfg) / sizeof(cfg_item_t);
-
-    cfg_item_t *cfg_band_arr;
-    cfg_band_arr           = (cfg_item_t *)&cfg_band;
-    uint32_t cfg_band_size = sizeof(cfg_band) / sizeof(cfg_item_t);
-
-    cfg_item_t *cfg_mode_arr;
-    cfg_mode_arr           = (cfg_item_t *)&cfg_mode;
-    uint32_t cfg_mode_size = sizeof(cfg_mode) / sizeof(cfg_item_t);
-
-    cfg_item_t *cfg_transverter_arr;
-    cfg_transverter_arr           = (cfg_item_t *)&cfg_transverters;
-    uint32_t cfg_transverter_size = sizeof(cfg_transverters) / sizeof(cfg_item_t);
-
-    while (true) {
-        save_items_to_db(cfg_arr, cfg_size);
-        save_items_to_db(cfg_band_arr, cfg_band_size);
-        save_items_to_db(cfg_mode_arr, cfg_mode_size);
-        save_items_to_db(cfg_transverter_arr, cfg_transverter_size);
-        sleep_usec(10000000);
-    }
-}
-
 /**
  * Initialization functions
  */
@@ -336,6 +314,7 @@ static int init_params_cfg(sqlite3 *db) {
     /* CW decoder */
     fill_cfg_item(&cfg.cw_decoder, subject_create_int(true), "cw_decoder");
     fill_cfg_item(&cfg.cw_tune, subject_create_int(false), "cw_tune");
+    fill_cfg_item(&cfg.cw_skimmer, subject_create_int(false), "cw_skimmer");
     fill_cfg_item_float(&cfg.cw_decoder_snr, subject_create_float(5.0f), 0.1f, "cw_decoder_snr_2");
     fill_cfg_item_float(&cfg.cw_decoder_snr_gist, subject_create_float(1.0f), 0.1f, "cw_decoder_snr_gist");
     fill_cfg_item_float(&cfg.cw_decoder_peak_beta, subject_create_float(0.10f), 0.01f, "cw_decoder_peak_beta");
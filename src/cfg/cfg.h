@@ -113,6 +113,7 @@ typedef struct {
     /* CW decoder */
     cfg_item_t cw_decoder;
     cfg_item_t cw_tune;
+    cfg_item_t cw_skimmer;
     cfg_item_t cw_decoder_snr;
     cfg_item_t cw_decoder_snr_gist;
     cfg_item_t cw_decoder_peak_beta;
@@ -0,0 +1,186 @@
+/**
+ * Write-behind persistence of cfg items and params
+ */
+#include "persist.h"
+
+#include "cfg.private.h"
+
+#include "../lvgl/lvgl.h"
+#include "../util.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define PERSIST_DELAY       (3 * 1000)      /* ms after the last change */
+#define PERSIST_MAX_DELAY   (10 * 1000)     /* ms after the first change */
+#define MAX_WRITERS         4
+
+typedef struct {
+    cfg_item_t  **items;
+    size_t      count;
+    size_t      size;
+} queue_t;
+
+static sqlite3              *db;
+
+static pthread_mutex_t      mux = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t       cond = PTHREAD_COND_INITIALIZER;
+static queue_t              queue;
+static bool                 writers_dirty = false;
+static uint64_t             first_change;
+static uint64_t             last_change;
+
+/* Serialize flushes from the thread and cfg_persist_flush() */
+static pthread_mutex_t      flush_mux = PTHREAD_MUTEX_INITIALIZER;
+static queue_t              flush_queue;
+
+static cfg_persist_writer_t writers[MAX_WRITERS];
+static size_t               writers_count = 0;
+
+static bool is_pending() {
+    return queue.count > 0 || writers_dirty;
+}
+
+/* Call with mux locked */
+static void changed() {
+    uint64_t now = get_time();
+
+    if (!is_pending()) {
+        first_change = now;
+    }
+    last_change = now;
+    pthread_cond_signal(&cond);
+}
+
+void cfg_persist_item(cfg_item_t *item) {
+    pthread_mutex_lock(&mux);
+    changed();
+
+    if (queue.count == queue.size) {
+        queue.size = queue.size ? queue.size * 2 : 32;
+        queue.items = realloc(queue.items, queue.size * sizeof(cfg_item_t *));
+    }
+    queue.items[queue.count++] = item;
+    pthread_mutex_unlock(&mux);
+}
+
+void cfg_persist_touch() {
+    pthread_mutex_lock(&mux);
+    if (is_pending()) {
+        last_change = get_time();
+    }
+    pthread_mutex_unlock(&mux);
+}
+
+void cfg_persist_schedule() {
+    pthread_mutex_lock(&mux);
+    changed();
+    writers_dirty = true;
+    pthread_mutex_unlock(&mux);
+}
+
+void cfg_persist_add_writer(cfg_persist_writer_t writer) {
+    pthread_mutex_lock(&mux);
+    if (writers_count < MAX_WRITERS) {
+        writers[writers_count++] = writer;
+    } else {
+        LV_LOG_ERROR("Too many persist writers");
+    }
+    pthread_mutex_unlock(&mux);
+}
+
+void cfg_persist_flush() {
+    if (!db) {
+        return;
+    }
+
+    pthread_mutex_lock(&flush_mux);
+
+    pthread_mutex_lock(&mux);
+    queue_t tmp = flush_queue;
+    flush_queue = queue;
+    queue = tmp;
+    queue.count = 0;
+
+    bool call_writers = writers_dirty;
+    writers_dirty = false;
+    pthread_mutex_unlock(&mux);
+
+    if (flush_queue.count == 0 && !call_writers) {
+        pthread_mutex_unlock(&flush_mux);
+        return;
+    }
+
+    bool tx = sqlite3_exec(db, "BEGIN", NULL, NULL, NULL) == SQLITE_OK;
+
+    if (!tx) {
+        LV_LOG_WARN("Can't begin transaction: %s", sqlite3_errmsg(db));
+    }
+
+    /* Items saved meanwhile (e.g. before band change) are clean and skipped */
+    for (size_t i = 0; i < flush_queue.count; i++) {
+        save_item_to_db(flush_queue.items[i], false);
+    }
+
+    if (call_writers) {
+        for (size_t i = 0; i < writers_count; i++) {
+            writers[i]();
+        }
+    }
+
+    if (tx && sqlite3_exec(db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
+        LV_LOG_ERROR("Can't commit settings: %s", sqlite3_errmsg(db));
+    }
+
+    LV_LOG_INFO("Persisted %zu items", flush_queue.count);
+    flush_queue.count = 0;
+    pthread_mutex_unlock(&flush_mux);
+}
+
+static void * persist_thread(void *arg) {
+    pthread_mutex_lock(&mux);
+
+    while (true) {
+        if (!is_pending()) {
+            pthread_cond_wait(&cond, &mux);
+            continue;
+        }
+
+        uint64_t deadline = last_change + PERSIST_DELAY;
+
+        if (deadline > first_change + PERSIST_MAX_DELAY) {
+            deadline = first_change + PERSIST_MAX_DELAY;
+        }
+
+        uint64_t now = get_time();
+
+        if (now < deadline) {
+            struct timespec ts;
+
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_sec += (deadline - now) / 1000;
+            ts.tv_nsec += (deadline - now) % 1000 * 1000000L;
+
+            if (ts.tv_nsec >= 1000000000L) {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&cond, &mux, &ts);
+            continue;
+        }
+
+        pthread_mutex_unlock(&mux);
+        cfg_persist_flush();
+        pthread_mutex_lock(&mux);
+    }
+}
+
+void cfg_persist_init(sqlite3 *database) {
+    pthread_t thread;
+
+    db = database;
+
+    pthread_create(&thread, NULL, persist_thread, NULL);
+    pthread_detach(thread);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <sqlite3.h>
+
+/*
+ * Write-behind persistence of settings.
+ *
+ * Changed cfg items are queued by their observers. Queue is written in a single
+ * transaction after the changes settle down (or no later than max delay after the
+ * first one), the thread sleeps while nothing is changed.
+ */
+
+typedef void (*cfg_persist_writer_t)(void);
+
+void cfg_persist_init(sqlite3 *db);
+
+/**
+ * Add writer, called on flush after cfg_persist_schedule(). Writer should save
+ * own changed values only
+ */
+void cfg_persist_add_writer(cfg_persist_writer_t writer);
+
+/**
+ * Something is changed outside of cfg items, call writers with the next flush
+ */
+void cfg_persist_schedule();
+
+/**
+ * Write all pending changes now (poweroff, low battery)
+ */
+void cfg_persist_flush();
@@ -7,57 +7,129 @@ extern "C" {
     #include <stdlib.h>
 }
 
-Observer::~Observer() {
-    subj->unsubscribe(this);
+/* Subscription */
+
+void Subscription::notify() {
+    call();
 }
 
-void Observer::notify() {
-    this->fn(subj, user_data);
-};
+void Subscription::call() {
+    if (active.load(std::memory_order_acquire)) {
+        fn(subj, user_data);
+    }
+}
 
-std::list<ObserverDelayed*> ObserverDelayed::instances;
+void Subscription::cancel() {
+    active.store(false, std::memory_order_release);
+}
 
-ObserverDelayed::~ObserverDelayed() {
-    auto item = std::find(instances.begin(), instances.end(), this);
-    instances.erase(item);
+Subject *Subscription::subject() {
+    return subj;
 }
 
-void ObserverDelayed::notify() {
-    auto call_tid = std::this_thread::get_id();
-    if (call_tid != tid) {
-        changed = true;
-    } else {
-        this->Observer::notify();
-        changed = false;
+std::atomic<SubscriptionDelayed *> SubscriptionDelayed::pending = nullptr;
+
+void SubscriptionDelayed::notify() {
+    if (std::this_thread::get_id() == tid) {
+        changed.store(false, std::memory_order_relaxed);
+        call();
+        return;
+    }
+
+    changed.store(true, std::memory_order_release);
+
+    if (queued.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    self = shared_from_this();
+    next = pending.load(std::memory_order_relaxed);
+
+    while (!pending.compare_exchange_weak(next, this, std::memory_order_release, std::memory_order_relaxed)) {
     }
 }
 
-void ObserverDelayed::notify_all_delayed() {
-    for (auto item: ObserverDelayed::instances) {
-        if (item->changed) {
-            item->Observer::notify();
+/* Only subscriptions with changes are touched, in order of the first change */
+void SubscriptionDelayed::notify_all_delayed() {
+    SubscriptionDelayed *item = pending.exchange(nullptr, std::memory_order_acquire);
+    SubscriptionDelayed *fifo = nullptr;
+
+    while (item) {
+        SubscriptionDelayed *rest = item->next;
+
+        item->next = fifo;
+        fifo = item;
+        item = rest;
+    }
+
+    while (fifo) {
+        std::shared_ptr<SubscriptionDelayed> keep = std::move(fifo->self);
+        SubscriptionDelayed *rest = fifo->next;
+
+        fifo->queued.store(false, std::memory_order_release);
+
+        if (fifo->changed.exchange(false, std::memory_order_acq_rel)) {
+            fifo->call();
         }
+        fifo = rest;
     }
 }
 
-Observer* Subject::subscribe(void (*fn)(Subject *, void *), void *user_data) {
+/* Observer */
+
+Observer::~Observer() {
+    sub->cancel();
+    sub->subject()->unsubscribe(sub.get());
+}
+
+void Observer::notify() {
+    sub->notify();
+}
+
+void ObserverDelayed::notify_all_delayed() {
+    SubscriptionDelayed::notify_all_delayed();
+}
+
+/* Subject */
+
+void Subject::add(std::shared_ptr<Subscription> sub) {
     const std::lock_guard<std::mutex> lock(mutex_subscribe);
 
-    auto observer = new Observer(this, fn, user_data);
-    observers.push_back(observer);
-    return observer;
+    auto list = std::make_shared<subscriptions_t>(*std::atomic_load(&subscriptions));
+
+    list->push_back(sub);
+    std::atomic_store(&subscriptions, std::shared_ptr<const subscriptions_t>(list));
+}
+
+void Subject::notify() {
+    auto list = std::atomic_load(&subscriptions);
+
+    for (auto &sub : *list) {
+        sub->notify();
+    }
+}
+
+Observer* Subject::subscribe(void (*fn)(Subject *, void *), void *user_data) {
+    auto sub = std::make_shared<Subscription>(this, fn, user_data);
+
+    add(sub);
+    return new Observer(sub);
 }
 
 ObserverDelayed *Subject::subscribe_delayed(void (*fn)(Subject *, void *), void *user_data) {
-    const std::lock_guard<std::mutex> lock(mutex_subscribe);
+    auto sub = std::make_shared<SubscriptionDelayed>(this, fn, user_data);
 
-    auto observer = new ObserverDelayed(this, fn, user_data);
-    observers.push_back(observer);
-    return observer;
+    add(sub);
+    return new ObserverDelayed(sub);
 }
 
-void Subject::unsubscribe(Observer *observer) {
-    observers.erase(std::find(observers.begin(), observers.end(), observer));
+void Subject::unsubscribe(Subscription *sub) {
+    const std::lock_guard<std::mutex> lock(mutex_subscribe);
+
+    auto list = std::make_shared<subscriptions_t>(*std::atomic_load(&subscriptions));
+
+    list->erase(std::remove_if(list->begin(), list->end(), [sub](auto &item) { return item.get() == sub; }), list->end());
+    std::atomic_store(&subscriptions, std::shared_ptr<const subscriptions_t>(list));
 }
 
 data_type Subject::dtype() {
@@ -12,51 +12,91 @@ enum data_type {
 
 #include <mutex>
 #include <algorithm>
-#include <list>
+#include <memory>
+#include <vector>
 #include <type_traits>
 #include <thread>
 #include <atomic>
 
 class Subject;
 
-class Observer {
+/*
+ * Subscription is shared by the observers list of the subject and the Observer handle.
+ * Notification in progress (or queued delayed one) keeps it alive after the Observer is deleted,
+ * cancelled subscription is skipped.
+ */
+class Subscription {
   protected:
-    Subject *subj;
-    void (*fn)(Subject *, void *);
-    void *user_data;
+    Subject             *subj;
+    void                (*fn)(Subject *, void *);
+    void                *user_data;
+    std::atomic<bool>   active = true;
 
   public:
-    Observer(Subject *subj, void (*fn)(Subject *, void *), void *user_data)
+    Subscription(Subject *subj, void (*fn)(Subject *, void *), void *user_data)
         : subj(subj), fn(fn), user_data(user_data) {};
-    virtual ~Observer();
+    virtual ~Subscription() = default;
     virtual void notify();
+    void call();
+    void cancel();
+    Subject *subject();
 };
 
-class ObserverDelayed : public Observer {
-    static std::list<ObserverDelayed *> instances;
+/*
+ * Called at once in the thread of subscription, from other threads - queued to the lock-free
+ * pending list and called by notify_all_delayed(). Repeated changes before the call are coalesced
+ */
+class SubscriptionDelayed : public Subscription, public std::enable_shared_from_this<SubscriptionDelayed> {
+    static std::atomic<SubscriptionDelayed *> pending;
+
     std::thread::id                     tid;
     std::atomic<bool>                   changed = false;
+    std::atomic<bool>                   queued = false;
+    SubscriptionDelayed                 *next = nullptr;
+    std::shared_ptr<SubscriptionDelayed> self;  /* Alive while queued */
 
   public:
-    ObserverDelayed(Subject *subj, void (*fn)(Subject *, void *), void *user_data) : Observer(subj, fn, user_data) {
-        tid = std::this_thread::get_id();
-        instances.push_back(this);
-    };
-    ~ObserverDelayed();
+    SubscriptionDelayed(Subject *subj, void (*fn)(Subject *, void *), void *user_data)
+        : Subscription(subj, fn, user_data), tid(std::this_thread::get_id()) {};
     void        notify();
     static void notify_all_delayed();
 };
 
+class Observer {
+  protected:
+    std::shared_ptr<Subscription> sub;
+
+  public:
+    Observer(std::shared_ptr<Subscription> sub) : sub(sub) {};
+    virtual ~Observer();
+    void notify();
+};
+
+class ObserverDelayed : public Observer {
+  public:
+    using Observer::Observer;
+    static void notify_all_delayed();
+};
+
+typedef std::vector<std::shared_ptr<Subscription>> subscriptions_t;
+
 class Subject {
-    std::mutex mutex_subscribe;
-    protected:
-    std::list<Observer*> observers;
+    std::mutex                              mutex_subscribe;
+    /* Copy on write, set() iterates snapshot without lock */
+    std::shared_ptr<const subscriptions_t>  subscriptions = std::make_shared<const subscriptions_t>();
+
+    void add(std::shared_ptr<Subscription> sub);
+
+  protected:
     data_type type;
-    public:
+    void notify();
+
+  public:
+    virtual ~Subject() = default;
     virtual data_type dtype();
     Observer* subscribe(void (*fn)(Subject *, void *), void *user_data=nullptr);
     ObserverDelayed* subscribe_delayed(void (*fn)(Subject *, void *), void *user_data=nullptr);
-    void unsubscribe(Observer *o);
+    void unsubscribe(Subscription *sub);
 };
 
 template <typename T> class SubjectT : public Subject {
@@ -72,11 +112,8 @@ template <typename T> class SubjectT : public Subject {
         return val;
     };
     void set(T val) {
-        if (this->val != val) {
-            this->val = val;
-            for (auto observer : observers) {
-                observer->notify();
-            }
+        if (this->val.exchange(val) != val) {
+            notify();
         }
     };
     data_type dtype() {
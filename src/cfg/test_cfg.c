@@ -27,19 +27,19 @@ static void test_load_band_by_freq() {
     } data[] = {
         {400 * kHz,       -1},
         {14 * MHz - 1,    -1},
-        {14 * MHz,        -1},
+        {14 * MHz,        6 },
         {14 * MHz + 1,    6 },
         {14070 * kHz - 1, 6 },
-        {14070 * kHz,     6 },
+        {14070 * kHz,     7 },
         {14070 * kHz + 1, 7 },
         {14350 * kHz,     7 },
         {14350 * kHz + 1, -1},
         {99 * MHz,        -1},
         {14350 * kHz,     7 },
         {14070 * kHz + 1, 7 },
-        {14070 * kHz,     6 },
+        {14070 * kHz,     7 },
         {14 * MHz + 1,    6 },
-        {14 * MHz,        -1},
+        {14 * MHz,        6 },
     };
     size_t freq_len = sizeof(data) / sizeof(*data);
     bool   success = true;
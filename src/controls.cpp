@@ -37,6 +37,11 @@ void controls_toggle_cw_tuner(button_item_t *btn) {
     voice_say_bool("CW Decoder", new_val);
 }
 
+void controls_toggle_cw_skimmer(button_item_t *btn) {
+    bool new_val = toggle_subj(cfg.cw_skimmer.val);
+    voice_say_bool("CW skimmer", new_val);
+}
+
 void controls_toggle_dnf(button_item_t *btn) {
     bool new_val = toggle_subj(cfg.dnf.val);
     voice_say_bool("DNF", new_val);
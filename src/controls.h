@@ -12,6 +12,7 @@ void controls_toggle_key_train(button_item_t *btn);
 void controls_toggle_key_iambic_mode(button_item_t *btn);
 void controls_toggle_cw_decoder(button_item_t *btn);
 void controls_toggle_cw_tuner(button_item_t *btn);
+void controls_toggle_cw_skimmer(button_item_t *btn);
 
 void controls_toggle_dnf(button_item_t *btn);
 void controls_toggle_dnf_auto(button_item_t *btn);
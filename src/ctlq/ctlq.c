@@ -0,0 +1,241 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#include "ctlq.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    ctlq_cmd_t  cmd;
+    uint64_t    time;           /* us, first put */
+} item_t;
+
+struct ctlq_s {
+    item_t          *items;     /* Pending, oldest first */
+    uint32_t        size;
+    uint32_t        count;
+    bool            busy;
+    bool            started;
+    bool            stop;
+
+    void            (*lock)(void);
+    void            (*unlock)(void);
+
+    pthread_t       thread;
+    pthread_mutex_t mux;
+    pthread_cond_t  cond_put;
+    pthread_cond_t  cond_idle;
+
+    ctlq_stats_t    stats;
+    uint64_t        bus_sum;
+    uint64_t        wait_sum;
+};
+
+static uint64_t get_time_us() {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000L + now.tv_nsec / 1000L;
+}
+
+ctlq_t * ctlq_create(uint32_t size, void (*lock)(void), void (*unlock)(void)) {
+    ctlq_t *q = calloc(1, sizeof(ctlq_t));
+
+    q->items = malloc(sizeof(item_t) * size);
+    q->size = size;
+    q->lock = lock;
+    q->unlock = unlock;
+
+    pthread_mutex_init(&q->mux, NULL);
+    pthread_cond_init(&q->cond_put, NULL);
+    pthread_cond_init(&q->cond_idle, NULL);
+
+    return q;
+}
+
+static void execute(ctlq_t *q, const ctlq_cmd_t *cmd) {
+    if (q->lock) {
+        q->lock();
+    }
+    cmd->fn(cmd);
+    if (q->unlock) {
+        q->unlock();
+    }
+}
+
+/* Called with mux locked */
+static void stats_put(ctlq_t *q, uint64_t wait, uint64_t bus) {
+    q->stats.commands++;
+
+    q->wait_sum += wait;
+    if (wait > q->stats.wait_max) {
+        q->stats.wait_max = wait;
+    }
+
+    q->bus_sum += bus;
+    if (bus > q->stats.bus_max) {
+        q->stats.bus_max = bus;
+    }
+}
+
+static void * ctlq_thread(void *arg) {
+    ctlq_t  *q = arg;
+    item_t  item;
+
+    pthread_mutex_lock(&q->mux);
+
+    while (true) {
+        while (q->count == 0 && !q->stop) {
+            q->busy = false;
+            pthread_cond_broadcast(&q->cond_idle);
+            pthread_cond_wait(&q->cond_put, &q->mux);
+        }
+
+        if (q->count == 0) {
+            break;
+        }
+
+        item = q->items[0];
+        q->count--;
+        memmove(&q->items[0], &q->items[1], sizeof(item_t) * q->count);
+        q->busy = true;
+
+        pthread_mutex_unlock(&q->mux);
+
+        uint64_t start = get_time_us();
+
+        execute(q, &item.cmd);
+
+        uint64_t end = get_time_us();
+
+        pthread_mutex_lock(&q->mux);
+        stats_put(q, start - item.time, end - start);
+    }
+
+    q->busy = false;
+    pthread_cond_broadcast(&q->cond_idle);
+    pthread_mutex_unlock(&q->mux);
+
+    return NULL;
+}
+
+bool ctlq_start(ctlq_t *q) {
+    pthread_mutex_lock(&q->mux);
+
+    if (pthread_create(&q->thread, NULL, ctlq_thread, q) != 0) {
+        pthread_mutex_unlock(&q->mux);
+        return false;
+    }
+    q->started = true;
+
+    pthread_mutex_unlock(&q->mux);
+    return true;
+}
+
+void ctlq_destroy(ctlq_t *q) {
+    if (q->started) {
+        pthread_mutex_lock(&q->mux);
+        q->stop = true;
+        pthread_cond_signal(&q->cond_put);
+        pthread_mutex_unlock(&q->mux);
+
+        pthread_join(q->thread, NULL);
+    } else {
+        ctlq_flush(q);
+    }
+
+    pthread_cond_destroy(&q->cond_idle);
+    pthread_cond_destroy(&q->cond_put);
+    pthread_mutex_destroy(&q->mux);
+    free(q->items);
+    free(q);
+}
+
+void ctlq_put(ctlq_t *q, const ctlq_cmd_t *cmd) {
+    uint64_t now = get_time_us();
+
+    pthread_mutex_lock(&q->mux);
+
+    if (cmd->key) {
+        for (uint32_t i = 0; i < q->count; i++) {
+            if (q->items[i].cmd.key == cmd->key) {
+                now = q->items[i].time;
+                q->count--;
+                memmove(&q->items[i], &q->items[i + 1], sizeof(item_t) * (q->count - i));
+                q->stats.coalesced++;
+                break;
+            }
+        }
+    }
+
+    if (q->count == q->size) {
+        bool own = q->started && pthread_equal(pthread_self(), q->thread);
+
+        q->stats.overflows++;
+        pthread_mutex_unlock(&q->mux);
+
+        /* Keep the order: everything queued goes before. Not possible from the command itself */
+        if (!own) {
+            ctlq_flush(q);
+        }
+        execute(q, cmd);
+        return;
+    }
+
+    q->items[q->count].cmd = *cmd;
+    q->items[q->count].time = now;
+    q->count++;
+
+    if (q->count > q->stats.max_pending) {
+        q->stats.max_pending = q->count;
+    }
+
+    pthread_cond_signal(&q->cond_put);
+    pthread_mutex_unlock(&q->mux);
+}
+
+void ctlq_flush(ctlq_t *q) {
+    item_t item;
+
+    pthread_mutex_lock(&q->mux);
+
+    /* Without the thread commands are executed by the caller */
+    while (!q->started && q->count > 0) {
+        item = q->items[0];
+        q->count--;
+        memmove(&q->items[0], &q->items[1], sizeof(item_t) * q->count);
+
+        pthread_mutex_unlock(&q->mux);
+        execute(q, &item.cmd);
+        pthread_mutex_lock(&q->mux);
+    }
+
+    while (q->count > 0 || q->busy) {
+        pthread_cond_wait(&q->cond_idle, &q->mux);
+    }
+
+    pthread_mutex_unlock(&q->mux);
+}
+
+void ctlq_stats(ctlq_t *q, ctlq_stats_t *stats) {
+    pthread_mutex_lock(&q->mux);
+
+    *stats = q->stats;
+
+    if (q->stats.commands) {
+        stats->bus_avg = q->bus_sum / q->stats.commands;
+        stats->wait_avg = q->wait_sum / q->stats.commands;
+    }
+
+    memset(&q->stats, 0, sizeof(q->stats));
+    q->bus_sum = 0;
+    q->wait_sum = 0;
+
+    pthread_mutex_unlock(&q->mux);
+}
@@ -0,0 +1,73 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Command queue with own thread for the slow control bus.
+ *
+ * Producers never wait for the bus. A command with the same not zero key as
+ * a pending one replaces it and moves to the tail, so only the latest value
+ * is sent, after everything queued before it. Commands with zero key are
+ * never merged: use it for steps of sequences (PTT, ATU, mode switches).
+ */
+
+typedef struct ctlq_s ctlq_t;
+typedef struct ctlq_cmd_s ctlq_cmd_t;
+
+typedef void (*ctlq_fn_t)(const ctlq_cmd_t *cmd);
+
+struct ctlq_cmd_s {
+    ctlq_fn_t   fn;
+    uintptr_t   key;
+    void        *user_data;
+    int32_t     arg;
+    union {
+        int32_t i;
+        float   f;
+    } val;
+};
+
+typedef struct {
+    uint32_t    commands;       /* Sent to the bus */
+    uint32_t    coalesced;      /* Replaced by the newer */
+    uint32_t    overflows;      /* Executed in the caller thread, queue was full */
+    uint32_t    max_pending;
+    uint32_t    bus_avg;        /* us, command execution */
+    uint32_t    bus_max;
+    uint32_t    wait_avg;       /* us, from the first put to execution */
+    uint32_t    wait_max;
+} ctlq_stats_t;
+
+/**
+ * Commands are executed between lock() and unlock(), both could be NULL
+ */
+ctlq_t * ctlq_create(uint32_t size, void (*lock)(void), void (*unlock)(void));
+
+/**
+ * Execute pending commands and stop the thread
+ */
+void ctlq_destroy(ctlq_t *q);
+
+/**
+ * Start the thread. Commands put before are kept
+ */
+bool ctlq_start(ctlq_t *q);
+
+void ctlq_put(ctlq_t *q, const ctlq_cmd_t *cmd);
+
+/**
+ * Wait until all queued commands are executed. Not from a command
+ */
+void ctlq_flush(ctlq_t *q);
+
+/**
+ * Stats since the last call
+ */
+void ctlq_stats(ctlq_t *q, ctlq_stats_t *stats);
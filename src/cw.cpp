@@ -9,10 +9,13 @@
 
 
 #include <math.h>
+#include <stdio.h>
+#include <string.h>
 
 #include "util.h"
 #include "cfg/cfg.h"
 #include "cfg/subjects.h"
+#include "skimmer/skimmer.h"
 
 extern "C" {
     #include "lvgl/lvgl.h"
@@ -36,6 +39,13 @@ typedef struct {
 #define FFT 128
 #define MAX_CW_BW 500
 
+#define SKIMMER_CHANNELS    512     /* 86 Hz wide, fits 30 WPM keying */
+#define SKIMMER_FROM        150
+#define SKIMMER_TO          3000
+#define SKIMMER_DECODERS    16
+#define SKIMMER_LINES       4       /* Of the panel */
+#define SKIMMER_REFRESH     1000    /* ms of the audio */
+
 static bool ready = false;
 
 static fft_item_t fft_items[FFT];
@@ -61,6 +71,10 @@ static float rms_db_max;
 static float rms_db_min;
 static bool  peak_on = false;
 
+static cw_decoder_t *decoder;
+static skimmer_t    *skimmer;
+static uint32_t     skimmer_samples = 0;
+
 static int32_t key_tone = 0;
 static float   cw_decoder_peak_beta;
 static float   cw_decoder_noise_beta;
@@ -68,6 +82,7 @@ static float   cw_decoder_snr;
 static float   cw_decoder_snr_gist;
 static bool    cw_decoder;
 static bool    cw_tune;
+static bool    cw_skimmer;
 
 static pthread_mutex_t  cw_mutex = PTHREAD_MUTEX_INITIALIZER;
 
@@ -77,6 +92,10 @@ static void on_key_tone_change(Subject *subj, void *user_data);
 static void on_val_float_change(Subject *subj, void *user_data);
 static void on_val_bool_change(Subject *subj, void *user_data);
 
+static void decoder_text_cb(const char *text, void *user_data) {
+    panel_add_text(text);
+}
+
 void cw_init() {
     cfg.key_tone.val->subscribe(on_key_tone_change)->notify();
     cfg.cw_decoder_peak_beta.val->subscribe(on_val_float_change, (void*)&cw_decoder_peak_beta)->notify();
@@ -85,6 +104,10 @@ void cw_init() {
     cfg.cw_decoder_snr_gist.val->subscribe(on_val_float_change, (void*)&cw_decoder_snr_gist)->notify();
     cfg.cw_decoder.val->subscribe(on_val_bool_change, (void*)&cw_decoder)->notify();
     cfg.cw_tune.val->subscribe(on_val_bool_change, (void*)&cw_tune)->notify();
+    cfg.cw_skimmer.val->subscribe(on_val_bool_change, (void*)&cw_skimmer)->notify();
+
+    decoder = cw_decoder_create(decoder_text_cb, NULL);
+    skimmer = skimmer_create(AUDIO_CAPTURE_RATE, SKIMMER_CHANNELS, SKIMMER_FROM, SKIMMER_TO, SKIMMER_DECODERS);
 
     input_cbuf = cbuffercf_create(10000);
     wrms = wrms_create(16, 4);
@@ -203,6 +226,30 @@ static bool decode(float rms_db) {
     return peak_on;
 }
 
+static void skimmer_update(unsigned int n, cfloat *samples) {
+    skimmer_set_snr(skimmer, cw_decoder_snr, cw_decoder_snr_gist);
+    skimmer_put_audio_samples(skimmer, n, samples);
+
+    skimmer_samples += n;
+
+    if (skimmer_samples < AUDIO_CAPTURE_RATE * SKIMMER_REFRESH / 1000) {
+        return;
+    }
+    skimmer_samples = 0;
+
+    skimmer_item_t  items[SKIMMER_LINES];
+    size_t          count = skimmer_list(skimmer, items, SKIMMER_LINES);
+    char            text[SKIMMER_LINES * 64] = "";
+
+    for (size_t i = 0; i < count; i++) {
+        size_t len = strlen(text);
+
+        snprintf(text + len, sizeof(text) - len, "%s%4u Hz %2u WPM %s", i ? "\n" : "",
+                 items[i].freq, items[i].wpm, items[i].call[0] ? items[i].call : items[i].text);
+    }
+    panel_set_text(text);
+}
+
 
 void cw_put_audio_samples(unsigned int n, cfloat *samples) {
     if (!ready) {
@@ -211,6 +258,13 @@ void cw_put_audio_samples(unsigned int n, cfloat *samples) {
     if ((!cw_decoder) && (!cw_tune)) {
         return;
     }
+    if (cw_decoder && cw_skimmer) {
+        skimmer_update(n, samples);
+
+        if (!cw_tune) {
+            return;
+        }
+    }
     cfloat sample;
     float rms_db, peak_freq;
     size_t max_pos;
@@ -260,7 +314,11 @@ void cw_put_audio_samples(unsigned int n, cfloat *samples) {
                 rms_db_max = LV_MAX(rms_db_max, rms_db);
                 wdelayf_push(rms_delay, rms_db);
                 wdelayf_read(rms_delay, &rms_db);
-                cw_decoder_signal(decode(rms_db), 1000.0f / AUDIO_CAPTURE_RATE * DECIM_FACTOR * wrms_delay(wrms));
+                bool on = decode(rms_db);
+
+                if (cw_decoder && !cw_skimmer) {
+                    cw_decoder_signal(decoder, on, 1000.0f / AUDIO_CAPTURE_RATE * DECIM_FACTOR * wrms_delay(wrms));
+                }
             }
         }
     }
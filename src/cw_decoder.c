@@ -9,48 +9,53 @@
 /* Based on idea Michael A. Maynard, a.k.a. "K4ICY" */
 
 #include <math.h>
-#include "lvgl/lvgl.h"
+#include <stdlib.h>
+#include <string.h>
 #include "cw_decoder.h"
-#include "panel.h"
 
 #define HIST_SIZE       10
 
-static uint32_t debounce_factor = 15;
-static uint32_t thr_mean = 139;
+struct cw_decoder_s {
+    cw_decoder_text_cb_t    text_cb;
+    void                    *user_data;
 
-static uint32_t time_track = 0;
+    uint32_t    debounce_factor;
+    uint32_t    thr_mean;
 
-static int32_t  key_line_event_prev = 0;
-static int32_t  key_line_event_new = 0;
-static uint32_t key_line_ref = 0;
+    float       time_carry; /* Fraction of ms, not counted in time_track yet */
+    uint32_t    time_track; /* ms, wraps around, only differences are used */
 
-static uint32_t event_hist_index = 0;
-static uint32_t short_event_hist[HIST_SIZE];
-static uint32_t long_event_hist[HIST_SIZE];
-static uint32_t space_event_hist[HIST_SIZE];
+    int32_t     key_line_event_prev;
+    int32_t     key_line_event_new;
+    uint32_t    key_line_ref;
 
-static uint64_t long_event_avr = 0;
-static uint64_t short_event_avr = 0;
-static uint64_t space_event_avr = 0;
+    uint32_t    event_hist_index;
+    uint32_t    short_event_hist[HIST_SIZE];
+    uint32_t    long_event_hist[HIST_SIZE];
+    uint32_t    space_event_hist[HIST_SIZE];
 
-static uint16_t wpm_old;
-static uint32_t wpm;
+    uint64_t    long_event_avr;
+    uint64_t    short_event_avr;
+    uint64_t    space_event_avr;
 
-static uint32_t space_duration = 0;
-static uint32_t space_duration_prev = 0;
-static uint32_t space_duration_ref;
+    uint32_t    wpm;
 
-static uint32_t word_space_duration = 0;
-static uint32_t word_space_duration_ref = 0;
-static float    word_space_timing = 3.0f;
+    uint32_t    space_duration;
+    uint32_t    space_duration_prev;
+    uint32_t    space_duration_ref;
 
-static bool     key_line = false;
+    uint32_t    word_space_duration;
+    uint32_t    word_space_duration_ref;
+    float       word_space_timing;
 
-static float    compare_factor = 2.0;
+    bool        key_line;
 
-static bool     character_step = false;
-static bool     word_step = false;
-static char     elements[128];
+    float       compare_factor;
+
+    bool        character_step;
+    bool        word_step;
+    char        elements[128];
+};
 
 cw_characters_t cw_characters[] = {
     { .morse = ".-",        .character = "A" },
@@ -124,181 +129,215 @@ cw_characters_t cw_characters[] = {
     { .morse = NULL }
 };
 
-void cw_decoder_init() {
+cw_decoder_t * cw_decoder_create(cw_decoder_text_cb_t text_cb, void *user_data) {
+    cw_decoder_t *dec = malloc(sizeof(cw_decoder_t));
+
+    dec->text_cb = text_cb;
+    dec->user_data = user_data;
+    cw_decoder_reset(dec);
+
+    return dec;
+}
+
+void cw_decoder_destroy(cw_decoder_t *dec) {
+    free(dec);
+}
+
+void cw_decoder_reset(cw_decoder_t *dec) {
+    cw_decoder_text_cb_t    text_cb = dec->text_cb;
+    void                    *user_data = dec->user_data;
+
+    memset(dec, 0, sizeof(cw_decoder_t));
+
+    dec->text_cb = text_cb;
+    dec->user_data = user_data;
+    dec->debounce_factor = 15;
+    dec->thr_mean = 139;
+    dec->word_space_timing = 3.0f;
+    dec->compare_factor = 2.0f;
 }
 
-static void cw_decoder_ans(const char *ans) {
-    panel_add_text(ans);
+uint16_t cw_decoder_wpm(cw_decoder_t *dec) {
+    return dec->wpm;
 }
 
-static void cw_decoder_wpm(uint16_t wpm) {
+static void cw_decoder_ans(cw_decoder_t *dec, const char *ans) {
+    dec->text_cb(ans, dec->user_data);
 }
 
-static void cw_decoder_dict() {
+static void cw_decoder_dict(cw_decoder_t *dec) {
     cw_characters_t *character = &cw_characters[0];
 
     while (character->morse) {
-        if (strcmp(elements, character->morse) == 0) {
-            cw_decoder_ans(character->character);
+        if (strcmp(dec->elements, character->morse) == 0) {
+            cw_decoder_ans(dec, character->character);
             return;
         }
 
         character++;
     }
 
-    cw_decoder_ans("<?>");
+    cw_decoder_ans(dec, "<?>");
 }
 
-static void cw_decoder_calc_wpm() {
-    wpm_old = wpm;
-    wpm = (6000 * 1.06) / (long_event_avr + short_event_avr + space_event_avr);
-
-    if (wpm != wpm_old) {
-        cw_decoder_wpm(wpm);
-    }
+static void cw_decoder_calc_wpm(cw_decoder_t *dec) {
+    dec->wpm = (6000 * 1.06) / (dec->long_event_avr + dec->short_event_avr + dec->space_event_avr);
 }
 
-static void cw_decoder_dot_dash(uint16_t short_event, uint16_t long_event) {
+static void cw_decoder_dot_dash(cw_decoder_t *dec, uint16_t short_event, uint16_t long_event) {
+    uint32_t i = dec->event_hist_index;
+
     /* Find out which one is the Dot and which is the Dash and roll them into a moving average of each */
 
-    long_event_hist[event_hist_index] = long_event;
-    short_event_hist[event_hist_index] = short_event;
+    dec->long_event_hist[i] = long_event;
+    dec->short_event_hist[i] = short_event;
 
     /* Keep a moving average of the intra-element space duration */
 
-    space_event_hist[event_hist_index] = space_duration_prev;
+    dec->space_event_hist[i] = dec->space_duration_prev;
 
     /* Keep a moving averages */
 
-    long_event_avr = 0;
-    short_event_avr = 0;
-    space_event_avr = 0;
+    dec->long_event_avr = 0;
+    dec->short_event_avr = 0;
+    dec->space_event_avr = 0;
 
-    for (uint8_t i = 0; i < HIST_SIZE; i++) {
-        long_event_avr += long_event_hist[i];
-        short_event_avr += short_event_hist[i];
-        space_event_avr += space_event_hist[i];
+    for (uint8_t n = 0; n < HIST_SIZE; n++) {
+        dec->long_event_avr += dec->long_event_hist[n];
+        dec->short_event_avr += dec->short_event_hist[n];
+        dec->space_event_avr += dec->space_event_hist[n];
     }
 
-    long_event_avr /= HIST_SIZE;
-    short_event_avr /= HIST_SIZE;
-    space_event_avr /= HIST_SIZE;
+    dec->long_event_avr /= HIST_SIZE;
+    dec->short_event_avr /= HIST_SIZE;
+    dec->space_event_avr /= HIST_SIZE;
 
     /* Find threshold mean */
 
-    thr_mean = sqrt(short_event_avr * long_event_avr);
+    dec->thr_mean = sqrt(dec->short_event_avr * dec->long_event_avr);
 
     /* Bootstrap threshold values - - - If any are below or above known Dot/Dash pair ranges then move them instantly */
 
-    if (thr_mean < short_event_hist[event_hist_index] || thr_mean > long_event_hist[event_hist_index]) {
-        thr_mean = sqrt(short_event_hist[event_hist_index] * long_event_hist[event_hist_index]);
+    if (dec->thr_mean < dec->short_event_hist[i] || dec->thr_mean > dec->long_event_hist[i]) {
+        dec->thr_mean = sqrt(dec->short_event_hist[i] * dec->long_event_hist[i]);
 
-        long_event_avr = long_event_hist[event_hist_index];
-        short_event_avr = short_event_hist[event_hist_index];
+        dec->long_event_avr = dec->long_event_hist[i];
+        dec->short_event_avr = dec->short_event_hist[i];
 
-        for (uint8_t i = 0; i < HIST_SIZE; i++) {
-            long_event_hist[i] = long_event_avr;
-            short_event_hist[i] = short_event_avr;
+        for (uint8_t n = 0; n < HIST_SIZE; n++) {
+            dec->long_event_hist[n] = dec->long_event_avr;
+            dec->short_event_hist[n] = dec->short_event_avr;
         }
     }
 
-    event_hist_index++;
+    dec->event_hist_index++;
 
-    if (event_hist_index > HIST_SIZE - 1)
-        event_hist_index = 0;
+    if (dec->event_hist_index > HIST_SIZE - 1)
+        dec->event_hist_index = 0;
 
-    cw_decoder_calc_wpm();
+    cw_decoder_calc_wpm(dec);
 }
 
 
-static void cw_decoder_inner_space() {
-    space_duration_prev = space_duration;
-    space_duration = time_track - space_duration_ref;
+static void cw_decoder_inner_space(cw_decoder_t *dec) {
+    dec->space_duration_prev = dec->space_duration;
+    dec->space_duration = dec->time_track - dec->space_duration_ref;
 
     /* DECODE collected string of elements */
 
     /* check to see if inter-element space duration threshold has been exceeded - then decode   */
     /* it is assumed that the intra-space is longer than a Dot but shorter than a Dash          */
 
-    if (space_duration >= thr_mean) {
-        space_duration_ref = time_track;
+    if (dec->space_duration >= dec->thr_mean) {
+        dec->space_duration_ref = dec->time_track;
 
-        if (character_step) {
-            cw_decoder_dict();
-            strcpy(elements, "");
+        if (dec->character_step) {
+            cw_decoder_dict(dec);
+            strcpy(dec->elements, "");
 
-            character_step = false;
+            dec->character_step = false;
         }
     }
 }
 
-static void cw_decoder_word_space() {
-    word_space_duration = time_track - word_space_duration_ref;
+static void cw_decoder_word_space(cw_decoder_t *dec) {
+    dec->word_space_duration = dec->time_track - dec->word_space_duration_ref;
 
-    if (word_space_duration >= thr_mean * word_space_timing) {
-        word_space_duration_ref = time_track;
+    if (dec->word_space_duration >= dec->thr_mean * dec->word_space_timing) {
+        dec->word_space_duration_ref = dec->time_track;
 
-        if (word_step) {
-            cw_decoder_ans(" ");
-            word_step = false;
+        if (dec->word_step) {
+            cw_decoder_ans(dec, " ");
+            dec->word_step = false;
         }
     }
 }
 
-void cw_decoder_signal(bool on, float ms) {
-    time_track += (ms + 0.5f);
+void cw_decoder_signal(cw_decoder_t *dec, bool on, float ms) {
+    /* Fractions of ms are kept, channel rates are not multiple of 1 ms */
+
+    dec->time_carry += ms;
+
+    uint32_t whole = dec->time_carry;
+
+    dec->time_track += whole;
+    dec->time_carry -= whole;
 
     /* Key down */
 
     if (on) {
-        if (!key_line) {
-            key_line_ref = time_track;
-            word_space_duration_ref = time_track;
+        if (!dec->key_line) {
+            dec->key_line_ref = dec->time_track;
+            dec->word_space_duration_ref = dec->time_track;
 
-            key_line = true;
+            dec->key_line = true;
         }
     }
 
     /* Key up */
 
     if (!on) {
-        if (time_track - key_line_ref < debounce_factor) {
-            key_line = false;
+        if (dec->time_track - dec->key_line_ref < dec->debounce_factor) {
+            dec->key_line = false;
             return;
         }
 
-        if (key_line) {
-            key_line = false;
-            key_line_event_prev = key_line_event_new;
-            key_line_event_new = time_track - key_line_ref;
+        if (dec->key_line) {
+            dec->key_line = false;
+            dec->key_line_event_prev = dec->key_line_event_new;
+            dec->key_line_event_new = dec->time_track - dec->key_line_ref;
+
+            int32_t prev = dec->key_line_event_prev;
+            int32_t cur = dec->key_line_event_new;
 
             /* If the Current Duration Event Compared to the Previous Event appears to be a Dot / Dash pair [ roughly (>2):1 ] */
+            /* The first event has no pair, zero would make the threshold mean zero */
 
-            if (key_line_event_new >= key_line_event_prev * compare_factor && space_duration_prev <= key_line_event_prev * compare_factor) {
-                cw_decoder_dot_dash(key_line_event_new, key_line_event_prev);
-            } else if (key_line_event_prev >= key_line_event_new * compare_factor && space_duration_prev <= key_line_event_new * compare_factor) {
-                cw_decoder_dot_dash(key_line_event_prev, key_line_event_new);
+            if (prev > 0 && cur >= prev * dec->compare_factor && dec->space_duration_prev <= prev * dec->compare_factor) {
+                cw_decoder_dot_dash(dec, cur, prev);
+            } else if (prev > 0 && prev >= cur * dec->compare_factor && dec->space_duration_prev <= cur * dec->compare_factor) {
+                cw_decoder_dot_dash(dec, prev, cur);
             }
 
             /* Reset space durations */
 
-            space_duration_ref = time_track;
-            word_space_duration_ref = time_track;
+            dec->space_duration_ref = dec->time_track;
+            dec->word_space_duration_ref = dec->time_track;
 
             /* Classify and add most likely Dots or Dashes to a string for eventual character decoding */
 
-            if (key_line_event_new <= thr_mean) {
-                strcat(elements, ".");
-            } else {
-                strcat(elements, "-");
+            size_t len = strlen(dec->elements);
+
+            if (len < sizeof(dec->elements) - 1) {
+                dec->elements[len] = (cur <= dec->thr_mean) ? '.' : '-';
+                dec->elements[len + 1] = '\0';
             }
 
-            character_step = true;
-            word_step = true;
+            dec->character_step = true;
+            dec->word_step = true;
         }
 
-        cw_decoder_inner_space();
-        cw_decoder_word_space();
+        cw_decoder_inner_space(dec);
+        cw_decoder_word_space(dec);
     }
 }
-
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef struct {
     char    *morse;
@@ -17,5 +18,26 @@ typedef struct {
 
 extern cw_characters_t cw_characters[];
 
-void cw_decoder_init();
-void cw_decoder_signal(bool on, float ms);
+/*
+ * Timing decoder of the key line. Every instance has own state, so one could
+ * run per signal. Decoded characters and word spaces are passed to text_cb
+ */
+
+typedef struct cw_decoder_s cw_decoder_t;
+
+typedef void (*cw_decoder_text_cb_t)(const char *text, void *user_data);
+
+cw_decoder_t * cw_decoder_create(cw_decoder_text_cb_t text_cb, void *user_data);
+void cw_decoder_destroy(cw_decoder_t *dec);
+
+/**
+ * Forget the timings of the previous signal
+ */
+void cw_decoder_reset(cw_decoder_t *dec);
+
+/**
+ * Key line state for the last ms
+ */
+void cw_decoder_signal(cw_decoder_t *dec, bool on, float ms);
+
+uint16_t cw_decoder_wpm(cw_decoder_t *dec);
@@ -9,6 +9,7 @@
 
 #include "audio.h"
 #include "recorder.h"
+#include "iq_rec.h"
 #include "dialog.h"
 #include "styles.h"
 #include "params/params.h"
@@ -36,6 +37,7 @@
 #define LEVEL_HEIGHT 25
 
 #define LEVEL_UPDATE_MS 100
+#define IQ_PLAY_POLL    100000  /* us */
 
 static lv_obj_t             *table;
 static lv_obj_t             *level;
@@ -163,6 +165,37 @@ static const char* get_item() {
     return lv_table_get_cell_value(table, row, col);
 }
 
+static bool is_iq_item(const char *item) {
+    const char *ext = item ? strrchr(item, '.') : NULL;
+
+    return ext && strcmp(ext + 1, IQ_REC_EXT) == 0;
+}
+
+/* IQ goes to spectrum and waterfall instead of the flow, audio is not affected */
+static void play_iq_item() {
+    char filename[64];
+
+    snprintf(filename, sizeof(filename), "%s/%s", recorder_path, get_item());
+
+    if (recorder_is_on()) {
+        recorder_set_on(false);
+    }
+
+    if (!iq_rec_replay_start(filename, true)) {
+        msg_update_text_fmt("Wrong IQ file");
+        return;
+    }
+
+    play_state = true;
+
+    while (play_state && iq_rec_replay_is_on()) {
+        usleep(IQ_PLAY_POLL);
+    }
+
+    iq_rec_replay_stop();
+    play_state = false;
+}
+
 static void play_item() {
     const char *item = get_item();
 
@@ -210,9 +243,13 @@ static void * play_thread(void *arg) {
     pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
     pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, NULL);
 
-    audio_play_en(true);
-    play_item();
-    audio_play_en(false);
+    if (is_iq_item(get_item())) {
+        play_iq_item();
+    } else {
+        audio_play_en(true);
+        play_item();
+        audio_play_en(false);
+    }
 
     if (dialog.run) {
         scheduler_put_noargs(load_btn_page);
@@ -1729,6 +1729,24 @@ static uint8_t make_freq_accel(uint8_t row) {
     return row + 1;
 }
 
+static uint8_t make_rec_format(uint8_t row) {
+    lv_obj_t    *obj;
+    uint8_t     col = 0;
+
+    obj = lv_label_create(grid);
+
+    lv_label_set_text(obj, "Recorder format");
+    lv_obj_set_grid_cell(obj, LV_GRID_ALIGN_START, col++, 1, LV_GRID_ALIGN_CENTER, row, 1);
+
+    obj = dropdown_uint8(grid, &params.rec_format, " MP3 \n WAV \n FLAC \n IQ");
+
+    lv_obj_set_size(obj, SMALL_6, 56);
+    lv_obj_set_grid_cell(obj, LV_GRID_ALIGN_START, 1, 6, LV_GRID_ALIGN_CENTER, row, 1);
+    lv_obj_center(obj);
+
+    return row + 1;
+}
+
 static uint8_t make_theme(uint8_t row) {
     lv_obj_t    *obj;
     uint8_t     col = 0;
@@ -1796,6 +1814,7 @@ static void make_general_page() {
     row = make_delimiter(row);
 
     row = make_audio_gain(row);
+    row = make_rec_format(row);
     row = make_delimiter(row);
 
     row = make_sp_mode(row);
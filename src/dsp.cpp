@@ -12,6 +12,8 @@
 #include "util.h"
 #include "buttons.h"
 #include "cfg/subjects.h"
+#include "simd/simd.h"
+#include "ring/spsc.h"
 
 #include <algorithm>
 #include <numeric>
@@ -21,6 +23,7 @@ extern "C" {
     #include "cfg/cfg.h"
     #include "dialog_msg_voice.h"
     #include "meter.h"
+    #include "msg.h"
     #include "radio.h"
     #include "recorder.h"
     #include "rtty.h"
@@ -29,11 +32,22 @@ extern "C" {
 
     #include <math.h>
     #include <pthread.h>
+    #include <semaphore.h>
     #include <stdlib.h>
+    #include <string.h>
 }
 
 #define DB_OFFSET -30.0f
 
+#define AUDIO_CHUNK_SAMPLES 1024
+#define AUDIO_RING_SIZE     64          /* Full chunks, 1.49 s at AUDIO_CAPTURE_RATE */
+#define AUDIO_STATS_PERIOD  10000       /* ms */
+
+typedef struct {
+    uint16_t    n;
+    int16_t     samples[AUDIO_CHUNK_SAMPLES];
+} audio_chunk_t;
+
 static iirfilt_cccf dc_block;
 
 static pthread_mutex_t spectrum_mux = PTHREAD_MUTEX_INITIALIZER;
@@ -65,7 +79,14 @@ static uint8_t  psd_delay;
 static uint8_t  min_max_delay;
 
 static firhilbf audio_hilb;
-static cfloat  *audio;
+static cfloat   audio[AUDIO_CHUNK_SAMPLES];
+
+/* Audio is decoded by own thread, PulseAudio callback only copies it to the ring */
+static spsc_ring_t  *audio_ring;
+static sem_t        audio_sem;
+static pthread_t    audio_thread;
+static uint64_t     audio_stats_time;
+static audio_chunk_t *audio_fill = NULL;   /* Chunk being filled by the callback */
 
 static bool ready = false;
 
@@ -81,6 +102,7 @@ static void on_real_filter_from_change(Subject *subj, void *user_data);
 static void on_real_filter_to_change(Subject *subj, void *user_data);
 static void update_cur_mode(Subject *subj, void *user_data);
 static void on_cur_freq_change(Subject *subj, void *user_data);
+static void * audio_thread_fn(void *arg);
 
 
 /* Chunked spectrum periodogram class */
@@ -88,6 +110,7 @@ static void on_cur_freq_change(Subject *subj, void *user_data);
 ChunkedSpgram::ChunkedSpgram(size_t chunk_size, size_t nfft, size_t buffer_size) {
     this->chunk_size = chunk_size;
     this->nfft = nfft;
+    this->psd_size = nfft;
     if (buffer_size > 0) {
         this->buffer_size = buffer_size;
     } else {
@@ -117,14 +140,60 @@ ChunkedSpgram::ChunkedSpgram(size_t chunk_size, size_t nfft, size_t buffer_size)
 
 }
 
+/**
+ * Periodogram without own FFT, fed by the source one. PSD of source is resampled to nfft bins
+ * (same bandwidth) with linear interpolation and scaled to the noise level of own chunked FFT
+ */
+ChunkedSpgram::ChunkedSpgram(ChunkedSpgram *source, size_t nfft) {
+    this->source = source;
+    this->nfft = nfft;
+    this->chunk_size = source->chunk_size;
+    this->buffer_size = source->buffer_size;
+    this->psd_size = source->nfft;
+    this->psd = (float *) calloc(sizeof(float), psd_size);
+    this->map_buf = (float *) calloc(sizeof(float), psd_size);
+    this->map_idx = (uint16_t *) calloc(sizeof(uint16_t), nfft);
+    this->map_frac = (float *) calloc(sizeof(float), nfft);
+
+    // noise power per bin is buffer_size / nfft for source and chunk_size / nfft for own FFT
+    this->map_scale = ((float) chunk_size / nfft) / ((float) buffer_size / psd_size);
+
+    for (size_t i = 0; i < nfft; i++) {
+        float    pos = (float) i * psd_size / nfft;
+        uint16_t idx = (uint16_t) pos;
+
+        if (idx >= psd_size - 1) {
+            idx = psd_size - 2;
+        }
+        map_idx[i] = idx;
+        map_frac[i] = pos - idx;
+    }
+
+    source->follower = this;
+}
+
 ChunkedSpgram::~ChunkedSpgram() {
+    if (source) {
+        source->follower = NULL;
+    }
+    if (follower) {
+        follower->source = NULL;
+    }
+
     free(this->buf_time);
     free(this->buf_freq);
     free(this->psd);
     free(this->w);
+    free(this->map_buf);
+    free(this->map_idx);
+    free(this->map_frac);
 
-    windowcf_destroy(buffer);
-    fft_destroy_plan(fft);
+    if (buffer) {
+        windowcf_destroy(buffer);
+    }
+    if (fft) {
+        fft_destroy_plan(fft);
+    }
 }
 
 void ChunkedSpgram::set_alpha(float val) {
@@ -149,15 +218,21 @@ void ChunkedSpgram::set_alpha(float val) {
 void ChunkedSpgram::clear() {
     num_transforms = 0;
     num_samples = 0;
-    for (size_t i = 0; i < nfft; i++) {
+    for (size_t i = 0; i < psd_size; i++) {
         psd[i] = 0.0f;
-        buf_time[i] = 0.0f;
+    }
+    if (buf_time) {
+        for (size_t i = 0; i < nfft; i++) {
+            buf_time[i] = 0.0f;
+        }
     }
 }
 
 void ChunkedSpgram::reset() {
     clear();
-    windowcf_reset(buffer);
+    if (buffer) {
+        windowcf_reset(buffer);
+    }
 }
 
 void ChunkedSpgram::execute_block(cfloat *chunk) {
@@ -173,26 +248,37 @@ void ChunkedSpgram::execute_block(cfloat *chunk) {
     memcpy(buf_time, rc, sizeof(cfloat) * buffer_size);
     fft_execute(fft);
 
-    // accumulate output
-    // TODO: vectorize this operation
-    for (size_t i=0; i<nfft; i++) {
-        float v = std::norm(buf_freq[i]);
-        if (num_transforms == 0)
-            psd[i] = v;
-        else
-            psd[i] = gamma*psd[i] + alpha*v;
+    accumulate_freq(buf_freq);
+
+    if (follower) {
+        follower->accumulate_freq(buf_freq);
     }
+}
+
+void ChunkedSpgram::accumulate_freq(const cfloat *freq) {
+    // accumulate output
+    if (num_transforms == 0)
+        simd_power_cf((const float *)freq, psd, psd_size);
+    else
+        simd_power_ema_cf((const float *)freq, psd, gamma, alpha, psd_size);
     num_transforms++;
 }
 
 void ChunkedSpgram::get_psd_mag(float *psd) {
     // compute magnitude (linear) and run FFT shift
-    unsigned int i;
-    unsigned int nfft_2 = nfft / 2;
     float scale = accumulate ? 1.0f / std::max((size_t)1, num_transforms) : 1.0f;
-    for (i=0; i<nfft; i++) {
-        unsigned int k = (i + nfft_2) % nfft;
-        psd[i] = std::max((float)LIQUID_SPGRAM_PSD_MIN, this->psd[k]) * scale;
+
+    if (map_idx) {
+        simd_fftshift_clamp(this->psd, map_buf, LIQUID_SPGRAM_PSD_MIN, scale * map_scale, psd_size);
+
+        for (size_t i = 0; i < nfft; i++) {
+            float a = map_buf[map_idx[i]];
+            float b = map_buf[map_idx[i] + 1];
+
+            psd[i] = a + (b - a) * map_frac[i];
+        }
+    } else {
+        simd_fftshift_clamp(this->psd, psd, LIQUID_SPGRAM_PSD_MIN, scale, nfft);
     }
     if (accumulate) {
         clear();
@@ -203,12 +289,8 @@ void ChunkedSpgram::get_psd(float *psd, bool linear) {
     // compute magnitude, linear
     get_psd_mag(psd);
     if (!linear) {
-        // convert to dB
-        unsigned int i;
-        for (i=0; i<nfft; i++) {
-            // 10.0 because psd is squared magnitude (power)
-            psd[i] = 10.0f * log10f(psd[i]);
-        }
+        // convert to dB, 10.0 because psd is squared magnitude (power)
+        simd_power_to_db(psd, psd, 0.0f, nfft);
     }
 }
 
@@ -217,20 +299,23 @@ void ChunkedSpgram::get_psd(float *psd, bool linear) {
 void dsp_init() {
     dc_block = iirfilt_cccf_create_dc_blocker(0.005f);
 
-    setup_spectrum_spgram();
-
     waterfall_sg_rx = new ChunkedSpgram(RADIO_SAMPLES, WATERFALL_NFFT);
     waterfall_sg_rx->set_alpha(0.8f);
     waterfall_sg_tx = new ChunkedSpgram(RADIO_SAMPLES, WATERFALL_NFFT);
     waterfall_sg_tx->set_alpha(0.8f);
 
+    setup_spectrum_spgram();
+
     spectrum_time  = get_time();
     waterfall_time = get_time();
 
     psd_delay = 4;
 
-    audio      = (cfloat *)malloc(AUDIO_CAPTURE_RATE * sizeof(cfloat));
     audio_hilb = firhilbf_create(7, 60.0f);
+    audio_ring = spsc_ring_create(sizeof(audio_chunk_t), AUDIO_RING_SIZE);
+    audio_stats_time = get_time();
+    sem_init(&audio_sem, 0, 0);
+    pthread_create(&audio_thread, NULL, audio_thread_fn, NULL);
 
     subject_add_observer_and_call(cfg_cur.zoom, on_zoom_change, NULL);
     subject_add_observer_and_call(cfg_cur.filter.real.from, on_real_filter_from_change, NULL);
@@ -262,10 +347,9 @@ static void process_samples(cfloat *buf_samples, uint16_t size, firdecim_crcf sp
     if (spectrum_factor > 1) {
         firdecim_crcf_execute_block(sp_decim, buf_filtered, size / spectrum_factor, spectrum_dec_buf);
         sp_sg->execute_block(spectrum_dec_buf);
-    } else {
-        sp_sg->execute_block(buf_filtered);
     }
 
+    // At zoom 1 spectrum is fed by waterfall FFT
     wf_sg->execute_block(buf_filtered);
 }
 
@@ -286,11 +370,7 @@ static bool update_spectrum(ChunkedSpgram *sp_sg, uint64_t now, bool tx) {
 static bool update_waterfall(ChunkedSpgram *wf_sg, uint64_t now, bool tx) {
     if ((now - waterfall_time > waterfall_fps_ms) && (!psd_delay)) {
         wf_sg->get_psd(waterfall_psd_lin, true);
-        for (size_t i = 0; i < WATERFALL_NFFT; i++) {
-            waterfall_psd[i] = 10.0f * log10f(waterfall_psd_lin[i]);
-        }
-
-        liquid_vectorf_addscalar(waterfall_psd, WATERFALL_NFFT, DB_OFFSET, waterfall_psd);
+        simd_power_to_db(waterfall_psd_lin, waterfall_psd, DB_OFFSET, WATERFALL_NFFT);
         waterfall_data(waterfall_psd, WATERFALL_NFFT, tx);
         waterfall_time = now;
         return true;
@@ -414,20 +494,12 @@ void dsp_set_spectrum_beta(float x) {
     spectrum_beta = x;
 }
 
-void dsp_put_audio_samples(size_t nsamples, int16_t *samples) {
-    if (!ready) {
-        return;
-    }
-
+static void audio_samples(size_t nsamples, int16_t *samples) {
     if (dialog_msg_voice_get_state() == MSG_VOICE_RECORD) {
         dialog_msg_voice_put_audio_samples(nsamples, samples);
         return;
     }
 
-    if (recorder_is_on()) {
-        recorder_put_audio_samples(nsamples, samples);
-    }
-
     for (uint16_t i = 0; i < nsamples; i++)
         firhilbf_r2c_execute(audio_hilb, samples[i] / 32768.0f, &audio[i]);
 
@@ -440,6 +512,86 @@ void dsp_put_audio_samples(size_t nsamples, int16_t *samples) {
     }
 }
 
+static void audio_stats() {
+    uint64_t now = get_time();
+
+    if (now - audio_stats_time < AUDIO_STATS_PERIOD) {
+        return;
+    }
+
+    uint32_t overruns, max_count;
+
+    spsc_ring_stats(audio_ring, &overruns, &max_count);
+    audio_stats_time = now;
+
+    LV_LOG_USER("Audio ring: max fill %u/%u, overruns %u", max_count, spsc_ring_capacity(audio_ring), overruns);
+
+    if (overruns) {
+        msg_update_text_fmt("Audio decoders are late, audio lost %u times", overruns);
+    }
+}
+
+static void * audio_thread_fn(void *arg) {
+    while (true) {
+        sem_wait(&audio_sem);
+
+        audio_chunk_t *chunk;
+
+        while ((chunk = (audio_chunk_t *) spsc_ring_read_begin(audio_ring)) != NULL) {
+            audio_samples(chunk->n, chunk->samples);
+            spsc_ring_read_end(audio_ring);
+        }
+        audio_stats();
+    }
+    return NULL;
+}
+
+void dsp_put_audio_samples(size_t nsamples, int16_t *samples) {
+    if (!ready) {
+        return;
+    }
+
+    if (recorder_is_on() && dialog_msg_voice_get_state() != MSG_VOICE_RECORD) {
+        recorder_put_audio_samples(nsamples, samples);
+    }
+
+    /* Callbacks are packed to full chunks, so the ring holds AUDIO_RING_SIZE * AUDIO_CHUNK_SAMPLES */
+
+    bool posted = false;
+
+    while (nsamples > 0) {
+        if (!audio_fill) {
+            audio_fill = (audio_chunk_t *) spsc_ring_write_begin(audio_ring);
+
+            if (!audio_fill) {
+                break;
+            }
+            audio_fill->n = 0;
+        }
+
+        size_t n = AUDIO_CHUNK_SAMPLES - audio_fill->n;
+
+        if (n > nsamples) {
+            n = nsamples;
+        }
+
+        memcpy(&audio_fill->samples[audio_fill->n], samples, n * sizeof(int16_t));
+        audio_fill->n += n;
+        samples += n;
+        nsamples -= n;
+
+        if (audio_fill->n == AUDIO_CHUNK_SAMPLES) {
+            spsc_ring_write_end(audio_ring);
+            audio_fill = NULL;
+            posted = true;
+        }
+    }
+
+    if (posted) {
+        sem_post(&audio_sem);
+    }
+}
+
 static void dsp_update_min_max(float *data_buf, uint16_t size) {
     if (min_max_delay) {
         min_max_delay--;
@@ -495,9 +647,14 @@ static void setup_spectrum_spgram() {
     if (spectrum_sg_tx) {
         delete spectrum_sg_tx;
     }
-    size_t chunk_size = RADIO_SAMPLES / spectrum_factor;
-    spectrum_sg_rx = new ChunkedSpgram(chunk_size, SPECTRUM_NFFT, chunk_size);
+    if (spectrum_factor > 1) {
+        size_t chunk_size = RADIO_SAMPLES / spectrum_factor;
+        spectrum_sg_rx = new ChunkedSpgram(chunk_size, SPECTRUM_NFFT, chunk_size);
+        spectrum_sg_tx = new ChunkedSpgram(chunk_size, SPECTRUM_NFFT, chunk_size);
+    } else {
+        spectrum_sg_rx = new ChunkedSpgram(waterfall_sg_rx, SPECTRUM_NFFT);
+        spectrum_sg_tx = new ChunkedSpgram(waterfall_sg_tx, SPECTRUM_NFFT);
+    }
     spectrum_sg_rx->set_alpha(0.4f);
-    spectrum_sg_tx = new ChunkedSpgram(chunk_size, SPECTRUM_NFFT, chunk_size);
     spectrum_sg_tx->set_alpha(0.4f);
 }
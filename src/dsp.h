@@ -35,11 +35,11 @@ class ChunkedSpgram {
     size_t   nfft;
     size_t   chunk_size;
     size_t   buffer_size;
-    windowcf buffer;
-    fftplan  fft;
-    cfloat  *buf_time;
-    cfloat  *buf_freq;
-    cfloat  *w;
+    windowcf buffer         = NULL;
+    fftplan  fft            = NULL;
+    cfloat  *buf_time       = NULL;
+    cfloat  *buf_freq       = NULL;
+    cfloat  *w              = NULL;
     float   *psd;
     bool     accumulate     = true;
     float    alpha          = 1.0f;
@@ -47,8 +47,20 @@ class ChunkedSpgram {
     size_t   num_transforms = 0;
     size_t   num_samples    = 0;
 
+    /* Shared FFT: follower accumulates FFT of source and resamples PSD to own nfft */
+    ChunkedSpgram *source   = NULL;
+    ChunkedSpgram *follower = NULL;
+    size_t   psd_size;
+    uint16_t *map_idx       = NULL;
+    float   *map_frac       = NULL;
+    float   *map_buf        = NULL;
+    float    map_scale      = 1.0f;
+
+    void accumulate_freq(const cfloat *freq);
+
   public:
     ChunkedSpgram(size_t chunk_size, size_t nfft, size_t buffer_size=0);
+    ChunkedSpgram(ChunkedSpgram *source, size_t nfft);
     ~ChunkedSpgram();
     void set_alpha(float val);
     void clear();
@@ -68,6 +80,9 @@ void dsp_reset();
 float dsp_get_spectrum_beta();
 void dsp_set_spectrum_beta(float x);
 
+/**
+ * Audio from the PulseAudio callback. Samples are copied to the ring, decoders run in own thread
+ */
 void dsp_put_audio_samples(size_t nsamples, int16_t *samples);
 #ifdef __cplusplus
 }
@@ -10,26 +10,16 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <fcntl.h>
-#include <linux/input.h>
 
 #include "encoder.h"
 #include "keyboard.h"
 #include "backlight.h"
 
 static void encoder_input_read(lv_indev_drv_t *drv, lv_indev_data_t *data) {
-    struct input_event  in;
     encoder_t           *encoder = (encoder_t*) drv->user_data;
-    int32_t             diff = 0;
-    bool                send = false;
-
-    while (read(encoder->fd, &in, sizeof(struct input_event)) > 0) {
-        if (in.type == EV_REL) {
-            diff += in.value;
-            send = true;
-        }
-    }
+    int32_t             diff = input_take(encoder->input, NULL);
 
-    if (send) {
+    if (diff != 0) {
         backlight_tick();
     }
 
@@ -46,12 +36,13 @@ encoder_t * encoder_init(char *dev_name) {
         return NULL;
     }
 
-    fcntl(fd, F_SETFL, O_ASYNC | O_NONBLOCK);
+    fcntl(fd, F_SETFL, O_NONBLOCK);
 
     encoder_t *encoder = malloc(sizeof(encoder_t));
 
     memset(encoder, 0, sizeof(encoder_t));
     encoder->fd = fd;
+    encoder->input = input_add(fd);
 
     lv_indev_drv_init(&encoder->indev_drv);
 
@@ -11,9 +11,11 @@
 #include <stdint.h>
 #include "lvgl/lvgl.h"
 #include "events.h"
+#include "input.h"
 
 typedef struct {
     int             fd;
+    input_dev_t     *input;
     bool            pressed;
     
     lv_indev_drv_t  indev_drv;
@@ -7,12 +7,13 @@
  */
 
 #include <stdlib.h>
-#include <pthread.h>
+#include <string.h>
 #include "events.h"
 #include "backlight.h"
 #include "keyboard.h"
+#include "ring/mpsc.h"
 
-#define QUEUE_SIZE  64
+#define QUEUE_SIZE  128
 
 uint32_t        EVENT_ROTARY;
 uint32_t        EVENT_KEYPAD;
@@ -28,13 +29,12 @@ uint32_t        EVENT_BAND_DOWN;
 typedef struct {
     lv_obj_t        *obj;
     lv_event_code_t event_code;
-    void            *param;
+    uint8_t         data_size;      /* Inline param, if not zero */
+    void            *param;         /* Allocated param */
+    uint8_t         data[EVENT_PARAM_INLINE] __attribute__((aligned(8)));
 } item_t;
 
-static item_t           *queue[QUEUE_SIZE];
-static uint8_t          queue_write = 0;
-static uint8_t          queue_read = 0;
-static pthread_mutex_t  queue_mux;
+static mpsc_ring_t      *queue;
 
 void event_init() {
     EVENT_ROTARY = lv_event_register_id();
@@ -48,63 +48,88 @@ void event_init() {
     EVENT_BAND_UP = lv_event_register_id();
     EVENT_BAND_DOWN = lv_event_register_id();
 
-    for (uint8_t i = 0; i < QUEUE_SIZE; i++)
-        queue[i] = NULL;
-
-    pthread_mutex_init(&queue_mux, NULL);
+    queue = mpsc_ring_create(sizeof(item_t), QUEUE_SIZE);
 }
 
 void event_obj_check() {
-    while (queue_read != queue_write) {
-        pthread_mutex_lock(&queue_mux);
-        queue_read = (queue_read + 1) % QUEUE_SIZE;
-
-        item_t *item = queue[queue_read];
-        queue[queue_read] = NULL;
-        pthread_mutex_unlock(&queue_mux);
-
-        if (item) {
-            if (item->event_code == LV_EVENT_REFRESH) {
-                lv_obj_invalidate(item->obj);
-            } else {
-                lv_event_send(item->obj, item->event_code, item->param);
-            }
-
-            if (item->param != NULL) {
-                free(item->param);
-            }
-
-            free(item);
+    item_t  *slot;
+    item_t  item;
+
+    while ((slot = mpsc_ring_read_begin(queue)) != NULL) {
+        /* Release the slot before the handlers, they could send events too */
+        memcpy(&item, slot, sizeof(item));
+        mpsc_ring_read_end(queue);
+
+        void *param = item.data_size ? item.data : item.param;
+
+        if (item.event_code == LV_EVENT_REFRESH) {
+            lv_obj_invalidate(item.obj);
+        } else {
+            lv_event_send(item.obj, item.event_code, param);
+        }
+
+        if (item.param != NULL) {
+            free(item.param);
         }
     }
-}
 
-void event_send(lv_obj_t *obj, lv_event_code_t event_code, void *param) {
-    pthread_mutex_lock(&queue_mux);
+    uint32_t overruns;
 
-    uint8_t next = (queue_write + 1) % QUEUE_SIZE;
+    mpsc_ring_stats(queue, &overruns, NULL);
 
-    if (queue[next]) {
-        pthread_mutex_unlock(&queue_mux);
-        LV_LOG_ERROR("Overflow");
-        return;
+    if (overruns) {
+        LV_LOG_WARN("Event queue is full, %u events dropped", overruns);
     }
+}
 
-    item_t *item = malloc(sizeof(item_t));
+static item_t * item_begin(lv_obj_t *obj, lv_event_code_t event_code) {
+    item_t *item = mpsc_ring_write_begin(queue);
 
-    item->obj = obj;
-    item->event_code = event_code;
-    item->param = param;
+    if (item) {
+        item->obj = obj;
+        item->event_code = event_code;
+        item->data_size = 0;
+        item->param = NULL;
+    }
+
+    return item;
+}
 
-    queue[next] = item;
-    queue_write = next;
+bool event_send(lv_obj_t *obj, lv_event_code_t event_code, void *param) {
+    item_t *item = item_begin(obj, event_code);
 
-    pthread_mutex_unlock(&queue_mux);
+    if (!item) {
+        free(param);
+        return false;
+    }
+
+    item->param = param;
+    mpsc_ring_write_end(queue, item);
+
+    return true;
 }
 
-void event_send_key(int32_t key) {
-    int32_t *c = malloc(sizeof(int32_t));
-    *c = key;
+bool event_send_data(lv_obj_t *obj, lv_event_code_t event_code, const void *data, size_t size) {
+    if (size > EVENT_PARAM_INLINE) {
+        void *param = malloc(size);
+
+        memcpy(param, data, size);
+        return event_send(obj, event_code, param);
+    }
+
+    item_t *item = item_begin(obj, event_code);
+
+    if (!item) {
+        return false;
+    }
+
+    memcpy(item->data, data, size);
+    item->data_size = size;
+    mpsc_ring_write_end(queue, item);
+
+    return true;
+}
 
-    event_send(lv_group_get_focused(keyboard_group), LV_EVENT_KEY, c);
+bool event_send_key(int32_t key) {
+    return event_send_data(lv_group_get_focused(keyboard_group), LV_EVENT_KEY, &key, sizeof(key));
 }
@@ -11,6 +11,7 @@
 #include "lvgl/lvgl.h"
 
 #include <unistd.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 typedef enum {
@@ -58,6 +59,11 @@ typedef struct {
     keypad_state_t  state;
 } event_keypad_t;
 
+typedef struct {
+    int32_t         diff;
+    float           speed;  /* Detents per second */
+} event_rotary_t;
+
 typedef enum {
 
     HKEY_CE = LV_KEY_BACKSPACE,
@@ -131,8 +137,20 @@ extern uint32_t EVENT_GPS;
 extern uint32_t EVENT_BAND_UP;
 extern uint32_t EVENT_BAND_DOWN;
 
+#define EVENT_PARAM_INLINE  32
+
 void event_init();
 
 void event_obj_check();
-void event_send(lv_obj_t *obj, lv_event_code_t event_code, void *param);
-void event_send_key(int32_t key);
+
+/**
+ * Queue event for the LVGL thread. Param should be allocated by malloc, it is freed after the event.
+ * Returns false if queue is full, param is freed then too
+ */
+bool event_send(lv_obj_t *obj, lv_event_code_t event_code, void *param);
+
+/**
+ * Same, param is copied into the queue item. Up to EVENT_PARAM_INLINE bytes without allocation
+ */
+bool event_send_data(lv_obj_t *obj, lv_event_code_t event_code, const void *data, size_t size);
+bool event_send_key(int32_t key);
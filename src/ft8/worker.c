@@ -19,6 +19,7 @@
 #include <ft8lib/message.h>
 #include <liquid/liquid.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -30,6 +31,8 @@
 #define MIN_SCORE 10             // Minimum score for candidate
 #define DECODE_BLOCK_STRIDE 2    // Try to decode each N block
 #define EARLY_LDPC_ITERATIONS 25 // LDPC iterations on early decoding
+#define DECODE_THREADS 2         // Default decode threads, one per core
+#define DECODE_THREADS_MAX 4
 
 static float complex *time_buf;
 static float complex *freq_buf;
@@ -52,12 +55,52 @@ static ftx_message_t  *decoded_hashtable[MAX_DECODED_MESSAGES];
 static ftx_waterfall_t wf;
 static int             find_candidates_at;
 
+/* Decode pool. Candidates are decoded in parallel, results are merged in candidate order */
+
+typedef struct {
+    ftx_message_t       message;
+    ftx_decode_status_t status;
+    bool                ok;
+} cand_result_t;
+
+static struct {
+    pthread_t       threads[DECODE_THREADS_MAX - 1];
+    int             n_threads; // Including decode caller
+    int             n_started;
+    pthread_mutex_t mux;
+    pthread_cond_t  start_cond;
+    pthread_cond_t  done_cond;
+    uint32_t        generation;
+    int             busy;
+    bool            stop;
+
+    const ftx_waterfall_t *wf;
+    const ftx_candidate_t *candidates;
+    const int             *cand_idx;
+    cand_result_t         *results;
+    int                    count;
+    int                    ldpc_iterations;
+    int                    next;
+} pool = {
+    .n_threads = DECODE_THREADS,
+    .mux = PTHREAD_MUTEX_INITIALIZER,
+    .start_cond = PTHREAD_COND_INITIALIZER,
+    .done_cond = PTHREAD_COND_INITIALIZER,
+};
+
+static cand_result_t cand_results[MAX_CANDIDATES];
+
 static void decode_messages(const ftx_waterfall_t *wf, int *num_candidates, ftx_candidate_t *candidate_list,
                             ftx_message_t *decoded, ftx_message_t **decoded_hashtable, int ldpc_iterations,
                             decoded_msg_cb msg_cb, void *user_data);
 
 static int get_message_snr(const ftx_waterfall_t *wf, const ftx_candidate_t *candidate, ftx_message_t *msg);
 
+static void  pool_start();
+static void  pool_stop();
+static void  pool_decode(const ftx_waterfall_t *wf, const ftx_candidate_t *candidates, const int *cand_idx,
+                         cand_result_t *results, int count, int ldpc_iterations);
+
 /**
  * Init worker
  */
@@ -120,6 +163,7 @@ void ftx_worker_init(int sample_rate, ftx_protocol_t protocol) {
         rx_window[i] = liquid_hann(i, nfft) * window_norm;
     }
 
+    pool_start();
     ftx_worker_reset();
 }
 
@@ -127,6 +171,7 @@ void ftx_worker_init(int sample_rate, ftx_protocol_t protocol) {
  * Cleanup worker
  */
 void ftx_worker_free() {
+    pool_stop();
     free(wf.mag);
     windowcf_destroy(frame_window);
 
@@ -249,6 +294,15 @@ bool ftx_worker_is_full() {
     return wf.max_blocks <= wf.num_blocks;
 }
 
+void ftx_worker_set_threads(int n) {
+    if (n < 1) {
+        n = 1;
+    } else if (n > DECODE_THREADS_MAX) {
+        n = DECODE_THREADS_MAX;
+    }
+    pool.n_threads = n;
+}
+
 static void decode_messages(const ftx_waterfall_t *wf, int *num_candidates, ftx_candidate_t *candidate_list,
                             ftx_message_t *decoded, ftx_message_t **decoded_hashtable, int ldpc_iterations,
                             decoded_msg_cb msg_cb, void *user_data) {
@@ -265,13 +319,21 @@ static void decode_messages(const ftx_waterfall_t *wf, int *num_candidates, ftx_
             continue;
         }
         to_delete_idx[to_delete_size++] = idx;
+    }
 
-        ftx_message_t       message;
-        ftx_decode_status_t status;
-        if (!ftx_decode_candidate(wf, cand, ldpc_iterations, &message, &status)) {
-            if (status.ldpc_errors > 0) {
-                LV_LOG_INFO("LDPC decode: %d errors", status.ldpc_errors);
-            } else if (status.crc_calculated != status.crc_extracted) {
+    // LDPC and CRC for all ready candidates
+    pool_decode(wf, candidate_list, to_delete_idx, cand_results, to_delete_size, ldpc_iterations);
+
+    // Dedup and report in candidate order, so result doesn't depend on threads timing
+    for (int i = 0; i < to_delete_size; i++) {
+        const ftx_candidate_t *cand = &candidate_list[to_delete_idx[i]];
+        cand_result_t         *res = &cand_results[i];
+        ftx_message_t         *message = &res->message;
+
+        if (!res->ok) {
+            if (res->status.ldpc_errors > 0) {
+                LV_LOG_INFO("LDPC decode: %d errors", res->status.ldpc_errors);
+            } else if (res->status.crc_calculated != res->status.crc_extracted) {
                 LV_LOG_INFO("CRC mismatch!");
             }
             continue;
@@ -281,15 +343,15 @@ static void decode_messages(const ftx_waterfall_t *wf, int *num_candidates, ftx_
         float time_sec = (cand->time_offset + (float)cand->time_sub / TIME_OSR) * symbol_period;
 
         LV_LOG_INFO("Checking hash table for %4.1fs / %4.1fHz [%d]...", time_sec, freq_hz, cand->score);
-        int  idx_hash = message.hash % MAX_DECODED_MESSAGES;
+        int  idx_hash = message->hash % MAX_DECODED_MESSAGES;
         bool found_empty_slot = false;
         bool found_duplicate = false;
         do {
             if (decoded_hashtable[idx_hash] == NULL) {
                 LV_LOG_INFO("Found an empty slot");
                 found_empty_slot = true;
-            } else if ((decoded_hashtable[idx_hash]->hash == message.hash) &&
-                       (0 == memcmp(decoded_hashtable[idx_hash]->payload, message.payload, sizeof(message.payload)))) {
+            } else if ((decoded_hashtable[idx_hash]->hash == message->hash) &&
+                       (0 == memcmp(decoded_hashtable[idx_hash]->payload, message->payload, sizeof(message->payload)))) {
                 LV_LOG_INFO("Found a duplicate!");
                 found_duplicate = true;
             } else {
@@ -301,15 +363,15 @@ static void decode_messages(const ftx_waterfall_t *wf, int *num_candidates, ftx_
 
         if (found_empty_slot) {
             // Fill the empty hashtable slot
-            memcpy(&decoded[idx_hash], &message, sizeof(message));
+            memcpy(&decoded[idx_hash], message, sizeof(*message));
             decoded_hashtable[idx_hash] = &decoded[idx_hash];
 
             char             text[FTX_MAX_MESSAGE_LENGTH];
-            ftx_message_rc_t unpack_status = ftx_message_decode(&message, &hash_if, text);
+            ftx_message_rc_t unpack_status = ftx_message_decode(message, &hash_if, text);
             if (unpack_status != FTX_MESSAGE_RC_OK) {
                 LV_LOG_INFO("Error [%d] while unpacking!", (int)unpack_status);
             } else {
-                int snr = get_message_snr(wf, cand, &message);
+                int snr = get_message_snr(wf, cand, message);
                 msg_cb(text, snr, freq_hz, time_sec, user_data);
             }
         }
@@ -318,6 +380,111 @@ static void decode_messages(const ftx_waterfall_t *wf, int *num_candidates, ftx_
     ftx_delete_candidates(to_delete_idx, to_delete_size, candidate_list, num_candidates);
 }
 
+/**
+ * Take candidates from shared counter until all are done
+ */
+static void pool_run_job() {
+    int i;
+
+    while ((i = __atomic_fetch_add(&pool.next, 1, __ATOMIC_RELAXED)) < pool.count) {
+        cand_result_t *res = &pool.results[i];
+
+        res->ok = ftx_decode_candidate(pool.wf, &pool.candidates[pool.cand_idx[i]], pool.ldpc_iterations,
+                                       &res->message, &res->status);
+    }
+}
+
+static void * pool_thread(void *arg) {
+    uint32_t generation = 0;
+
+    pthread_mutex_lock(&pool.mux);
+    while (true) {
+        while (!pool.stop && pool.generation == generation) {
+            pthread_cond_wait(&pool.start_cond, &pool.mux);
+        }
+        if (pool.stop) {
+            break;
+        }
+        generation = pool.generation;
+        pthread_mutex_unlock(&pool.mux);
+
+        pool_run_job();
+
+        pthread_mutex_lock(&pool.mux);
+        if (--pool.busy == 0) {
+            pthread_cond_signal(&pool.done_cond);
+        }
+    }
+    pthread_mutex_unlock(&pool.mux);
+    return NULL;
+}
+
+static void pool_start() {
+    pool.stop = false;
+    pool.n_started = 0;
+    pool.generation = 0;
+
+    for (int i = 0; i < pool.n_threads - 1; i++) {
+        if (pthread_create(&pool.threads[i], NULL, pool_thread, NULL) != 0) {
+            LV_LOG_ERROR("Can't start decode thread");
+            break;
+        }
+        pool.n_started++;
+    }
+}
+
+static void pool_stop() {
+    pthread_mutex_lock(&pool.mux);
+    pool.stop = true;
+    pthread_cond_broadcast(&pool.start_cond);
+    pthread_mutex_unlock(&pool.mux);
+
+    for (int i = 0; i < pool.n_started; i++) {
+        pthread_join(pool.threads[i], NULL);
+    }
+    pool.n_started = 0;
+}
+
+static void pool_decode(const ftx_waterfall_t *wf, const ftx_candidate_t *candidates, const int *cand_idx,
+                        cand_result_t *results, int count, int ldpc_iterations) {
+    int cancel_state;
+
+    if (count == 0) {
+        return;
+    }
+
+    // Caller thread might be canceled, don't leave pool with locked mutex
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cancel_state);
+
+    pool.wf = wf;
+    pool.candidates = candidates;
+    pool.cand_idx = cand_idx;
+    pool.results = results;
+    pool.count = count;
+    pool.ldpc_iterations = ldpc_iterations;
+    pool.next = 0;
+
+    if (pool.n_started > 0 && count > 1) {
+        pthread_mutex_lock(&pool.mux);
+        pool.busy = pool.n_started;
+        pool.generation++;
+        pthread_cond_broadcast(&pool.start_cond);
+        pthread_mutex_unlock(&pool.mux);
+
+        pool_run_job();
+
+        pthread_mutex_lock(&pool.mux);
+        while (pool.busy > 0) {
+            pthread_cond_wait(&pool.done_cond, &pool.mux);
+        }
+        pthread_mutex_unlock(&pool.mux);
+    } else {
+        pool_run_job();
+    }
+
+    pthread_setcancelstate(cancel_state, NULL);
+}
+
 static int get_message_snr(const ftx_waterfall_t *wf, const ftx_candidate_t *candidate, ftx_message_t *msg) {
     uint8_t n_tones = (wf->protocol == FTX_PROTOCOL_FT4) ? FT4_NN : FT8_NN;
     uint8_t tones[n_tones];
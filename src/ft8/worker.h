@@ -55,3 +55,7 @@ int ftx_worker_get_block_size();
 /// @brief Check that wf is full
 bool ftx_worker_is_full();
 
+
+/// @brief Set count of threads for candidates decoding, should be called before `ftx_worker_init`
+/// @param[in] n threads count, including caller of `ftx_worker_decode`
+void ftx_worker_set_threads(int n);
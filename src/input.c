@@ -0,0 +1,192 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#include "input.h"
+
+#include "lvgl/lvgl.h"
+#include "ring/spsc.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <linux/input.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#define MAX_DEVICES     8
+#define RING_SIZE       32
+#define EVENTS_BATCH    16
+#define SPEED_RESET     200000  /* us, detent after the pause starts from zero speed */
+#define SPEED_SMOOTH    0.5f
+#define POLL_PERIOD     20      /* ms, for the inputs epoll can't watch */
+
+typedef struct {
+    int32_t     diff;
+    float       speed;
+} input_rel_t;
+
+struct input_dev_s {
+    int             fd;
+    spsc_ring_t     *ring;
+
+    /* Input thread side */
+    uint64_t        prev_time;  /* us, kernel time of the previous detent */
+    float           speed;
+    int32_t         carry;      /* Ring was full, goes with the next detent */
+    bool            polled;     /* Regular file or /dev/null, read by period */
+};
+
+static input_dev_t  devices[MAX_DEVICES];
+static uint8_t      devices_count = 0;
+static int          epoll_fd = -1;
+static int          wake_fd = -1;   /* Restarts the wait with the poll period */
+static uint8_t      polled_count = 0;
+
+static void dev_event(input_dev_t *dev, const struct input_event *in, int32_t *diff) {
+    uint64_t time = (uint64_t) in->input_event_sec * 1000000L + in->input_event_usec;
+    uint64_t dt = time - dev->prev_time;
+
+    if (dev->prev_time == 0 || dt > SPEED_RESET) {
+        dev->speed = 0.0f;
+    } else if (dt > 0) {
+        float speed = abs(in->value) * 1000000.0f / dt;
+
+        dev->speed += (speed - dev->speed) * SPEED_SMOOTH;
+    }
+
+    dev->prev_time = time;
+    *diff += in->value;
+}
+
+static void dev_read(input_dev_t *dev) {
+    struct input_event  in[EVENTS_BATCH];
+    int32_t             diff = 0;
+    ssize_t             res;
+
+    while ((res = read(dev->fd, in, sizeof(in))) > 0) {
+        for (size_t i = 0; i < res / sizeof(struct input_event); i++) {
+            if (in[i].type == EV_REL) {
+                dev_event(dev, &in[i], &diff);
+            }
+        }
+    }
+
+    diff += dev->carry;
+
+    if (diff == 0) {
+        return;
+    }
+
+    input_rel_t item = { .diff = diff, .speed = dev->speed };
+
+    dev->carry = spsc_ring_put(dev->ring, &item) ? 0 : diff;
+}
+
+static void * input_thread(void *arg) {
+    struct epoll_event events[MAX_DEVICES];
+
+    while (true) {
+        int timeout = __atomic_load_n(&polled_count, __ATOMIC_ACQUIRE) ? POLL_PERIOD : -1;
+        int n = epoll_wait(epoll_fd, events, MAX_DEVICES, timeout);
+
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.ptr) {
+                dev_read(events[i].data.ptr);
+            } else {
+                uint64_t val;
+
+                read(wake_fd, &val, sizeof(val));
+            }
+        }
+
+        uint8_t count = __atomic_load_n(&devices_count, __ATOMIC_ACQUIRE);
+
+        for (uint8_t i = 0; i < count; i++) {
+            if (devices[i].polled) {
+                dev_read(&devices[i]);
+            }
+        }
+    }
+    return NULL;
+}
+
+input_dev_t * input_add(int fd) {
+    if (devices_count == MAX_DEVICES) {
+        LV_LOG_ERROR("Too many input devices");
+        return NULL;
+    }
+
+    if (epoll_fd < 0) {
+        pthread_t thread;
+
+        struct epoll_event wake = { .events = EPOLLIN, .data.ptr = NULL };
+
+        epoll_fd = epoll_create1(0);
+        wake_fd = eventfd(0, EFD_NONBLOCK);
+
+        if (epoll_fd < 0 || wake_fd < 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &wake) != 0 ||
+            pthread_create(&thread, NULL, input_thread, NULL) != 0)
+        {
+            LV_LOG_ERROR("Problem with create input thread");
+            return NULL;
+        }
+        pthread_detach(thread);
+    }
+
+    input_dev_t *dev = &devices[devices_count];
+
+    dev->fd = fd;
+    dev->ring = spsc_ring_create(sizeof(input_rel_t), RING_SIZE);
+
+    struct epoll_event event = { .events = EPOLLIN, .data.ptr = dev };
+
+    dev->polled = false;
+
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        if (errno != EPERM) {
+            LV_LOG_ERROR("Can't watch input %i", fd);
+            spsc_ring_destroy(dev->ring);
+            return NULL;
+        }
+
+        /* Epoll does not support regular files and /dev/null (simulator inputs) */
+
+        dev->polled = true;
+        __atomic_add_fetch(&polled_count, 1, __ATOMIC_RELEASE);
+    }
+
+    __atomic_add_fetch(&devices_count, 1, __ATOMIC_RELEASE);
+
+    if (dev->polled) {
+        uint64_t val = 1;
+
+        write(wake_fd, &val, sizeof(val));
+    }
+
+    return dev;
+}
+
+int32_t input_take(input_dev_t *dev, float *speed) {
+    input_rel_t *item;
+    int32_t     diff = 0;
+
+    if (!dev) {
+        return 0;
+    }
+
+    while ((item = spsc_ring_read_begin(dev->ring)) != NULL) {
+        diff += item->diff;
+
+        if (speed) {
+            *speed = item->speed;
+        }
+        spsc_ring_read_end(dev->ring);
+    }
+
+    return diff;
+}
@@ -0,0 +1,27 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Relative evdev devices (knobs) are read by one epoll thread as soon as events come.
+ * Speed is measured by the kernel timestamps of the detents, not by the LVGL polling.
+ */
+
+typedef struct input_dev_s input_dev_t;
+
+/**
+ * Read the device in the input thread. Thread is started with the first device
+ */
+input_dev_t * input_add(int fd);
+
+/**
+ * Sum of detents since the last call and the last speed, detents per second. Called from LVGL.
+ * Speed is not changed if there are no detents
+ */
+int32_t input_take(input_dev_t *dev, float *speed);
@@ -0,0 +1,393 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#include "iq_rec.h"
+
+#include "ring/spsc.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#define RING_SIZE       256                 /* packets, ~1.3 s */
+#define SEGMENT_SIZE    (4 * 1024 * 1024)   /* File grows and is mapped by segments */
+#define WRITER_NICE     10
+#define SAMPLE_RATE     100000
+
+/* Recording */
+
+static bool             on = false;
+static spsc_ring_t      *ring = NULL;
+static sem_t            ring_sem;
+static pthread_t        writer;
+static bool             writer_stop = false;
+
+static int              fd = -1;
+static uint8_t          *segment = NULL;
+static off_t            segment_offset;
+static size_t           segment_pos;
+static off_t            file_size;
+static uint64_t         first_time;
+
+/* Replay */
+
+static bool             replay_on = false;
+static bool             replay_stop_req = false;
+static uint8_t          *replay_map = NULL;
+static size_t           replay_size;
+static size_t           replay_count;
+static size_t           replay_pos;
+static bool             replay_realtime;
+static uint64_t         replay_start;
+
+/* Realtime replay waits on it, stop wakes the wait */
+static pthread_once_t   replay_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t  replay_mux = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   replay_cond;
+
+static uint64_t get_time_us() {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000L + now.tv_nsec / 1000L;
+}
+
+static bool map_segment(off_t offset) {
+    if (segment) {
+        munmap(segment, SEGMENT_SIZE);
+        segment = NULL;
+    }
+
+    if (ftruncate(fd, offset + SEGMENT_SIZE) != 0) {
+        LV_LOG_ERROR("Can't grow IQ file");
+        return false;
+    }
+
+    segment = mmap(NULL, SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, offset);
+
+    if (segment == MAP_FAILED) {
+        LV_LOG_ERROR("Can't map IQ file");
+        segment = NULL;
+        return false;
+    }
+
+    segment_offset = offset;
+    segment_pos = 0;
+    return true;
+}
+
+/* Packets could cross the segment boundary */
+static bool write_data(const void *data, size_t size) {
+    const uint8_t *src = data;
+
+    while (size > 0) {
+        if (!segment || segment_pos == SEGMENT_SIZE) {
+            if (!map_segment(segment ? segment_offset + SEGMENT_SIZE : 0)) {
+                return false;
+            }
+        }
+
+        size_t n = SEGMENT_SIZE - segment_pos;
+
+        if (n > size) {
+            n = size;
+        }
+        memcpy(segment + segment_pos, src, n);
+        segment_pos += n;
+        file_size += n;
+        src += n;
+        size -= n;
+    }
+    return true;
+}
+
+static void write_ring() {
+    iq_rec_packet_t *packet;
+
+    while ((packet = spsc_ring_read_begin(ring)) != NULL) {
+        if (fd >= 0 && !write_data(packet, sizeof(*packet))) {
+            close(fd);
+            fd = -1;
+        }
+        spsc_ring_read_end(ring);
+    }
+}
+
+static void * writer_thread(void *arg) {
+    setpriority(PRIO_PROCESS, syscall(SYS_gettid), WRITER_NICE);
+
+    while (!__atomic_load_n(&writer_stop, __ATOMIC_ACQUIRE)) {
+        sem_wait(&ring_sem);
+        write_ring();
+    }
+
+    write_ring();
+    return NULL;
+}
+
+bool iq_rec_start(const char *filename) {
+    if (on) {
+        return false;
+    }
+
+    fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0) {
+        LV_LOG_ERROR("Can't create %s", filename);
+        return false;
+    }
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    iq_rec_header_t header = {
+        .magic = IQ_REC_MAGIC,
+        .version = IQ_REC_VERSION,
+        .samples = RADIO_SAMPLES,
+        .rate = SAMPLE_RATE,
+        .start = (int64_t) now.tv_sec * 1000000L + now.tv_nsec / 1000L
+    };
+
+    file_size = 0;
+
+    if (!write_data(&header, sizeof(header))) {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    if (ring == NULL) {
+        ring = spsc_ring_create(sizeof(iq_rec_packet_t), RING_SIZE);
+        sem_init(&ring_sem, 0, 0);
+    }
+
+    uint32_t overruns, max_count;
+
+    spsc_ring_clear(ring);
+    spsc_ring_stats(ring, &overruns, &max_count);
+    while (sem_trywait(&ring_sem) == 0) {}
+
+    first_time = 0;
+    writer_stop = false;
+
+    if (pthread_create(&writer, NULL, writer_thread, NULL) != 0) {
+        LV_LOG_ERROR("Problem with create IQ writer thread");
+        munmap(segment, SEGMENT_SIZE);
+        segment = NULL;
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    __atomic_store_n(&on, true, __ATOMIC_RELEASE);
+    return true;
+}
+
+uint32_t iq_rec_stop() {
+    uint32_t overruns, max_count;
+
+    if (!on) {
+        return 0;
+    }
+
+    __atomic_store_n(&on, false, __ATOMIC_RELEASE);
+    __atomic_store_n(&writer_stop, true, __ATOMIC_RELEASE);
+    sem_post(&ring_sem);
+    pthread_join(writer, NULL);
+
+    if (segment) {
+        munmap(segment, SEGMENT_SIZE);
+        segment = NULL;
+    }
+    if (fd >= 0) {
+        if (ftruncate(fd, file_size) != 0) {
+            LV_LOG_ERROR("Can't truncate IQ file");
+        }
+        close(fd);
+        fd = -1;
+    }
+
+    spsc_ring_stats(ring, &overruns, &max_count);
+    LV_LOG_USER("IQ recorder ring: overruns %u, max fill %u/%u", overruns, max_count, spsc_ring_capacity(ring));
+
+    return overruns;
+}
+
+bool iq_rec_is_on() {
+    return __atomic_load_n(&on, __ATOMIC_ACQUIRE);
+}
+
+void iq_rec_put(const cfloat *samples, bool tx, uint64_t time) {
+    if (!iq_rec_is_on()) {
+        return;
+    }
+
+    iq_rec_packet_t *packet = spsc_ring_write_begin(ring);
+
+    if (!packet) {
+        return;
+    }
+
+    if (first_time == 0) {
+        first_time = time;
+    }
+
+    packet->time = time - first_time;
+    packet->flags = tx ? IQ_REC_TX : 0;
+    packet->reserved = 0;
+    memcpy(packet->samples, samples, sizeof(packet->samples));
+
+    spsc_ring_write_end(ring);
+    sem_post(&ring_sem);
+}
+
+/* Replay */
+
+static void replay_cond_init() {
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&replay_cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+bool iq_rec_replay_start(const char *filename, bool realtime) {
+    pthread_once(&replay_once, replay_cond_init);
+
+    if (iq_rec_replay_is_on()) {
+        return false;
+    }
+
+    int         replay_fd = open(filename, O_RDONLY);
+    struct stat st;
+
+    if (replay_fd < 0) {
+        LV_LOG_ERROR("Can't open %s", filename);
+        return false;
+    }
+
+    if (fstat(replay_fd, &st) != 0 || st.st_size < (off_t) sizeof(iq_rec_header_t)) {
+        LV_LOG_ERROR("Wrong IQ file %s", filename);
+        close(replay_fd);
+        return false;
+    }
+
+    replay_size = st.st_size;
+    replay_map = mmap(NULL, replay_size, PROT_READ, MAP_PRIVATE, replay_fd, 0);
+    close(replay_fd);
+
+    if (replay_map == MAP_FAILED) {
+        LV_LOG_ERROR("Can't map %s", filename);
+        replay_map = NULL;
+        return false;
+    }
+
+    const iq_rec_header_t *header = (const iq_rec_header_t *) replay_map;
+
+    if (header->magic != IQ_REC_MAGIC || header->version != IQ_REC_VERSION || header->samples != RADIO_SAMPLES) {
+        LV_LOG_ERROR("Wrong IQ file %s", filename);
+        munmap(replay_map, replay_size);
+        replay_map = NULL;
+        return false;
+    }
+
+    madvise(replay_map, replay_size, MADV_SEQUENTIAL);
+
+    replay_count = (replay_size - sizeof(iq_rec_header_t)) / sizeof(iq_rec_packet_t);
+    replay_pos = 0;
+    replay_realtime = realtime;
+    replay_start = 0;
+    replay_stop_req = false;
+
+    LV_LOG_USER("IQ replay %s: %zu packets, %s", filename, replay_count, realtime ? "realtime" : "max speed");
+
+    __atomic_store_n(&replay_on, true, __ATOMIC_RELEASE);
+    return true;
+}
+
+void iq_rec_replay_stop() {
+    pthread_once(&replay_once, replay_cond_init);
+
+    pthread_mutex_lock(&replay_mux);
+    __atomic_store_n(&replay_stop_req, true, __ATOMIC_RELEASE);
+    pthread_cond_signal(&replay_cond);
+    pthread_mutex_unlock(&replay_mux);
+}
+
+bool iq_rec_replay_is_on() {
+    return __atomic_load_n(&replay_on, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Sleep until due time (us, CLOCK_MONOTONIC) or stop request
+ */
+static void replay_wait(uint64_t due) {
+    struct timespec ts = {
+        .tv_sec = due / 1000000,
+        .tv_nsec = (due % 1000000) * 1000
+    };
+
+    pthread_mutex_lock(&replay_mux);
+    while (!__atomic_load_n(&replay_stop_req, __ATOMIC_ACQUIRE)) {
+        if (pthread_cond_timedwait(&replay_cond, &replay_mux, &ts) == ETIMEDOUT) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&replay_mux);
+}
+
+/* Map is released here, in the only thread that reads it */
+static void replay_finish() {
+    uint64_t t = get_time_us() - replay_start;
+
+    LV_LOG_USER("IQ replay done: %zu packets in %llu ms", replay_pos, (unsigned long long) t / 1000);
+
+    munmap(replay_map, replay_size);
+    replay_map = NULL;
+    __atomic_store_n(&replay_on, false, __ATOMIC_RELEASE);
+}
+
+const iq_rec_packet_t * iq_rec_replay_next() {
+    if (!iq_rec_replay_is_on()) {
+        return NULL;
+    }
+
+    if (__atomic_load_n(&replay_stop_req, __ATOMIC_ACQUIRE) || replay_pos >= replay_count) {
+        replay_finish();
+        return NULL;
+    }
+
+    const iq_rec_packet_t *packet = (const iq_rec_packet_t *) (replay_map + sizeof(iq_rec_header_t)) + replay_pos++;
+
+    if (replay_start == 0) {
+        replay_start = get_time_us() - packet->time;
+    }
+
+    if (replay_realtime) {
+        uint64_t due = replay_start + packet->time;
+
+        if (due > get_time_us()) {
+            replay_wait(due);
+
+            if (__atomic_load_n(&replay_stop_req, __ATOMIC_ACQUIRE)) {
+                replay_finish();
+                return NULL;
+            }
+        }
+    }
+
+    return packet;
+}
@@ -0,0 +1,70 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#pragma once
+
+#include "helpers.h"
+#include "radio.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Raw baseband IQ of the flow: header and then packets as they were given to DSP.
+ * Samples are stored as is, so the replay is bit exact. About 800 KB per second.
+ */
+
+#define IQ_REC_EXT      "iq"
+#define IQ_REC_MAGIC    0x51493658  /* "X6IQ" */
+#define IQ_REC_VERSION  1
+
+#define IQ_REC_TX       (1 << 0)
+
+typedef struct {
+    uint32_t    magic;
+    uint16_t    version;
+    uint16_t    samples;        /* Per packet */
+    uint32_t    rate;
+    uint32_t    reserved;
+    int64_t     start;          /* Unix time of the first packet, us */
+} iq_rec_header_t;
+
+typedef struct {
+    uint64_t    time;           /* us, since the first packet */
+    uint32_t    flags;
+    uint32_t    reserved;
+    cfloat      samples[RADIO_SAMPLES];
+} iq_rec_packet_t;
+
+/**
+ * Start recording to the new file
+ */
+bool iq_rec_start(const char *filename);
+
+/**
+ * Stop recording and wait for the writer. Returns number of lost packets
+ */
+uint32_t iq_rec_stop();
+
+bool iq_rec_is_on();
+
+/**
+ * Called from the flow thread, only copies packet to the ring
+ */
+void iq_rec_put(const cfloat *samples, bool tx, uint64_t time);
+
+/**
+ * Replay the file instead of the flow. With realtime = false packets go as fast as DSP takes them
+ */
+bool iq_rec_replay_start(const char *filename, bool realtime);
+void iq_rec_replay_stop();
+bool iq_rec_replay_is_on();
+
+/**
+ * Called from the DSP thread. Waits for the packet time in realtime mode.
+ * Returns NULL at the end of file or after stop, packet is valid till the next call
+ */
+const iq_rec_packet_t * iq_rec_replay_next();
@@ -7,8 +7,13 @@
  */
 
 #include "lvgl/lvgl.h"
+#ifdef X6100_SIM
+#include "sim/display.h"
+#else
 #include "lv_drivers/display/fbdev.h"
+#endif
 #include <unistd.h>
+#include <stdlib.h>
 #include <pthread.h>
 #include <time.h>
 #include <sys/time.h>
@@ -38,8 +43,16 @@
 #include "scheduler.h"
 #include "wifi.h"
 #include "usb_devices.h"
+#include "iq_rec.h"
 
 #define DISP_BUF_SIZE (800 * 480 * 4)
+#define SCHEDULER_STATS_PERIOD  (60 * 1000)
+
+#ifdef X6100_SIM
+#define INPUT_DEV(n)    sim_input_dev(n)
+#else
+#define INPUT_DEV(n)    "/dev/input/event" #n
+#endif
 
 rotary_t                    *vol;
 encoder_t                   *mfk;
@@ -54,7 +67,11 @@ int main(void) {
     lv_init();
     // lv_png_init();
 
+#ifdef X6100_SIM
+    sim_display_init();
+#else
     fbdev_init();
+#endif
     audio_init();
     event_init();
     usb_devices_monitor_init();
@@ -63,11 +80,17 @@ int main(void) {
     lv_disp_drv_init(&disp_drv);
 
     disp_drv.draw_buf   = &disp_buf;
+#ifdef X6100_SIM
+    disp_drv.flush_cb   = sim_display_flush;
+    disp_drv.hor_res    = SIM_DISPLAY_WIDTH;
+    disp_drv.ver_res    = SIM_DISPLAY_HEIGHT;
+#else
     disp_drv.flush_cb   = fbdev_flush;
     disp_drv.hor_res    = 480;
     disp_drv.ver_res    = 800;
-    disp_drv.sw_rotate  = 1;
+    disp_drv.sw_rotate  = !fbdev_rotation_supported();
     disp_drv.rotated    = LV_DISP_ROT_90;
+#endif
 
     lv_disp_drv_register(&disp_drv);
 
@@ -76,13 +99,13 @@ int main(void) {
 
     keyboard_init();
 
-    keypad_init("/dev/input/event0");
-    keypad_init("/dev/input/event4");
+    keypad_init(INPUT_DEV(0));
+    keypad_init(INPUT_DEV(4));
 
-    rotary_init("/dev/input/event1");
+    rotary_init(INPUT_DEV(1));
 
-    vol = rotary_init("/dev/input/event2");
-    mfk = encoder_init("/dev/input/event3");
+    vol = rotary_init(INPUT_DEV(2));
+    mfk = encoder_init(INPUT_DEV(3));
 
     vol->left[VOL_EDIT] = KEY_VOL_LEFT_EDIT;
     vol->right[VOL_EDIT] = KEY_VOL_RIGHT_EDIT;
@@ -99,6 +122,11 @@ int main(void) {
 
     dsp_init();
     radio_init();
+#ifdef X6100_SIM
+    if (getenv("X6100_SIM_REPLAY")) {
+        iq_rec_replay_start(getenv("X6100_SIM_REPLAY"), getenv("X6100_SIM_REPLAY_FAST") == NULL);
+    }
+#endif
     lv_obj_t *main_obj = main_screen();
 
     cw_init();
@@ -127,11 +155,26 @@ int main(void) {
 #endif
 
     int64_t next_loop_time, sleep_time, loop_start_time;
+    int64_t stats_time = get_time();
+#ifdef X6100_SIM
+    while (sim_running()) {
+#else
     while (1) {
+#endif
         loop_start_time = get_time();
         observer_delayed_notify_all();
         event_obj_check();
         scheduler_work();
+
+        if (loop_start_time - stats_time > SCHEDULER_STATS_PERIOD) {
+            scheduler_stats_t stats;
+
+            scheduler_get_stats(&stats, true);
+            LV_LOG_USER("Scheduler: depth %u, max depth %u, dropped %u, coalesced %u, heap args %u",
+                        stats.depth, stats.max_depth, stats.drops, stats.coalesced, stats.heap_args);
+            stats_time = loop_start_time;
+        }
+
         next_loop_time = lv_timer_handler() + loop_start_time;
         sleep_time = next_loop_time - get_time();
         if (sleep_time > 0) {
@@ -49,12 +49,15 @@
 #include "pubsub_ids.h"
 #include "cfg/mode.h"
 #include "cfg/memory.h"
+#include "cfg/persist.h"
 #include "knobs.h"
 
 #include <unistd.h>
 #include <stdint.h>
 #include <stdlib.h>
 
+#define FREQ_ACCEL_SPEED_1  40.0f   /* Detents per second */
+#define FREQ_ACCEL_SPEED_2  80.0f
 
 static uint16_t     spectrum_height = (480 / 3);
 static uint16_t     freq_height = 36;
@@ -78,7 +81,7 @@ static lv_timer_t *low_power_timer;
 
 static void low_power_timer_cb(lv_timer_t * timer);
 
-static void freq_shift(int16_t diff);
+static void freq_shift(int16_t diff, float speed);
 static void next_freq_step(bool up);
 static void toggle_atu_enabled();
 
@@ -737,7 +740,7 @@ static void main_screen_hkey_cb(lv_event_t * e) {
         case HKEY_UP:
             if (hkey->state == HKEY_RELEASE) {
                 if (!subject_get_int(freq_lock)) {
-                    freq_shift(+1);
+                    freq_shift(+1, 0.0f);
                 }
             } else if (hkey->state == HKEY_LONG) {
                 if (!band_lock) {
@@ -750,7 +753,7 @@ static void main_screen_hkey_cb(lv_event_t * e) {
         case HKEY_DOWN:
             if (hkey->state == HKEY_RELEASE) {
                 if (!subject_get_int(freq_lock)) {
-                    freq_shift(-1);
+                    freq_shift(-1, 0.0f);
                 }
             } else if (hkey->state == HKEY_LONG) {
                 if (!band_lock) {
@@ -797,8 +800,11 @@ static void main_screen_update_cb(lv_event_t * e) {
     spectrum_clear();
 }
 
-static uint16_t freq_accel(uint16_t diff) {
-    if (diff < 3) {
+/**
+ * Step multiplier by the knob speed, detents per second
+ */
+static uint16_t freq_accel(float speed) {
+    if (speed < FREQ_ACCEL_SPEED_1) {
         return 1;
     }
 
@@ -807,21 +813,21 @@ static uint16_t freq_accel(uint16_t diff) {
             return 1;
 
         case FREQ_ACCEL_LITE:
-            return (diff < 6) ? 5 : 10;
+            return (speed < FREQ_ACCEL_SPEED_2) ? 5 : 10;
 
         case FREQ_ACCEL_STRONG:
-            return (diff < 6) ? 10 : 30;
+            return (speed < FREQ_ACCEL_SPEED_2) ? 10 : 30;
     }
     return 1;
 }
 
-static void freq_shift(int16_t diff) {
+static void freq_shift(int16_t diff, float speed) {
     if (subject_get_int(freq_lock)) {
         return;
     }
 
     int32_t freq = subject_get_int(cfg_cur.fg_freq);
-    int32_t df = diff * subject_get_int(cfg_cur.freq_step) * freq_accel(abs(diff));
+    int32_t df = diff * subject_get_int(cfg_cur.freq_step) * freq_accel(speed);
     freq = align_int(freq + df, abs(df));
     subject_set_int(cfg_cur.fg_freq, freq);
 
@@ -829,11 +835,10 @@ static void freq_shift(int16_t diff) {
 }
 
 static void main_screen_rotary_cb(lv_event_t * e) {
-    int32_t *diff = (int32_t *) lv_event_get_param(e);
+    event_rotary_t *rotary = (event_rotary_t *) lv_event_get_param(e);
 
-    freq_shift(*diff);
-    dialog_rotary(*diff);
-    free(diff);
+    freq_shift(rotary->diff, rotary->speed);
+    dialog_rotary(rotary->diff);
 }
 
 static void spectrum_key_cb(lv_event_t * e) {
@@ -842,13 +847,13 @@ static void spectrum_key_cb(lv_event_t * e) {
     switch (key) {
         case '-':
             if (!subject_get_int(freq_lock)) {
-                freq_shift(-1);
+                freq_shift(-1, 0.0f);
             }
             break;
 
         case '=':
             if (!subject_get_int(freq_lock)) {
-                freq_shift(+1);
+                freq_shift(+1, 0.0f);
             }
             break;
 
@@ -1122,6 +1127,7 @@ void main_screen_notify_rx_tx(bool tx) {
 void main_screen_notify_low_power(bool is_low) {
     if (is_low) {
         if (!low_power_timer) {
+            cfg_persist_flush();
             low_power_timer = lv_timer_create(low_power_timer_cb, 30000, NULL);
             lv_timer_set_repeat_count(low_power_timer, 1);
             msg_schedule_long_text_fmt("Low battery! Turning off in 30s.");
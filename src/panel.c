@@ -100,6 +100,30 @@ void panel_add_text(const char * text) {
     scheduler_put((void(*)(void*))panel_update_cb, (void*)text, strlen(text) + 1);
 }
 
+static void panel_set_cb(const char *text) {
+    if (!last_line) {
+        return;
+    }
+
+    strncpy(buf, text, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+
+    last_line = (char *) &buf;
+
+    for (char *ptr = buf; *ptr; ptr++) {
+        if (*ptr == '\n') {
+            last_line = ptr + 1;
+        }
+    }
+
+    lv_label_set_text_static(obj, buf);
+}
+
+/* Replace whole text, like the skimmer list */
+void panel_set_text(const char * text) {
+    scheduler_put((void(*)(void*))panel_set_cb, (void*)text, strlen(text) + 1);
+}
+
 void panel_hide() {
     lv_obj_add_flag(obj, LV_OBJ_FLAG_HIDDEN);
     knobs_display(true);
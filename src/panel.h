@@ -18,3 +18,4 @@ lv_obj_t * panel_init(lv_obj_t *parent);
 void panel_hide();
 void panel_visible();
 void panel_add_text(const char * text);
+void panel_set_text(const char * text);
@@ -8,12 +8,9 @@
 
 
 #include "common.h"
-#include "../util.h"
-
-#define PARAMS_SAVE_TIMEOUT  (3 * 1000)
+#include "../cfg/persist.h"
 
 pthread_mutex_t params_mux = PTHREAD_MUTEX_INITIALIZER;
-static uint64_t params_mod_time = 0;
 
 void params_lock() {
     pthread_mutex_lock(&params_mux);
@@ -23,17 +20,6 @@ void params_unlock(bool *dirty) {
     if (dirty != NULL) {
         *dirty = true;
     }
-    if (!params_mod_time)
-    {
-        params_mod_time = get_time();
-    }
     pthread_mutex_unlock(&params_mux);
-}
-
-bool params_ready_to_save() {
-    if ((params_mod_time) && (get_time() - params_mod_time > PARAMS_SAVE_TIMEOUT)) {
-        params_mod_time = 0;
-        return true;
-    }
-    return false;
+    cfg_persist_schedule();
 }
@@ -16,6 +16,7 @@
 #include "../vol.h"
 #include "../dialog_msg_cw.h"
 #include "../qth/qth.h"
+#include "../cfg/persist.h"
 
 #include "lvgl/lvgl.h"
 
@@ -94,6 +95,7 @@ params_t params = {
 
     .play_gain_db_f         = { .x = 0.0f, .name = "play_gain_db_f"},
     .rec_gain_db_f          = { .x = 0.0f, .name = "rec_gain_db_f"},
+    .rec_format             = { .x = RECORDER_FORMAT_MP3, .min = 0, .max = RECORDER_FORMAT_IQ, .name = "rec_format" },
 
     .voice_mode             = { .x = VOICE_LCD,                                 .name = "voice_mode" },
     .voice_lang             = { .x = 0,   .min = 0,  .max = (VOICES_NUM - 1),   .name = "voice_lang" },
@@ -265,6 +267,7 @@ static bool params_load() {
         if (params_load_uint8(&params.voice_pitch, name, i)) continue;
         if (params_load_uint8(&params.voice_volume, name, i)) continue;
         if (params_load_uint8(&params.freq_accel, name, i)) continue;
+        if (params_load_uint8(&params.rec_format, name, i)) continue;
 
         if (params_load_uint16(&params.ft8_tx_freq, name, i)) continue;
 
@@ -309,10 +312,11 @@ static void params_save_str(params_str_t *var) {
     }
 }
 
+/**
+ * Persist writer, called inside of transaction
+ */
 static void params_save() {
-    if (!sql_query_exec("BEGIN")) {
-        return;
-    }
+    params_lock();
 
     if (params.dirty.mic)                   params_write_int("mic", params.mic, &params.dirty.mic);
     if (params.dirty.hmic)                  params_write_int("hmic", params.hmic, &params.dirty.hmic);
@@ -362,6 +366,7 @@ static void params_save() {
     params_save_uint8(&params.voice_pitch);
     params_save_uint8(&params.voice_volume);
     params_save_uint8(&params.freq_accel);
+    params_save_uint8(&params.rec_format);
 
     params_save_uint16(&params.ft8_tx_freq);
 
@@ -386,21 +391,7 @@ static void params_save() {
     params_save_bool(&params.wifi_enabled);
     params_save_uint8(&params.theme);
 
-    sql_query_exec("COMMIT");
-}
-
-/* * */
-
-static void * params_thread(void *arg) {
-    while (true) {
-        pthread_mutex_lock(&params_mux);
-        if (params_ready_to_save()){
-            params_save();
-            // params_mode_save();
-        }
-        pthread_mutex_unlock(&params_mux);
-        usleep(100000);
-    }
+    pthread_mutex_unlock(&params_mux);
 }
 
 void params_init() {
@@ -444,10 +435,7 @@ void params_init() {
         LV_LOG_ERROR("Open params.db");
     }
 
-    pthread_t thread;
-
-    pthread_create(&thread, NULL, params_thread, NULL);
-    pthread_detach(thread);
+    cfg_persist_add_writer(params_save);
 }
 
 void params_msg_cw_load() {
@@ -55,6 +55,13 @@ typedef enum {
     FREQ_ACCEL_STRONG,
 } freq_accel_t;
 
+typedef enum {
+    RECORDER_FORMAT_MP3 = 0,
+    RECORDER_FORMAT_WAV,
+    RECORDER_FORMAT_FLAC,
+    RECORDER_FORMAT_IQ,         /* Raw baseband of the flow, see iq_rec.h */
+} recorder_format_t;
+
 /* Themes */
 typedef enum {
     THEME_SIMPLE,
@@ -154,6 +161,7 @@ typedef struct {
 
     params_float_t      play_gain_db_f;
     params_float_t      rec_gain_db_f;
+    params_uint8_t      rec_format;
 
     /* Voice */
 
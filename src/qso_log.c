@@ -11,6 +11,7 @@
 #include "util.h"
 #include "msg.h"
 #include "adif.h"
+#include "qso_log_index.h"
 
 #include <lvgl/src/misc/lv_log.h>
 #include <sqlite3.h>
@@ -19,11 +20,16 @@
 #include <pthread.h>
 #include <stdio.h>
 
-static sqlite3_stmt     *search_callsign_stmt=NULL;
+#define IMPORT_BATCH_SIZE   500     /* Records per transaction */
+
+static sqlite3_stmt     *insert_stmt=NULL;
 static sqlite3          *db = NULL;
+static pthread_mutex_t  db_mux = PTHREAD_MUTEX_INITIALIZER;
+static qso_log_index_t  *worked_index = NULL;
 
 
 static bool create_tables();
+static void load_index();
 static void* import_adif_thread(void* args);
 
 
@@ -34,14 +40,26 @@ bool qso_log_init() {
         LV_LOG_ERROR("Can't open qso_log.db");
         return false;
     }
-    return create_tables();
+    if (!create_tables()) {
+        return false;
+    }
+    load_index();
+    return true;
 }
 
 void qso_log_destruct() {
+    if (insert_stmt) {
+        sqlite3_finalize(insert_stmt);
+        insert_stmt = NULL;
+    }
     if (db) {
         sqlite3_close(db);
         db = NULL;
     }
+    if (worked_index) {
+        qso_log_index_destroy(worked_index);
+        worked_index = NULL;
+    }
 }
 
 void qso_log_import_adif(const char * path) {
@@ -150,59 +168,69 @@ static inline int bind_optional_text(sqlite3_stmt * stmt, int pos, const char *
     }
 }
 
-int qso_log_record_save(qso_log_record_t qso) {
+/**
+ * Insert record with persistent prepared statement. Should be called with locked db_mux
+ */
+static int record_insert(const qso_log_record_t *qso) {
     sqlite3_stmt    *stmt;
     int             rc;
 
-    if (strlen(qso.local_call) == 0) {
+    if (strlen(qso->local_call) == 0) {
         LV_LOG_ERROR("Local callsign is required");
         return -1;
     }
-    if (strlen(qso.remote_call) == 0) {
+    if (strlen(qso->remote_call) == 0) {
         LV_LOG_ERROR("Remote callsign is required");
         return -1;
     }
 
-    rc = sqlite3_prepare_v2(
-        db, "INSERT OR IGNORE INTO qso_log ("
-                "ts, freq, band, mode, local_callsign, remote_callsign, rsts, rstr, "
-                "local_grid, remote_grid, op_name, canonized_remote_callsign"
-            ") VALUES (datetime(:ts, 'unixepoch'), :freq, :band, :mode, :local_callsign, :remote_callsign, "
-                ":rsts, :rstr, :local_grid, :remote_grid, :op_name, :canonized_remote_callsign)",
-                       -1, &stmt, 0);
-    if (rc != SQLITE_OK) {
-        LV_LOG_ERROR("Error in prepairing query");
-        return -1;
+    if (!insert_stmt) {
+        rc = sqlite3_prepare_v3(
+            db, "INSERT OR IGNORE INTO qso_log ("
+                    "ts, freq, band, mode, local_callsign, remote_callsign, rsts, rstr, "
+                    "local_grid, remote_grid, op_name, canonized_remote_callsign"
+                ") VALUES (datetime(:ts, 'unixepoch'), :freq, :band, :mode, :local_callsign, :remote_callsign, "
+                    ":rsts, :rstr, :local_grid, :remote_grid, :op_name, :canonized_remote_callsign)",
+                           -1, SQLITE_PREPARE_PERSISTENT, &insert_stmt, 0);
+        if (rc != SQLITE_OK) {
+            LV_LOG_ERROR("Error in prepairing query");
+            return -1;
+        }
+    } else {
+        sqlite3_reset(insert_stmt);
+        sqlite3_clear_bindings(insert_stmt);
     }
-    rc = sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, ":ts"), qso.time);
+    stmt = insert_stmt;
+
+    rc = sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, ":ts"), qso->time);
     if (rc != SQLITE_OK) {
         printf("check point: %i\n", rc);
         printf("column_id: %i\n", sqlite3_bind_parameter_index(stmt, ":ts"));
         fflush(stdout);
         return -1;
     }
-    rc = sqlite3_bind_double(stmt, sqlite3_bind_parameter_index(stmt, ":freq"), (double) qso.freq_mhz);
+    rc = sqlite3_bind_double(stmt, sqlite3_bind_parameter_index(stmt, ":freq"), (double) qso->freq_mhz);
     if (rc != SQLITE_OK) return -1;
-    rc = sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":band"), qso.band);
+    rc = sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":band"), qso->band);
     if (rc != SQLITE_OK) return -1;
-    rc = sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":mode"), qso.mode);
+    rc = sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":mode"), qso->mode);
     if (rc != SQLITE_OK) return -1;
-    rc = sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, ":local_callsign"), qso.local_call, strlen(qso.local_call), 0);
+    rc = sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, ":local_callsign"), qso->local_call, strlen(qso->local_call), 0);
     if (rc != SQLITE_OK) return -1;
-    rc = sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, ":remote_callsign"), qso.remote_call, strlen(qso.remote_call), 0);
+    rc = sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, ":remote_callsign"), qso->remote_call, strlen(qso->remote_call), 0);
     if (rc != SQLITE_OK) return -1;
-    rc = sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":rsts"), qso.rsts);
+    rc = sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":rsts"), qso->rsts);
     if (rc != SQLITE_OK) return -1;
-    rc = sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":rstr"), qso.rstr);
+    rc = sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":rstr"), qso->rstr);
     if (rc != SQLITE_OK) return -1;
-    rc = bind_optional_text(stmt, sqlite3_bind_parameter_index(stmt, ":local_grid"), qso.local_grid);
+    rc = bind_optional_text(stmt, sqlite3_bind_parameter_index(stmt, ":local_grid"), qso->local_grid);
     if (rc != SQLITE_OK) return -1;
-    rc = bind_optional_text(stmt, sqlite3_bind_parameter_index(stmt, ":remote_grid"), qso.remote_grid);
+    rc = bind_optional_text(stmt, sqlite3_bind_parameter_index(stmt, ":remote_grid"), qso->remote_grid);
     if (rc != SQLITE_OK) return -1;
-    rc = bind_optional_text(stmt, sqlite3_bind_parameter_index(stmt, ":op_name"), qso.name);
+    rc = bind_optional_text(stmt, sqlite3_bind_parameter_index(stmt, ":op_name"), qso->name);
     if (rc != SQLITE_OK) return -1;
 
-    char * canonized_remote_callsign = util_canonize_callsign(qso.remote_call, true);
+    char * canonized_remote_callsign = util_canonize_callsign(qso->remote_call, true);
 
     rc = bind_optional_text(stmt, sqlite3_bind_parameter_index(stmt, ":canonized_remote_callsign"), canonized_remote_callsign);
     if (rc != SQLITE_OK) {
@@ -210,62 +238,70 @@ int qso_log_record_save(qso_log_record_t qso) {
         return -1;
     }
 
-    if(sqlite3_step(stmt) != SQLITE_DONE) {
-        printf("Error during execute: `%s`\n", sqlite3_expanded_sql(stmt));
+    rc = sqlite3_step(stmt);
+
+    if (rc != SQLITE_DONE) {
         free(canonized_remote_callsign);
+        LV_LOG_ERROR("Error during insert: %s", sqlite3_errmsg(db));
         return -1;
     }
 
     int changed = sqlite3_changes(db);
-    if (changed == 0) {
-        printf("Not inserted `%s`\n", sqlite3_expanded_sql(stmt));
-    }
 
+    /* Same rule as load_index(): only the canonized callsign is indexed */
+    if (changed > 0 && canonized_remote_callsign) {
+        qso_log_index_add(worked_index, canonized_remote_callsign, qso->band, qso->mode);
+    }
     free(canonized_remote_callsign);
+    return changed;
+}
 
-    sqlite3_finalize(stmt);
+int qso_log_record_save(qso_log_record_t qso) {
+    pthread_mutex_lock(&db_mux);
+    int changed = record_insert(&qso);
+    pthread_mutex_unlock(&db_mux);
+
+    if (changed == 0) {
+        printf("Not inserted %s at %lli\n", qso.remote_call, (long long) qso.time);
+    }
     return changed;
 }
 
 
 qso_log_search_worked_t qso_log_search_worked(const char *callsign, qso_log_mode_t mode, qso_log_band_t band)
 {
-    int                         rc;
-    qso_log_search_worked_t     worked = SEARCH_WORKED_NO;
+    qso_log_search_worked_t worked;
+    char                    *canonized_callsign = util_canonize_callsign(callsign, true);
 
-    if (!search_callsign_stmt) {
-        rc = sqlite3_prepare_v3(db, "SELECT DISTINCT band, mode FROM qso_log WHERE canonized_remote_callsign LIKE ?",
-                        -1, SQLITE_PREPARE_PERSISTENT, &search_callsign_stmt, 0);
-        if (rc != SQLITE_OK) {
-            return -1;
-        }
-    } else {
-        sqlite3_reset(search_callsign_stmt);
-        sqlite3_clear_bindings(search_callsign_stmt);
-    }
+    worked = qso_log_index_search(worked_index, canonized_callsign ? canonized_callsign : callsign, mode, band);
+    free(canonized_callsign);
+    return worked;
+}
 
-    char * canonized_callsign = util_canonize_callsign(callsign, true);
-    if (!canonized_callsign) {
-        canonized_callsign = strdup(callsign);
-    }
-    rc = sqlite3_bind_text(search_callsign_stmt, 1, canonized_callsign, strlen(canonized_callsign), 0);
+
+/**
+ * Fill worked before index from the log
+ */
+static void load_index() {
+    sqlite3_stmt    *stmt;
+    int             rc;
+
+    worked_index = qso_log_index_create();
+
+    rc = sqlite3_prepare_v2(db, "SELECT canonized_remote_callsign, band, mode FROM qso_log", -1, &stmt, 0);
     if (rc != SQLITE_OK) {
-        free(canonized_callsign);
-        return -1;
+        LV_LOG_ERROR("Can't load worked index: %s", sqlite3_errmsg(db));
+        return;
     }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char *callsign = (const char *) sqlite3_column_text(stmt, 0);
 
-    while (sqlite3_step(search_callsign_stmt) != SQLITE_DONE) {
-        worked = SEARCH_WORKED_YES;
-        if ((sqlite3_column_int(search_callsign_stmt, 0) == band) &&
-            (sqlite3_column_int(search_callsign_stmt, 1) == mode))
-        {
-            worked = SEARCH_WORKED_SAME_MODE;
-            break;
+        if (callsign) {
+            qso_log_index_add(worked_index, callsign, sqlite3_column_int(stmt, 1), sqlite3_column_int(stmt, 2));
         }
     }
-
-    free(canonized_callsign);
-    return worked;
+    sqlite3_finalize(stmt);
+    LV_LOG_USER("Worked index: %zu callsigns", qso_log_index_size(worked_index));
 }
 
 
@@ -275,28 +311,42 @@ static void * import_adif_thread(void* args) {
 
     pthread_detach(pthread_self());
 
-    qso_log_record_t * records;
-    int cnt = adif_read(path, &records);
-    char * canonized;
-    size_t updated_rows = 0;
-    size_t c = 0;
-    for (size_t i = 0; i < cnt; i++) {
-        int changed = qso_log_record_save(records[i]);
-        c++;
-        if (changed > 0) {
-            updated_rows += changed;
+    adif_reader reader = adif_reader_open(path);
+    if (!reader) {
+        pthread_exit(NULL);
+    }
+
+    qso_log_record_t    record;
+    size_t              updated_rows = 0;
+    size_t              cnt = 0;
+    bool                more = true;
+
+    while (more) {
+        size_t batch = 0;
+
+        pthread_mutex_lock(&db_mux);
+        sqlite3_exec(db, "BEGIN", NULL, NULL, NULL);
+        while (batch < IMPORT_BATCH_SIZE && (more = adif_reader_next(reader, &record))) {
+            int changed = record_insert(&record);
+            if (changed > 0) {
+                updated_rows += changed;
+            }
+            batch++;
         }
-        if (c >= 10) {
-            c = 0;
-            msg_update_text_fmt("Importing QSO: %zu/%zu", i + 1, cnt);
+        if (sqlite3_exec(db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
+            LV_LOG_ERROR("Can't commit imported QSOs: %s", sqlite3_errmsg(db));
         }
+        pthread_mutex_unlock(&db_mux);
+
+        cnt += batch;
+        msg_update_text_fmt("Importing QSO: %zu (%u%%)", cnt, adif_reader_progress(reader));
     }
-    free(records);
+    adif_reader_close(reader);
 
     char new_path[128] = {0};
     snprintf(new_path, sizeof(new_path), "%s.bak", path);
     rename(path, new_path);
-    msg_update_text_fmt("Imported %u QSOs from %i", updated_rows, cnt);
+    msg_update_text_fmt("Imported %zu QSOs from %zu", updated_rows, cnt);
     pthread_exit(NULL);
 }
 
@@ -0,0 +1,181 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#include "qso_log_index.h"
+
+#include <ctype.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_SIZE    1024    /* Power of 2 */
+#define BANDS_COUNT     12
+#define EMPTY           UINT32_MAX
+#define CALL_MAX_LEN    31
+
+typedef struct {
+    uint32_t    hash;
+    uint32_t    str_off;                    /* Callsign offset in pool */
+    uint8_t     band_modes[BANDS_COUNT];    /* Bit per mode */
+} entry_t;
+
+struct qso_log_index_s {
+    entry_t             *entries;
+    uint32_t            mask;
+    uint32_t            count;
+
+    char                *pool;
+    uint32_t            pool_len;
+    uint32_t            pool_size;
+
+    pthread_rwlock_t    lock;
+};
+
+static int band_id(qso_log_band_t band) {
+    switch (band) {
+        case BAND_6M:   return 1;
+        case BAND_10M:  return 2;
+        case BAND_12M:  return 3;
+        case BAND_15M:  return 4;
+        case BAND_17M:  return 5;
+        case BAND_20M:  return 6;
+        case BAND_30M:  return 7;
+        case BAND_40M:  return 8;
+        case BAND_60M:  return 9;
+        case BAND_80M:  return 10;
+        case BAND_160M: return 11;
+        default:        return 0;
+    }
+}
+
+/* Uppercase copy and FNV-1a hash */
+static uint32_t normalize(const char *callsign, char *dst) {
+    uint32_t hash = 2166136261u;
+    size_t   i;
+
+    for (i = 0; callsign[i] && i < CALL_MAX_LEN; i++) {
+        dst[i] = toupper((unsigned char) callsign[i]);
+        hash = (hash ^ (uint8_t) dst[i]) * 16777619u;
+    }
+    dst[i] = 0;
+    return hash;
+}
+
+static entry_t * find(qso_log_index_t *idx, const char *call, uint32_t hash) {
+    uint32_t i = hash & idx->mask;
+
+    while (true) {
+        entry_t *e = &idx->entries[i];
+
+        if (e->str_off == EMPTY) {
+            return e;
+        }
+        if (e->hash == hash && strcmp(idx->pool + e->str_off, call) == 0) {
+            return e;
+        }
+        i = (i + 1) & idx->mask;
+    }
+}
+
+static void alloc_entries(qso_log_index_t *idx, uint32_t size) {
+    idx->entries = malloc(size * sizeof(entry_t));
+    idx->mask = size - 1;
+    for (uint32_t i = 0; i < size; i++) {
+        idx->entries[i].str_off = EMPTY;
+    }
+}
+
+static void grow(qso_log_index_t *idx) {
+    entry_t     *old = idx->entries;
+    uint32_t    old_size = idx->mask + 1;
+
+    alloc_entries(idx, old_size * 2);
+    for (uint32_t i = 0; i < old_size; i++) {
+        if (old[i].str_off != EMPTY) {
+            *find(idx, idx->pool + old[i].str_off, old[i].hash) = old[i];
+        }
+    }
+    free(old);
+}
+
+static uint32_t pool_add(qso_log_index_t *idx, const char *call) {
+    uint32_t len = strlen(call) + 1;
+    uint32_t off = idx->pool_len;
+
+    if (idx->pool_len + len > idx->pool_size) {
+        idx->pool_size *= 2;
+        idx->pool = realloc(idx->pool, idx->pool_size);
+    }
+    memcpy(idx->pool + off, call, len);
+    idx->pool_len += len;
+    return off;
+}
+
+qso_log_index_t * qso_log_index_create() {
+    qso_log_index_t *idx = calloc(1, sizeof(qso_log_index_t));
+
+    alloc_entries(idx, INITIAL_SIZE);
+    idx->pool_size = INITIAL_SIZE * 8;
+    idx->pool = malloc(idx->pool_size);
+    pthread_rwlock_init(&idx->lock, NULL);
+    return idx;
+}
+
+void qso_log_index_destroy(qso_log_index_t *idx) {
+    pthread_rwlock_destroy(&idx->lock);
+    free(idx->entries);
+    free(idx->pool);
+    free(idx);
+}
+
+void qso_log_index_add(qso_log_index_t *idx, const char *callsign, qso_log_band_t band, qso_log_mode_t mode) {
+    char        call[CALL_MAX_LEN + 1];
+    uint32_t    hash = normalize(callsign, call);
+
+    pthread_rwlock_wrlock(&idx->lock);
+
+    entry_t *e = find(idx, call, hash);
+
+    if (e->str_off == EMPTY) {
+        if ((idx->count + 1) * 10 > (idx->mask + 1) * 7) {
+            grow(idx);
+            e = find(idx, call, hash);
+        }
+        e->hash = hash;
+        e->str_off = pool_add(idx, call);
+        memset(e->band_modes, 0, sizeof(e->band_modes));
+        idx->count++;
+    }
+    e->band_modes[band_id(band)] |= 1 << (mode & 7);
+
+    pthread_rwlock_unlock(&idx->lock);
+}
+
+qso_log_search_worked_t qso_log_index_search(qso_log_index_t *idx, const char *callsign,
+                                             qso_log_mode_t mode, qso_log_band_t band) {
+    char                    call[CALL_MAX_LEN + 1];
+    uint32_t                hash = normalize(callsign, call);
+    qso_log_search_worked_t worked = SEARCH_WORKED_NO;
+
+    pthread_rwlock_rdlock(&idx->lock);
+
+    entry_t *e = find(idx, call, hash);
+
+    if (e->str_off != EMPTY) {
+        worked = SEARCH_WORKED_YES;
+        if (e->band_modes[band_id(band)] & (1 << (mode & 7))) {
+            worked = SEARCH_WORKED_SAME_MODE;
+        }
+    }
+
+    pthread_rwlock_unlock(&idx->lock);
+    return worked;
+}
+
+size_t qso_log_index_size(qso_log_index_t *idx) {
+    return idx->count;
+}
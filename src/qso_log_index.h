@@ -0,0 +1,34 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#pragma once
+
+#include "qso_log.h"
+
+#include <stddef.h>
+
+/*
+ * In-memory "worked before" index: hash set of canonized callsigns
+ * with band x mode bitmask for each of them. Thread safe.
+ */
+
+typedef struct qso_log_index_s qso_log_index_t;
+
+qso_log_index_t * qso_log_index_create();
+void qso_log_index_destroy(qso_log_index_t *idx);
+
+/**
+ * Mark callsign as worked on band and mode. Callsign should be canonized
+ */
+void qso_log_index_add(qso_log_index_t *idx, const char *callsign, qso_log_band_t band, qso_log_mode_t mode);
+
+/**
+ * Search canonized callsign, case insensitive
+ */
+qso_log_search_worked_t qso_log_index_search(qso_log_index_t *idx, const char *callsign,
+                                             qso_log_mode_t mode, qso_log_band_t band);
+
+size_t qso_log_index_size(qso_log_index_t *idx);
@@ -9,6 +9,7 @@
 
 #include "cfg/atu.h"
 #include "cfg/transverter.h"
+#include "cfg/persist.h"
 #include "util.h"
 #include "dsp.h"
 #include "params/params.h"
@@ -18,6 +19,9 @@
 #include "dialog_swrscan.h"
 #include "cw.h"
 #include "pubsub_ids.h"
+#include "ring/spsc.h"
+#include "ctlq/ctlq.h"
+#include "iq_rec.h"
 
 #include <aether_radio/x6100_control/low/flow.h>
 #include <aether_radio/x6100_control/low/gpio.h>
@@ -26,16 +30,46 @@
 #include <stdio.h>
 #include <pthread.h>
 #include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <semaphore.h>
 
 
 
 #define FLOW_RESTART_TIMEOUT 300
 #define IDLE_TIMEOUT        (3 * 1000)
 
+/*
+ * Flow is read after the data is ready on the flow device. Without it - polling with fixed sleep.
+ * The library does not export its descriptor, so this is the UART it opens in x6100_flow_init().
+ * Both descriptors share the tty input queue: x6100_flow_read() drains it and poll() waits for new bytes
+ */
+#define FLOW_DEVICE         "/dev/ttyS1"
+#define FLOW_POLL_TIMEOUT   100     /* ms, less than FLOW_RESTART_TIMEOUT */
+#define FLOW_SLEEP          15000   /* us, polling mode */
+
+#define FLOW_STATS_PERIOD   (60 * 1000)
+#define FLOW_STATS_BUCKETS  8       /* 250us, 500us ... 16ms, more */
+
+#define DSP_RING_SIZE       32      /* packets, about 160 ms */
+
+#define CONTROL_QUEUE_SIZE  64
+#define CONTROL_STATS_PERIOD (60 * 1000)
+
+typedef struct {
+    uint64_t    ready;              /* us, flow data was ready to read */
+    uint64_t    arrival;            /* us, packet was read */
+    bool        tx;
+    cfloat      samples[RADIO_SAMPLES];
+} dsp_packet_t;
+
 static radio_rx_tx_change_t notify_rx_tx;
 static void(*low_power_cb)(bool) = NULL;
 
 static pthread_mutex_t  control_mux;
+static ctlq_t           *control_queue;
+static uint64_t         control_stats_time;
 
 static x6100_flow_t     *pack;
 
@@ -45,6 +79,17 @@ static uint64_t         prev_time;
 static uint64_t         idle_time;
 static bool             mute = false;
 
+static int              flow_fd = -1;
+static uint64_t         flow_ready;     /* us, flow data was ready to read, stamped by flow_wait() */
+static uint32_t         flow_latency[FLOW_STATS_BUCKETS];
+static uint32_t         ring_latency[FLOW_STATS_BUCKETS];
+static uint64_t         flow_stats_time;
+
+/* Samples are processed by DSP thread, flow thread only reads packets */
+static spsc_ring_t      *dsp_ring;
+static sem_t            dsp_sem;
+static bool             dsp_reset_req = false;
+
 #define WITH_RADIO_LOCK(fn) radio_lock(); fn; radio_unlock();
 
 #define CHANGE_PARAM(new_val, val, dirty, radio_fn) \
@@ -52,9 +97,7 @@ static bool             mute = false;
         params_lock(); \
         val = new_val; \
         params_unlock(&dirty); \
-        radio_lock(); \
-        radio_fn(val); \
-        radio_unlock(); \
+        control_put(cmd_uint8, &val, radio_fn, 0, val); \
         lv_msg_send(MSG_PARAM_CHANGED, NULL); \
     }
 
@@ -67,13 +110,121 @@ static void radio_unlock() {
     pthread_mutex_unlock(&control_mux);
 }
 
+/*
+ * Control commands are executed by the queue thread, callers never wait for the bus.
+ * Key is the subject or the param of the setting: only the latest value is sent.
+ * Steps of sequences (PTT, ATU, SWR scan) have zero key and keep the order
+ */
+
+static void control_put(ctlq_fn_t fn, const void *key, void *user_data, int32_t arg, int32_t val) {
+    ctlq_cmd_t cmd = {
+        .fn = fn,
+        .key = (uintptr_t) key,
+        .user_data = user_data,
+        .arg = arg,
+        .val.i = val
+    };
+
+    ctlq_put(control_queue, &cmd);
+}
+
+static void control_put_float(ctlq_fn_t fn, const void *key, void *user_data, float val) {
+    ctlq_cmd_t cmd = {
+        .fn = fn,
+        .key = (uintptr_t) key,
+        .user_data = user_data,
+        .val.f = val
+    };
+
+    ctlq_put(control_queue, &cmd);
+}
+
+static void cmd_int8(const ctlq_cmd_t *cmd) {
+    ((void (*)(int8_t)) cmd->user_data)(cmd->val.i);
+}
+
+static void cmd_uint8(const ctlq_cmd_t *cmd) {
+    ((void (*)(uint8_t)) cmd->user_data)(cmd->val.i);
+}
+
+static void cmd_uint16(const ctlq_cmd_t *cmd) {
+    ((void (*)(uint16_t)) cmd->user_data)(cmd->val.i);
+}
+
+static void cmd_uint32(const ctlq_cmd_t *cmd) {
+    ((void (*)(uint32_t)) cmd->user_data)(cmd->val.i);
+}
+
+static void cmd_int32(const ctlq_cmd_t *cmd) {
+    ((void (*)(int32_t)) cmd->user_data)(cmd->val.i);
+}
+
+static void cmd_float(const ctlq_cmd_t *cmd) {
+    ((void (*)(float)) cmd->user_data)(cmd->val.f);
+}
+
+static void cmd_bool(const ctlq_cmd_t *cmd) {
+    ((void (*)(bool)) cmd->user_data)(cmd->val.i);
+}
+
+static void cmd_control(const ctlq_cmd_t *cmd) {
+    x6100_control_cmd((x6100_cmd_enum_t) cmd->arg, cmd->val.i);
+}
+
+static void cmd_vfo_freq(const ctlq_cmd_t *cmd) {
+    x6100_control_vfo_freq_set((x6100_vfo_t) cmd->arg, cmd->val.i);
+}
+
+static void cmd_vfo_mode(const ctlq_cmd_t *cmd) {
+    x6100_control_vfo_mode_set((x6100_vfo_t) cmd->arg, cmd->val.i);
+}
+
+static void cmd_vfo_agc(const ctlq_cmd_t *cmd) {
+    x6100_control_vfo_agc_set((x6100_vfo_t) cmd->arg, cmd->val.i);
+}
+
+static void cmd_vfo_att(const ctlq_cmd_t *cmd) {
+    x6100_control_vfo_att_set((x6100_vfo_t) cmd->arg, cmd->val.i);
+}
+
+static void cmd_vfo_pre(const ctlq_cmd_t *cmd) {
+    x6100_control_vfo_pre_set((x6100_vfo_t) cmd->arg, cmd->val.i);
+}
+
+static void cmd_mic(const ctlq_cmd_t *cmd) {
+    x6100_control_mic_set((x6100_mic_sel_t) cmd->val.i);
+}
+
+static void cmd_poweroff(const ctlq_cmd_t *cmd) {
+    x6100_control_poweroff();
+}
+
+static void control_stats() {
+    uint64_t now = get_time();
+
+    if (now - control_stats_time < CONTROL_STATS_PERIOD) {
+        return;
+    }
+
+    ctlq_stats_t stats;
+
+    ctlq_stats(control_queue, &stats);
+
+    if (stats.commands) {
+        LV_LOG_USER("Control bus: %u commands, %u coalesced, %u overflows, max pending %u/%u",
+                    stats.commands, stats.coalesced, stats.overflows, stats.max_pending, CONTROL_QUEUE_SIZE);
+        LV_LOG_USER("Control bus: exec avg %u us, max %u us; wait avg %u us, max %u us",
+                    stats.bus_avg, stats.bus_max, stats.wait_avg, stats.wait_max);
+    }
+    control_stats_time = now;
+}
+
 /**
  * Restore "listening" of main board and USB soundcard after ATU
  */
-static void recover_processing_audio_inputs() {
+static void cmd_recover_processing_audio_inputs(const ctlq_cmd_t *cmd) {
     usleep(10000);
     x6100_vfo_t vfo = subject_get_int(cfg_cur.band->vfo.val);
-    radio_lock();
     x6100_control_vfo_mode_set(vfo, x6100_mode_usb_dig);
     x6100_control_txpwr_set(0.1f);
     x6100_control_modem_set(true);
@@ -81,7 +232,144 @@ static void recover_processing_audio_inputs() {
     x6100_control_modem_set(false);
     x6100_control_txpwr_set(subject_get_float(cfg.pwr.val));
     x6100_control_vfo_mode_set(vfo, subject_get_int(cfg_cur.mode));
-    radio_unlock();
+}
+
+static uint64_t get_time_us() {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000L + now.tv_nsec / 1000L;
+}
+
+static void latency_put(uint32_t *hist, uint64_t latency) {
+    uint8_t     i = 0;
+    uint64_t    edge = 250;
+
+    while ((i < FLOW_STATS_BUCKETS - 1) && (latency >= edge)) {
+        edge *= 2;
+        i++;
+    }
+    hist[i]++;
+}
+
+static void latency_log(const char *name, uint32_t *hist) {
+    LV_LOG_USER("%s (%s): <0.25ms %u, <0.5ms %u, <1ms %u, <2ms %u, <4ms %u, <8ms %u, <16ms %u, more %u",
+                name, flow_fd >= 0 ? "poll" : "sleep",
+                hist[0], hist[1], hist[2], hist[3], hist[4], hist[5], hist[6], hist[7]);
+    memset(hist, 0, sizeof(uint32_t) * FLOW_STATS_BUCKETS);
+}
+
+/**
+ * Histograms of delay before DSP processing. Flow latency starts when the data was ready
+ * (poll wakeup, or the sleep start without the flow device), so it includes the wait for
+ * the flow data. Ring latency starts when the packet was read, it is the DSP ring part only
+ */
+static void flow_latency_put(const dsp_packet_t *packet) {
+    uint64_t now_us = get_time_us();
+
+    latency_put(flow_latency, now_us - packet->ready);
+    latency_put(ring_latency, now_us - packet->arrival);
+
+    uint64_t now = get_time();
+
+    if (now - flow_stats_time > FLOW_STATS_PERIOD) {
+        uint32_t overruns, max_count;
+
+        spsc_ring_stats(dsp_ring, &overruns, &max_count);
+
+        latency_log("Flow latency", flow_latency);
+        latency_log("DSP ring latency", ring_latency);
+        LV_LOG_USER("DSP ring: overruns %u, max fill %u/%u", overruns, max_count, spsc_ring_capacity(dsp_ring));
+        flow_stats_time = now;
+    }
+}
+
+/**
+ * Recorded packets go to DSP instead of the flow. Flow packets are dropped
+ */
+static void dsp_replay() {
+    const iq_rec_packet_t *packet = iq_rec_replay_next();
+
+    spsc_ring_clear(dsp_ring);
+    while (sem_trywait(&dsp_sem) == 0) {}
+
+    if (packet) {
+        dsp_samples((cfloat *) packet->samples, RADIO_SAMPLES, packet->flags & IQ_REC_TX);
+    }
+}
+
+static void dsp_check_reset() {
+    if (__atomic_exchange_n(&dsp_reset_req, false, __ATOMIC_ACQ_REL)) {
+        spsc_ring_clear(dsp_ring);
+        dsp_reset();
+    }
+}
+
+static void * dsp_thread(void *arg) {
+    bool replay = false;
+
+    while (true) {
+        /* Before the replay, it does not wait for the semaphore */
+        dsp_check_reset();
+
+        if (iq_rec_replay_is_on()) {
+            if (!replay) {
+                replay = true;
+                dsp_reset();
+            }
+            dsp_replay();
+            continue;
+        } else if (replay) {
+            replay = false;
+            dsp_reset();
+        }
+
+        sem_wait(&dsp_sem);
+        dsp_check_reset();
+
+        dsp_packet_t *packet = spsc_ring_read_begin(dsp_ring);
+
+        if (!packet) {
+            continue;
+        }
+        flow_latency_put(packet);
+        dsp_samples(packet->samples, RADIO_SAMPLES, packet->tx);
+        spsc_ring_read_end(dsp_ring);
+    }
+}
+
+static void dsp_put_packet(cfloat *samples, bool tx, uint64_t ready, uint64_t arrival) {
+    iq_rec_put(samples, tx, arrival);
+
+    dsp_packet_t *packet = spsc_ring_write_begin(dsp_ring);
+
+    if (!packet) {
+        return;
+    }
+    packet->ready = ready;
+    packet->arrival = arrival;
+    packet->tx = tx;
+    memcpy(packet->samples, samples, sizeof(packet->samples));
+    spsc_ring_write_end(dsp_ring);
+    sem_post(&dsp_sem);
+}
+
+/**
+ * Wait for flow data and stamp the time it was ready. Packets read without the wait keep the stamp
+ */
+static void flow_wait() {
+    if (flow_fd < 0) {
+        /* Data comes somewhere during the sleep, the start is the worst case */
+        flow_ready = get_time_us();
+        usleep(FLOW_SLEEP);
+        return;
+    }
+
+    /* Bytes of a partial packet are already read, so poll sleeps until the rest comes */
+    struct pollfd fds = { .fd = flow_fd, .events = POLLIN };
+
+    poll(&fds, 1, FLOW_POLL_TIMEOUT);
+    flow_ready = get_time_us();
 }
 
 bool radio_tick() {
@@ -108,7 +396,8 @@ bool radio_tick() {
         //         *(float*)&pack->reserved_3[1],
         //         *(float*)&pack->reserved_3[2]);
         cfloat *samples = (cfloat*)((char *)pack + offsetof(x6100_flow_t, samples));
-        dsp_samples(samples, RADIO_SAMPLES, pack->flag.tx);
+
+        dsp_put_packet(samples, pack->flag.tx, flow_ready, get_time_us());
 
         switch (state) {
             case RADIO_RX:
@@ -133,7 +422,7 @@ bool radio_tick() {
                 break;
 
             case RADIO_ATU_START:
-                WITH_RADIO_LOCK(x6100_control_atu_tune(true));
+                control_put(cmd_bool, NULL, x6100_control_atu_tune, 0, true);
                 state = RADIO_ATU_WAIT;
                 break;
 
@@ -149,15 +438,15 @@ bool radio_tick() {
             case RADIO_ATU_RUN:
                 if (pack->flag.atu_status && !pack->flag.tx) {
                     cfg_atu_save_network(pack->atu_params);
-                    WITH_RADIO_LOCK(x6100_control_atu_tune(false));
+                    control_put(cmd_bool, NULL, x6100_control_atu_tune, 0, false);
                     subject_set_int(cfg.atu_enabled.val, true);
-                    recover_processing_audio_inputs();
+                    control_put(cmd_recover_processing_audio_inputs, NULL, NULL, 0, 0);
                     if (notify_rx_tx) {
                         notify_rx_tx(false);
                     }
 
                     // TODO: change with observer on atu->loaded change
-                    WITH_RADIO_LOCK(x6100_control_cmd(x6100_atu_network, pack->atu_params));
+                    control_put(cmd_control, NULL, NULL, x6100_atu_network, pack->atu_params);
                     state = RADIO_RX;
                 } else if (pack->flag.tx) {
                     tx_info_update(pack->tx_power * 0.1f, pack->vswr * 0.1f, pack->alc_level * 0.1f);
@@ -169,7 +458,7 @@ bool radio_tick() {
                 break;
 
             case RADIO_POWEROFF:
-                x6100_control_poweroff();
+                control_put(cmd_poweroff, NULL, NULL, 0, 0);
                 state = RADIO_OFF;
                 break;
 
@@ -183,7 +472,8 @@ bool radio_tick() {
             LV_LOG_WARN("Flow reset");
             prev_time = now_time;
             x6100_flow_restart();
-            dsp_reset();
+            __atomic_store_n(&dsp_reset_req, true, __ATOMIC_RELEASE);
+            sem_post(&dsp_sem);
         }
         return true;
     }
@@ -195,7 +485,7 @@ static void * radio_thread(void *arg) {
         now_time = get_time();
 
         if (radio_tick()) {
-            usleep(15000);
+            flow_wait();
         }
 
         int32_t idle = now_time - idle_time;
@@ -205,64 +495,54 @@ static void * radio_thread(void *arg) {
 
             idle_time = now_time;
         }
+
+        control_stats();
     }
 }
 
 static void on_change_int8(Subject *subj, void *user_data) {
-    int32_t new_val = subject_get_int(subj);
-    void (*fn)(int8_t) = (void (*)(int8_t))user_data;
-    WITH_RADIO_LOCK(fn(new_val));
+    control_put(cmd_int8, subj, user_data, 0, subject_get_int(subj));
 }
 
 static void on_change_uint8(Subject *subj, void *user_data) {
-    int32_t new_val = subject_get_int(subj);
-    void (*fn)(uint8_t) = (void (*)(uint8_t))user_data;
-    WITH_RADIO_LOCK(fn(new_val));
+    control_put(cmd_uint8, subj, user_data, 0, subject_get_int(subj));
 }
 
 static void on_change_uint16(Subject *subj, void *user_data) {
-    int32_t new_val = subject_get_int(subj);
-    void (*fn)(uint16_t) = (void (*)(uint16_t))user_data;
-    WITH_RADIO_LOCK(fn(new_val));
+    control_put(cmd_uint16, subj, user_data, 0, subject_get_int(subj));
 }
 
 static void on_change_uint32(Subject *subj, void *user_data) {
-    int32_t new_val = subject_get_int(subj);
-    void (*fn)(uint32_t) = (void (*)(uint32_t))user_data;
-    WITH_RADIO_LOCK(fn(new_val));
+    control_put(cmd_uint32, subj, user_data, 0, subject_get_int(subj));
 }
 
 static void on_change_int32(Subject *subj, void *user_data) {
-    int32_t new_val = subject_get_int(subj);
-    void (*fn)(int32_t) = (void (*)(int32_t))user_data;
-    WITH_RADIO_LOCK(fn(new_val));
+    control_put(cmd_int32, subj, user_data, 0, subject_get_int(subj));
 }
 
 static void on_change_float(Subject *subj, void *user_data) {
-    float new_val = subject_get_float(subj);
-    void (*fn)(float) = (void (*)(float))user_data;
-    WITH_RADIO_LOCK(fn(new_val));
+    control_put_float(cmd_float, subj, user_data, subject_get_float(subj));
 }
 
 static void on_vfo_freq_change(Subject *subj, void *user_data) {
     x6100_vfo_t vfo = (x6100_vfo_t )user_data;
     int32_t new_val = subject_get_int(subj);
     int32_t shift = cfg_transverter_get_shift(new_val);
-    WITH_RADIO_LOCK(x6100_control_vfo_freq_set(vfo, new_val - shift));
+    control_put(cmd_vfo_freq, subj, NULL, vfo, new_val - shift);
     LV_LOG_USER("Radio set vfo %i freq=%i (%i)", vfo, new_val, new_val - shift);
 }
 
 static void on_vfo_mode_change(Subject *subj, void *user_data) {
     x6100_vfo_t vfo = (x6100_vfo_t )user_data;
     int32_t new_val = subject_get_int(subj);
-    WITH_RADIO_LOCK(x6100_control_vfo_mode_set(vfo, new_val));
+    control_put(cmd_vfo_mode, subj, NULL, vfo, new_val);
     LV_LOG_USER("Radio set vfo %i mode=%i", vfo, new_val);;
 }
 
 static void on_vfo_agc_change(Subject *subj, void *user_data) {
     x6100_vfo_t vfo = (x6100_vfo_t )user_data;
     int32_t new_val = subject_get_int(subj);
-    WITH_RADIO_LOCK(x6100_control_vfo_agc_set(vfo, new_val));
+    control_put(cmd_vfo_agc, subj, NULL, vfo, new_val);
     LV_LOG_USER("Radio set vfo %i agc=%i", vfo, new_val);
 }
 
@@ -305,30 +585,40 @@ static void update_agc_time(Subject *subj, void *user_data) {
             }
             break;
     }
-    WITH_RADIO_LOCK(x6100_control_agc_time_set(agc_time));
+    control_put(cmd_uint16, cfg_cur.agc, x6100_control_agc_time_set, 0, agc_time);
     LV_LOG_USER("Radio set agc time=%u for agc: %i\n", agc_time, agc);
 }
 
 static void on_vfo_att_change(Subject *subj, void *user_data) {
     x6100_vfo_t vfo = (x6100_vfo_t )user_data;
     int32_t new_val = subject_get_int(subj);
-    WITH_RADIO_LOCK(x6100_control_vfo_att_set(vfo, new_val));
+    control_put(cmd_vfo_att, subj, NULL, vfo, new_val);
     LV_LOG_USER("Radio set vfo %i att=%i", vfo, new_val);
 }
 
 static void on_vfo_pre_change(Subject *subj, void *user_data) {
     x6100_vfo_t vfo = (x6100_vfo_t )user_data;
     int32_t new_val = subject_get_int(subj);
-    WITH_RADIO_LOCK(x6100_control_vfo_pre_set(vfo, new_val));
+    control_put(cmd_vfo_pre, subj, NULL, vfo, new_val);
     LV_LOG_USER("Radio set vfo %i pre=%i", vfo, new_val);
 }
 
 static void on_atu_network_change(Subject *subj, void *user_data) {
     uint32_t new_val = subject_get_int(subj);
-    WITH_RADIO_LOCK(x6100_control_cmd(x6100_atu_network, new_val));
+    control_put(cmd_control, subj, NULL, x6100_atu_network, new_val);
     LV_LOG_USER("Radio set atu network=%u", new_val);
 }
 
+static void cmd_low_filter(const ctlq_cmd_t *cmd) {
+    x6100_control_cmd(x6100_filter1_low, cmd->val.i);
+    x6100_control_cmd(x6100_filter2_low, cmd->val.i);
+}
+
+static void cmd_high_filter(const ctlq_cmd_t *cmd) {
+    x6100_control_cmd(x6100_filter1_high, cmd->val.i);
+    x6100_control_cmd(x6100_filter2_high, cmd->val.i);
+}
+
 static void on_low_filter_change(Subject *subj, void *user_data) {
     int32_t low = subject_get_int(subj);
     switch (subject_get_int(cfg_cur.mode)) {
@@ -337,59 +627,52 @@ static void on_low_filter_change(Subject *subj, void *user_data) {
             break;
 
         default:
-            radio_lock();
             LV_LOG_USER("Radio set filter_low=%i", low);
-            x6100_control_cmd(x6100_filter1_low, low);
-            x6100_control_cmd(x6100_filter2_low, low);
-            radio_unlock();
+            control_put(cmd_low_filter, cfg_cur.filter.low, NULL, 0, low);
             break;
     }
 }
 
 static void on_high_filter_change(Subject *subj, void *user_data) {
     int32_t high = subject_get_int(subj);
-    radio_lock();
     switch (subject_get_int(cfg_cur.mode)) {
         case x6100_mode_am:
         case x6100_mode_nfm:
             LV_LOG_USER("Radio set filter_low=%i", -high);
             LV_LOG_USER("Radio set filter_high=%i", high);
-            x6100_control_cmd(x6100_filter1_low, -high);
-            x6100_control_cmd(x6100_filter2_low, -high);
-            x6100_control_cmd(x6100_filter1_high, high);
-            x6100_control_cmd(x6100_filter2_high, high);
+            control_put(cmd_low_filter, cfg_cur.filter.low, NULL, 0, -high);
+            control_put(cmd_high_filter, cfg_cur.filter.high, NULL, 0, high);
             break;
 
         default:
             LV_LOG_USER("Radio set filter_high=%i", high);
-            x6100_control_cmd(x6100_filter1_high, high);
-            x6100_control_cmd(x6100_filter2_high, high);
+            control_put(cmd_high_filter, cfg_cur.filter.high, NULL, 0, high);
             break;
     }
-    radio_unlock();
 }
 
-void on_change_comp_ratio(Subject *subj, void *user_data) {
-    uint8_t ratio = subject_get_int(subj);
-    if (ratio < 1) {
-        ratio = 1;
-    }
-    if (ratio == 1) {
+static void cmd_comp_ratio(const ctlq_cmd_t *cmd) {
+    if (cmd->val.i == 1) {
         // invert
-        WITH_RADIO_LOCK(x6100_control_comp_set(true));
+        x6100_control_comp_set(true);
     } else {
-        radio_lock();
         x6100_control_comp_set(false);
-        x6100_control_comp_level_set((x6100_comp_level_t)(ratio - 2));
-        radio_unlock();
+        x6100_control_comp_level_set((x6100_comp_level_t)(cmd->val.i - 2));
     }
+}
 
+void on_change_comp_ratio(Subject *subj, void *user_data) {
+    uint8_t ratio = subject_get_int(subj);
+    if (ratio < 1) {
+        ratio = 1;
+    }
+    control_put(cmd_comp_ratio, subj, NULL, 0, ratio);
 }
 
 void base_control_command(Subject *subj, void *user_data) {
     uint32_t val = subject_get_int(subj);
     x6100_cmd_enum_t cmd = (x6100_cmd_enum_t)user_data;
-    WITH_RADIO_LOCK(x6100_control_cmd(cmd, val));
+    control_put(cmd_control, subj, NULL, cmd, val);
 }
 
 void radio_bb_reset() {
@@ -413,6 +696,18 @@ void radio_init() {
 
     pack = malloc(sizeof(x6100_flow_t));
 
+#ifndef X6100_SIM
+    /* Separate descriptor only for readiness notification, data is read by x6100_flow_read() */
+    flow_fd = open(FLOW_DEVICE, O_RDONLY | O_NONBLOCK | O_NOCTTY);
+    if (flow_fd < 0) {
+        LV_LOG_WARN("Can't open %s, flow polling with sleep", FLOW_DEVICE);
+    }
+#endif
+
+    pthread_mutex_init(&control_mux, NULL);
+    control_queue = ctlq_create(CONTROL_QUEUE_SIZE, radio_lock, radio_unlock);
+
+    /* Initial values are queued and sent below, before the queue thread is started */
     subject_add_observer_and_call(cfg_cur.band->vfo_a.freq.val, on_vfo_freq_change, (void*)X6100_VFO_A);
     subject_add_observer_and_call(cfg_cur.band->vfo_b.freq.val, on_vfo_freq_change, (void*)X6100_VFO_B);
 
@@ -477,6 +772,8 @@ void radio_init() {
     subject_add_observer_and_call(cfg.nr.val, on_change_uint8, x6100_control_nr_set);
     subject_add_observer_and_call(cfg.nr_level.val, on_change_uint8, x6100_control_nr_level_set);
 
+    ctlq_flush(control_queue);
+
     x6100_control_charger_set(params.charger.x == RADIO_CHARGER_ON);
     x6100_control_bias_drive_set(params.bias_drive);
     x6100_control_bias_final_set(params.bias_final);
@@ -497,13 +794,22 @@ void radio_init() {
 
     prev_time = get_time();
     idle_time = prev_time;
+    flow_stats_time = prev_time;
+    flow_ready = get_time_us();
+    control_stats_time = prev_time;
 
-    pthread_mutex_init(&control_mux, NULL);
+    dsp_ring = spsc_ring_create(sizeof(dsp_packet_t), DSP_RING_SIZE);
+    sem_init(&dsp_sem, 0, 0);
 
     pthread_t thread;
 
+    pthread_create(&thread, NULL, dsp_thread, NULL);
+    pthread_detach(thread);
+
     pthread_create(&thread, NULL, radio_thread, NULL);
     pthread_detach(thread);
+
+    ctlq_start(control_queue);
 }
 
 void radio_set_rx_tx_notify_fn(radio_rx_tx_change_t cb) {
@@ -525,7 +831,8 @@ void radio_set_freq(int32_t freq) {
     }
     x6100_vfo_t vfo = subject_get_int(cfg_cur.band->vfo.val);
     int32_t shift = cfg_transverter_get_shift(freq);
-    WITH_RADIO_LOCK(x6100_control_vfo_freq_set(vfo, freq - shift));
+    Subject *key = (vfo == X6100_VFO_A) ? cfg_cur.band->vfo_a.freq.val : cfg_cur.band->vfo_b.freq.val;
+    control_put(cmd_vfo_freq, key, NULL, vfo, freq - shift);
 }
 
 bool radio_check_freq(int32_t freq) {
@@ -554,7 +861,7 @@ uint16_t radio_change_vol(int16_t df) {
 
 void radio_change_mute() {
     mute = !mute;
-    x6100_control_rxvol_set(mute ? 0 : subject_get_int(cfg.vol.val));
+    control_put(cmd_uint8, cfg.vol.val, x6100_control_rxvol_set, 0, mute ? 0 : subject_get_int(cfg.vol.val));
 }
 
 uint16_t radio_change_moni(int16_t df) {
@@ -567,7 +874,7 @@ uint16_t radio_change_moni(int16_t df) {
         params_lock();
         params.moni = new_val;
         params_unlock(&params.dirty.moni);
-        WITH_RADIO_LOCK(x6100_control_cmd(x6100_monilevel, params.moni));
+        control_put(cmd_control, &params.moni, NULL, x6100_monilevel, params.moni);
         lv_msg_send(MSG_PARAM_CHANGED, NULL);
     }
 
@@ -582,7 +889,7 @@ bool radio_change_spmode(int16_t df) {
     params_bool_set(&params.spmode, df > 0);
     lv_msg_send(MSG_PARAM_CHANGED, NULL);
 
-    WITH_RADIO_LOCK(x6100_control_spmode_set(params.spmode.x));
+    control_put(cmd_bool, &params.spmode, x6100_control_spmode_set, 0, params.spmode.x);
 
     return params.spmode.x;
 }
@@ -593,16 +900,23 @@ void radio_start_atu() {
     }
 }
 
+static void cmd_swrscan(const ctlq_cmd_t *cmd) {
+    if (cmd->val.i) {
+        x6100_control_txpwr_set(5.0f);
+        x6100_control_swrscan_set(true);
+    } else {
+        x6100_control_swrscan_set(false);
+        x6100_control_txpwr_set(subject_get_float(cfg.pwr.val));
+    }
+}
+
 bool radio_start_swrscan() {
     if (state != RADIO_RX) {
         return false;
     }
 
     subject_set_int(cfg_cur.mode, x6100_mode_am);
-    radio_lock();
-    x6100_control_txpwr_set(5.0f);
-    x6100_control_swrscan_set(true);
-    radio_unlock();
+    control_put(cmd_swrscan, NULL, NULL, 0, true);
     state = RADIO_SWRSCAN;
 
     return true;
@@ -611,15 +925,12 @@ bool radio_start_swrscan() {
 void radio_stop_swrscan() {
     if (state == RADIO_SWRSCAN) {
         state = RADIO_RX;
-        radio_lock();
-        x6100_control_swrscan_set(false);
-        x6100_control_txpwr_set(subject_get_float(cfg.pwr.val));
-        radio_unlock();
+        control_put(cmd_swrscan, NULL, NULL, 0, false);
     }
 }
 
 void radio_set_pwr(float d) {
-    WITH_RADIO_LOCK(x6100_control_txpwr_set(d));
+    control_put_float(cmd_float, cfg.pwr.val, x6100_control_txpwr_set, d);
 }
 
 x6100_mic_sel_t radio_change_mic(int16_t d) {
@@ -646,7 +957,7 @@ x6100_mic_sel_t radio_change_mic(int16_t d) {
     params_unlock(&params.dirty.mic);
     lv_msg_send(MSG_PARAM_CHANGED, NULL);
 
-    WITH_RADIO_LOCK(x6100_control_mic_set(params.mic));
+    control_put(cmd_mic, &params.mic, NULL, 0, params.mic);
 
     return params.mic;
 }
@@ -683,23 +994,25 @@ x6100_vfo_t radio_toggle_vfo() {
 }
 
 void radio_poweroff() {
+    cfg_persist_flush();
+
     if (params.charger.x == RADIO_CHARGER_SHADOW) {
-        WITH_RADIO_LOCK(x6100_control_charger_set(true));
+        control_put(cmd_bool, NULL, x6100_control_charger_set, 0, true);
     }
 
     state = RADIO_POWEROFF;
 }
 
 void radio_set_charger(bool on) {
-    WITH_RADIO_LOCK(x6100_control_charger_set(on));
+    control_put(cmd_bool, NULL, x6100_control_charger_set, 0, on);
 }
 
 void radio_set_ptt(bool tx) {
-    WITH_RADIO_LOCK(x6100_control_ptt_set(tx));
+    control_put(cmd_bool, NULL, x6100_control_ptt_set, 0, tx);
 }
 
 void radio_set_modem(bool tx) {
-    WITH_RADIO_LOCK(x6100_control_modem_set(tx));
+    control_put(cmd_bool, NULL, x6100_control_modem_set, 0, tx);
 }
 
 void radio_set_line_in(uint8_t d) {
@@ -7,7 +7,12 @@
  */
 
 #include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
 #include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <sndfile.h>
 
 #include "audio.h"
@@ -15,30 +20,70 @@
 #include "recorder.h"
 #include "msg.h"
 #include "params/params.h"
+#include "ring/spsc.h"
+#include "iq_rec.h"
+
+#define CHUNK_SAMPLES   1024
+#define RING_SIZE       128     /* ~3 s of audio */
+#define WRITER_NICE     10
+
+typedef struct {
+    uint16_t    n;
+    int16_t     samples[CHUNK_SAMPLES];
+} chunk_t;
 
 char            *recorder_path = "/mnt/rec";
 
 static bool     on = false;
+static bool     iq = false;
 static SNDFILE  *file = NULL;
 
+/* Samples are encoded by writer thread, audio callback only copies them to the ring */
+static spsc_ring_t  *ring = NULL;
+static sem_t        ring_sem;
+static pthread_t    writer;
+static bool         writer_stop = false;
+static uint32_t     putting = 0;    /* Audio callbacks inside recorder_put_audio_samples() */
+
+static void make_filename(char *filename, size_t size, const char *ext) {
+    time_t      now = time(NULL);
+    struct tm   *t = localtime(&now);
+
+    snprintf(filename, size,
+        "%s/REC_%04i%02i%02i_%02i%02i%02i.%s",
+        recorder_path, t->tm_year + 1900, t->tm_mon + 1, t->tm_mday, t->tm_hour, t->tm_min, t->tm_sec, ext
+    );
+}
+
 static bool create_file() {
-    SF_INFO sfinfo;
+    SF_INFO     sfinfo;
+    const char  *ext;
 
     memset(&sfinfo, 0, sizeof(sfinfo));
 
     sfinfo.samplerate = AUDIO_CAPTURE_RATE;
     sfinfo.channels = 1;
-    sfinfo.format = SF_FORMAT_MPEG | SF_FORMAT_MPEG_LAYER_III;
 
-    char        filename[64];
-    time_t      now = time(NULL);
-    struct tm   *t = localtime(&now);
+    switch (params.rec_format.x) {
+        case RECORDER_FORMAT_WAV:
+            sfinfo.format = SF_FORMAT_WAV | SF_FORMAT_PCM_16;
+            ext = "wav";
+            break;
+
+        case RECORDER_FORMAT_FLAC:
+            sfinfo.format = SF_FORMAT_FLAC | SF_FORMAT_PCM_16;
+            ext = "flac";
+            break;
+
+        default:
+            sfinfo.format = SF_FORMAT_MPEG | SF_FORMAT_MPEG_LAYER_III;
+            ext = "mp3";
+            break;
+    }
 
-    snprintf(filename, sizeof(filename),
-        "%s/REC_%04i%02i%02i_%02i%02i%02i.mp3",
-        recorder_path, t->tm_year + 1900, t->tm_mon + 1, t->tm_mday, t->tm_hour, t->tm_min, t->tm_sec
-    );
+    char filename[64];
 
+    make_filename(filename, sizeof(filename), ext);
     file = sf_open(filename, SFM_WRITE, &sfinfo);
 
     if (file == NULL) {
@@ -47,34 +92,163 @@ static bool create_file() {
         return false;
     }
 
-    double q = 0.25;
-    sf_command(file, SFC_SET_VBR_ENCODING_QUALITY, &q, sizeof(q));
+    if (params.rec_format.x == RECORDER_FORMAT_MP3) {
+        double q = 0.25;
+        sf_command(file, SFC_SET_VBR_ENCODING_QUALITY, &q, sizeof(q));
+    }
 
     return true;
 }
 
+static void write_ring() {
+    chunk_t *chunk;
+
+    while ((chunk = spsc_ring_read_begin(ring)) != NULL) {
+        sf_write_short(file, chunk->samples, chunk->n);
+        spsc_ring_read_end(ring);
+    }
+}
+
+static void * writer_thread(void *arg) {
+    setpriority(PRIO_PROCESS, syscall(SYS_gettid), WRITER_NICE);
+
+    while (!__atomic_load_n(&writer_stop, __ATOMIC_ACQUIRE)) {
+        sem_wait(&ring_sem);
+        write_ring();
+    }
+
+    write_ring();
+    return NULL;
+}
+
+/* IQ is recorded from the flow thread by its own writer */
+static bool start_iq() {
+    char filename[64];
+
+    make_filename(filename, sizeof(filename), IQ_REC_EXT);
+
+    if (!iq_rec_start(filename)) {
+        return false;
+    }
+
+    iq = true;
+    __atomic_store_n(&on, true, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool start() {
+    if (params.rec_format.x == RECORDER_FORMAT_IQ) {
+        return start_iq();
+    }
+
+    if (!create_file()) {
+        return false;
+    }
+
+    if (ring == NULL) {
+        ring = spsc_ring_create(sizeof(chunk_t), RING_SIZE);
+        sem_init(&ring_sem, 0, 0);
+    }
+
+    uint32_t overruns, max_count;
+
+    spsc_ring_clear(ring);
+    spsc_ring_stats(ring, &overruns, &max_count);
+    while (sem_trywait(&ring_sem) == 0) {}
+
+    iq = false;
+    writer_stop = false;
+
+    if (pthread_create(&writer, NULL, writer_thread, NULL) != 0) {
+        LV_LOG_ERROR("Problem with create writer thread");
+        sf_close(file);
+        file = NULL;
+        return false;
+    }
+
+    __atomic_store_n(&on, true, __ATOMIC_RELEASE);
+    return true;
+}
+
+static void stop() {
+    uint32_t overruns, max_count;
+
+    __atomic_store_n(&on, false, __ATOMIC_SEQ_CST);
+
+    /* Callback could pass the check of on just before, wait until it leaves the ring */
+    while (__atomic_load_n(&putting, __ATOMIC_SEQ_CST)) {
+        usleep(100);
+    }
+
+    if (iq) {
+        overruns = iq_rec_stop();
+    } else {
+        __atomic_store_n(&writer_stop, true, __ATOMIC_RELEASE);
+        sem_post(&ring_sem);
+        pthread_join(writer, NULL);
+
+        sf_close(file);
+        file = NULL;
+
+        spsc_ring_stats(ring, &overruns, &max_count);
+        LV_LOG_USER("Recorder ring: overruns %u, max fill %u/%u", overruns, max_count, spsc_ring_capacity(ring));
+    }
+
+    if (overruns) {
+        msg_update_text_fmt("Recorder is off, %u chunks lost", overruns);
+    } else {
+        msg_update_text_fmt("Recorder is off");
+    }
+}
+
 void recorder_set_on(bool x) {
+    if (x == on) {
+        return;
+    }
+
     if (x) {
-        if (!create_file()) {
+        if (!start()) {
             msg_update_text_fmt("Problem with create file");
             return;
         } else {
             msg_update_text_fmt("Recorder is on");
         }
-        on = true;
     } else {
-        msg_update_text_fmt("Recorder is off");
-        on = false;
-        sf_close(file);
+        stop();
     }
 
     dialog_recorder_set_on(on);
 }
 
 bool recorder_is_on() {
-    return on;
+    return __atomic_load_n(&on, __ATOMIC_ACQUIRE);
 }
 
 void recorder_put_audio_samples(size_t nsamples, int16_t *samples) {
-    sf_write_short(file, samples, nsamples);
+    __atomic_add_fetch(&putting, 1, __ATOMIC_SEQ_CST);
+
+    if (!__atomic_load_n(&on, __ATOMIC_SEQ_CST) || iq) {
+        __atomic_sub_fetch(&putting, 1, __ATOMIC_SEQ_CST);
+        return;
+    }
+
+    while (nsamples > 0) {
+        chunk_t *chunk = spsc_ring_write_begin(ring);
+
+        if (!chunk) {
+            break;
+        }
+
+        size_t n = nsamples > CHUNK_SAMPLES ? CHUNK_SAMPLES : nsamples;
+
+        chunk->n = n;
+        memcpy(chunk->samples, samples, n * sizeof(int16_t));
+        spsc_ring_write_end(ring);
+
+        samples += n;
+        nsamples -= n;
+    }
+
+    sem_post(&ring_sem);
+    __atomic_sub_fetch(&putting, 1, __ATOMIC_SEQ_CST);
 }
@@ -0,0 +1,89 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#include "spectrum_render.h"
+
+static inline void vspan(const spectrum_canvas_t *c, lv_coord_t x, lv_coord_t y_a, lv_coord_t y_b, lv_color_t color) {
+    if ((x < c->clip.x1) || (x > c->clip.x2)) {
+        return;
+    }
+    if (y_a > y_b) {
+        lv_coord_t t = y_a;
+
+        y_a = y_b;
+        y_b = t;
+    }
+    if (y_a < c->clip.y1) {
+        y_a = c->clip.y1;
+    }
+    if (y_b > c->clip.y2) {
+        y_b = c->clip.y2;
+    }
+
+    lv_coord_t  stride = lv_area_get_width(&c->buf_area);
+    lv_color_t  *p = c->buf + (y_a - c->buf_area.y1) * stride + (x - c->buf_area.x1);
+
+    for (lv_coord_t y = y_a; y <= y_b; y++) {
+        *p = color;
+        p += stride;
+    }
+}
+
+/* Y of the segment a-b at column x, a.x < x <= b.x */
+static inline lv_coord_t seg_y(lv_point_t a, lv_point_t b, lv_coord_t x) {
+    return a.y + (int32_t) (b.y - a.y) * (x - a.x) / (b.x - a.x);
+}
+
+bool spectrum_canvas_init(spectrum_canvas_t *c, lv_draw_ctx_t *draw_ctx) {
+    c->buf = draw_ctx->buf;
+    c->buf_area = *draw_ctx->buf_area;
+
+    return c->buf && _lv_area_intersect(&c->clip, draw_ctx->clip_area, draw_ctx->buf_area);
+}
+
+void spectrum_render_outline(const spectrum_canvas_t *c, lv_point_t start, const lv_point_t *pts, uint16_t n,
+                             lv_color_t color) {
+    lv_point_t prev = start;
+
+    for (uint16_t i = 0; i < n; i++) {
+        lv_point_t cur = pts[i];
+
+        if (cur.x <= prev.x) {
+            vspan(c, cur.x, prev.y, cur.y, color);
+        } else {
+            lv_coord_t y_prev = prev.y;
+
+            for (lv_coord_t x = prev.x + 1; x <= cur.x; x++) {
+                lv_coord_t y = seg_y(prev, cur, x);
+
+                vspan(c, x, y_prev, y, color);
+                y_prev = y;
+            }
+        }
+        prev = cur;
+    }
+}
+
+void spectrum_render_filled(const spectrum_canvas_t *c, const lv_point_t *pts, uint16_t n, lv_coord_t bottom,
+                            lv_color_t color) {
+    for (uint16_t i = 0; i < n; i++) {
+        lv_point_t cur = pts[i];
+
+        /* Columns between bins are filled up to the interpolated level */
+        if ((i > 0) && (cur.x > pts[i - 1].x + 1)) {
+            for (lv_coord_t x = pts[i - 1].x + 1; x < cur.x; x++) {
+                lv_coord_t y = seg_y(pts[i - 1], cur, x);
+
+                if (y <= bottom) {
+                    vspan(c, x, y, bottom, color);
+                }
+            }
+        }
+        if (cur.y <= bottom) {
+            vspan(c, cur.x, cur.y, bottom, color);
+        }
+    }
+}
@@ -0,0 +1,40 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#pragma once
+
+#include "lvgl/lvgl.h"
+
+#include <stdint.h>
+
+/*
+ * Spectrum traces rasterized straight into the draw buffer as vertical
+ * spans, one span per screen column, instead of a lv_draw_line() per bin.
+ * Traces are opaque, 1 px wide and not antialiased.
+ */
+
+typedef struct {
+    lv_color_t  *buf;           /* Draw buffer */
+    lv_area_t   buf_area;       /* Screen area of the buffer */
+    lv_area_t   clip;           /* Screen area allowed to draw */
+} spectrum_canvas_t;
+
+/**
+ * Canvas for the current draw context. Returns false if nothing is visible
+ */
+bool spectrum_canvas_init(spectrum_canvas_t *c, lv_draw_ctx_t *draw_ctx);
+
+/**
+ * Polyline through points, starting from `start`. Points are in screen coords, x should not decrease
+ */
+void spectrum_render_outline(const spectrum_canvas_t *c, lv_point_t start, const lv_point_t *pts, uint16_t n,
+                             lv_color_t color);
+
+/**
+ * Area between polyline through points and `bottom` line
+ */
+void spectrum_render_filled(const spectrum_canvas_t *c, const lv_point_t *pts, uint16_t n, lv_coord_t bottom,
+                            lv_color_t color);
@@ -0,0 +1,157 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#include "wf_render.h"
+
+#include "../simd/simd.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static void update_columns_map(wf_render_t *r) {
+    for (uint16_t i = 0; i < r->width; i++) {
+        // Position on screen, center x is 0
+        float rel_screen_position = (((float) i + 0.5f) / r->width) - 0.5f;
+        float src_px = ((rel_screen_position / r->zoom) + 0.5f) * r->nfft + 0.5f;
+        r->x0_arr[i] = src_px;
+        r->x0_dist[i] = (src_px - r->x0_arr[i]) * 8;
+    }
+}
+
+/* Ring position of row with sequence number seq. Newer rows go up */
+static inline uint16_t row_idx(const wf_render_t *r, uint32_t seq) {
+    return (r->height - seq % r->height) % r->height;
+}
+
+static void colorize_row(wf_render_t *r, uint16_t idx) {
+    lv_color_t  *dst = r->rows + idx * r->width;
+    int32_t     src_x_offset = (int64_t) (r->freq_offsets[idx] - r->center_freq) * r->nfft / r->width_hz;
+
+    if ((src_x_offset > r->nfft) || (src_x_offset < -r->nfft)) {
+        memset(dst, 0, r->width * sizeof(lv_color_t));
+    } else {
+        const uint8_t   *src = r->cache + idx * r->nfft;
+        uint16_t        x_start = 0;
+        uint16_t        x_end = r->width;
+
+        /* Column map is monotonic, so visible source bins are one span */
+        while ((x_start < x_end) && ((int32_t) r->x0_arr[x_start] - src_x_offset < 0)) {
+            x_start++;
+        }
+        while ((x_end > x_start) && ((int32_t) r->x0_arr[x_end - 1] - src_x_offset >= r->nfft - 1)) {
+            x_end--;
+        }
+
+        lv_color_t black = lv_color_black();
+
+        for (uint16_t x = 0; x < x_start; x++) {
+            dst[x] = black;
+        }
+#if LV_COLOR_DEPTH == 32
+        simd_interp_lut(src, r->x0_arr + x_start, r->x0_dist + x_start, src_x_offset,
+                        (const uint32_t *) r->palette_lut, (uint32_t *) dst + x_start, x_end - x_start);
+#else
+        for (uint16_t x = x_start; x < x_end; x++) {
+            const uint8_t *y0_p = src + r->x0_arr[x] - src_x_offset;
+            uint8_t y = *y0_p + ((r->x0_dist[x] * (*(y0_p + 1) - *y0_p)) >> 3);
+            dst[x] = r->palette_lut[y];
+        }
+#endif
+        for (uint16_t x = x_end; x < r->width; x++) {
+            dst[x] = black;
+        }
+    }
+    memcpy(dst + r->height * r->width, dst, r->width * sizeof(lv_color_t));
+}
+
+wf_render_t * wf_render_create(uint16_t width, uint16_t height, uint16_t nfft, int32_t width_hz) {
+    wf_render_t *r = calloc(1, sizeof(wf_render_t));
+
+    r->width = width;
+    r->height = height;
+    r->nfft = nfft;
+    r->width_hz = width_hz;
+
+    r->cache = calloc(height, nfft);
+    r->freq_offsets = calloc(height, sizeof(*r->freq_offsets));
+    r->rows = calloc(2 * height * width, sizeof(lv_color_t));
+    r->x0_arr = malloc(width * sizeof(*r->x0_arr));
+    r->x0_dist = malloc(width * sizeof(*r->x0_dist));
+
+    r->zoom = 1;
+    r->dirty = true;
+    update_columns_map(r);
+
+    return r;
+}
+
+void wf_render_destroy(wf_render_t *r) {
+    free(r->cache);
+    free(r->freq_offsets);
+    free(r->rows);
+    free(r->x0_arr);
+    free(r->x0_dist);
+    free(r);
+}
+
+void wf_render_clear(wf_render_t *r, int32_t freq) {
+    memset(r->cache, 0, r->height * r->nfft);
+    for (uint16_t i = 0; i < r->height; i++) {
+        r->freq_offsets[i] = freq;
+    }
+    r->dirty = true;
+}
+
+uint8_t * wf_render_row_buf(wf_render_t *r) {
+    uint32_t seq = __atomic_load_n(&r->rows_written, __ATOMIC_RELAXED) + 1;
+
+    return r->cache + row_idx(r, seq) * r->nfft;
+}
+
+void wf_render_commit_row(wf_render_t *r, int32_t freq) {
+    uint32_t seq = __atomic_load_n(&r->rows_written, __ATOMIC_RELAXED) + 1;
+
+    r->freq_offsets[row_idx(r, seq)] = freq;
+    __atomic_store_n(&r->rows_written, seq, __ATOMIC_RELEASE);
+}
+
+void wf_render_set_view(wf_render_t *r, int32_t center_freq, uint8_t zoom, const uint32_t *palette) {
+    if (zoom != r->zoom) {
+        r->zoom = zoom;
+        update_columns_map(r);
+        r->dirty = true;
+    }
+    if (palette != r->palette) {
+        r->palette = palette;
+        for (uint16_t i = 0; i < 256; i++) {
+            r->palette_lut[i] = lv_color_hex(palette[i]);
+        }
+        r->dirty = true;
+    }
+    if (center_freq != r->center_freq) {
+        r->center_freq = center_freq;
+        r->dirty = true;
+    }
+}
+
+lv_color_t * wf_render_frame(wf_render_t *r) {
+    uint32_t written = __atomic_load_n(&r->rows_written, __ATOMIC_ACQUIRE);
+    uint32_t pending = written - r->rows_drawn;
+
+    if (r->dirty || pending >= r->height) {
+        for (uint16_t i = 0; i < r->height; i++) {
+            colorize_row(r, i);
+        }
+        r->dirty = false;
+    } else {
+        for (uint32_t seq = r->rows_drawn + 1; seq != written + 1; seq++) {
+            colorize_row(r, row_idx(r, seq));
+        }
+    }
+    r->rows_drawn = written;
+
+    return r->rows + row_idx(r, written) * r->width;
+}
@@ -0,0 +1,71 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#pragma once
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Waterfall image kept as a ring of already colorized rows.
+ *
+ * Ring has 2 * height rows and each row is written twice (at idx and
+ * idx + height), so the newest `height` rows are always one contiguous
+ * block, newest on top. Only the new rows are colorized on a refresh, the
+ * whole image is recomputed only when the view (center freq, zoom or
+ * palette) is changed.
+ */
+
+typedef struct {
+    uint16_t        width;          /* Screen columns */
+    uint16_t        height;         /* Rows */
+    uint16_t        nfft;           /* Source bins per row */
+    int32_t         width_hz;       /* Span of the source row */
+
+    uint8_t         *cache;         /* height * nfft palette indexes */
+    int32_t         *freq_offsets;  /* Center freq of each cached row */
+    lv_color_t      *rows;          /* 2 * height * width colorized rows */
+
+    uint32_t        rows_written;   /* Updated by producer */
+    uint32_t        rows_drawn;     /* Updated by renderer */
+
+    /* Current view */
+    int32_t         center_freq;
+    uint8_t         zoom;
+    const uint32_t  *palette;
+    lv_color_t      palette_lut[256];   /* Palette converted to screen colors */
+    bool            dirty;
+
+    /* Column map for the current zoom */
+    uint16_t        *x0_arr;        /* Closest left source bin */
+    uint8_t         *x0_dist;       /* Offset to the next bin, multiplied by 8 */
+} wf_render_t;
+
+wf_render_t * wf_render_create(uint16_t width, uint16_t height, uint16_t nfft, int32_t width_hz);
+void wf_render_destroy(wf_render_t *r);
+
+/**
+ * Fill the history with empty rows centered on freq
+ */
+void wf_render_clear(wf_render_t *r, int32_t freq);
+
+/**
+ * Get the cache row for the next data. Row is shown after wf_render_commit_row()
+ */
+uint8_t * wf_render_row_buf(wf_render_t *r);
+void wf_render_commit_row(wf_render_t *r, int32_t freq);
+
+/**
+ * Set view params. Changed view forces full recompute on the next frame
+ */
+void wf_render_set_view(wf_render_t *r, int32_t center_freq, uint8_t zoom, const uint32_t *palette);
+
+/**
+ * Colorize pending rows (or whole image) and return the top row of the image
+ */
+lv_color_t * wf_render_frame(wf_render_t *r);
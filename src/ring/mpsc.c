@@ -0,0 +1,152 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#include "mpsc.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_LINE 64
+
+/*
+ * Slot is free for position pos when seq == pos,
+ * holds the item of position pos when seq == pos + 1
+ */
+
+struct mpsc_ring_s {
+    uint8_t     *buf;
+    uint32_t    *seq;
+    size_t      item_size;
+    uint32_t    mask;
+
+    /* Producers side */
+    uint32_t    head __attribute__((aligned(CACHE_LINE)));
+    uint32_t    overruns;
+    uint32_t    max_count;
+
+    /* Consumer side */
+    uint32_t    tail __attribute__((aligned(CACHE_LINE)));
+};
+
+mpsc_ring_t * mpsc_ring_create(size_t item_size, uint32_t capacity) {
+    mpsc_ring_t *ring;
+    uint32_t    size = 1;
+
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    if (posix_memalign((void **) &ring, CACHE_LINE, sizeof(mpsc_ring_t))) {
+        return NULL;
+    }
+    memset(ring, 0, sizeof(mpsc_ring_t));
+
+    ring->item_size = item_size;
+    ring->mask = size - 1;
+    ring->buf = malloc(item_size * size);
+    ring->seq = malloc(sizeof(uint32_t) * size);
+
+    for (uint32_t i = 0; i < size; i++) {
+        ring->seq[i] = i;
+    }
+
+    return ring;
+}
+
+void mpsc_ring_destroy(mpsc_ring_t *ring) {
+    free(ring->seq);
+    free(ring->buf);
+    free(ring);
+}
+
+void * mpsc_ring_write_begin(mpsc_ring_t *ring) {
+    uint32_t pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    uint32_t index;
+
+    while (true) {
+        index = pos & ring->mask;
+
+        int32_t diff = (int32_t) (__atomic_load_n(&ring->seq[index], __ATOMIC_ACQUIRE) - pos);
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&ring->head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            __atomic_add_fetch(&ring->overruns, 1, __ATOMIC_RELAXED);
+            return NULL;
+        } else {
+            pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    uint32_t count = pos + 1 - __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    uint32_t max_count = __atomic_load_n(&ring->max_count, __ATOMIC_RELAXED);
+
+    while (count > max_count) {
+        if (__atomic_compare_exchange_n(&ring->max_count, &max_count, count, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    return ring->buf + index * ring->item_size;
+}
+
+void mpsc_ring_write_end(mpsc_ring_t *ring, void *slot) {
+    uint32_t index = ((uint8_t *) slot - ring->buf) / ring->item_size;
+
+    /* Only the owner of the claimed slot changes its sequence */
+    uint32_t seq = __atomic_load_n(&ring->seq[index], __ATOMIC_RELAXED);
+
+    __atomic_store_n(&ring->seq[index], seq + 1, __ATOMIC_RELEASE);
+}
+
+bool mpsc_ring_put(mpsc_ring_t *ring, const void *item) {
+    void *slot = mpsc_ring_write_begin(ring);
+
+    if (!slot) {
+        return false;
+    }
+    memcpy(slot, item, ring->item_size);
+    mpsc_ring_write_end(ring, slot);
+
+    return true;
+}
+
+void * mpsc_ring_read_begin(mpsc_ring_t *ring) {
+    uint32_t tail = ring->tail;
+    uint32_t index = tail & ring->mask;
+
+    if (__atomic_load_n(&ring->seq[index], __ATOMIC_ACQUIRE) != tail + 1) {
+        return NULL;
+    }
+
+    return ring->buf + index * ring->item_size;
+}
+
+void mpsc_ring_read_end(mpsc_ring_t *ring) {
+    uint32_t tail = ring->tail;
+
+    __atomic_store_n(&ring->seq[tail & ring->mask], tail + ring->mask + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+uint32_t mpsc_ring_count(mpsc_ring_t *ring) {
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+uint32_t mpsc_ring_capacity(mpsc_ring_t *ring) {
+    return ring->mask + 1;
+}
+
+void mpsc_ring_stats(mpsc_ring_t *ring, uint32_t *overruns, uint32_t *max_count) {
+    if (overruns) {
+        *overruns = __atomic_exchange_n(&ring->overruns, 0, __ATOMIC_RELAXED);
+    }
+    if (max_count) {
+        *max_count = __atomic_exchange_n(&ring->max_count, 0, __ATOMIC_RELAXED);
+    }
+}
@@ -0,0 +1,56 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Lock-free bounded multi producer / single consumer ring of fixed size items.
+ *
+ * Every slot has a sequence number: producers claim slots with CAS on the head
+ * and publish them by the sequence, so the consumer sees only complete items.
+ * Producer never waits, a full ring returns NULL and counts an overrun.
+ */
+
+typedef struct mpsc_ring_s mpsc_ring_t;
+
+/**
+ * Create ring. Capacity is rounded up to power of 2
+ */
+mpsc_ring_t * mpsc_ring_create(size_t item_size, uint32_t capacity);
+void mpsc_ring_destroy(mpsc_ring_t *ring);
+
+/**
+ * Claim slot for the next item or NULL if ring is full. Could be called from any thread
+ */
+void * mpsc_ring_write_begin(mpsc_ring_t *ring);
+
+/**
+ * Publish the slot got by mpsc_ring_write_begin()
+ */
+void mpsc_ring_write_end(mpsc_ring_t *ring, void *slot);
+
+/**
+ * Copy item to the ring
+ */
+bool mpsc_ring_put(mpsc_ring_t *ring, const void *item);
+
+/**
+ * Oldest published item or NULL. Consumer only
+ */
+void * mpsc_ring_read_begin(mpsc_ring_t *ring);
+void mpsc_ring_read_end(mpsc_ring_t *ring);
+
+uint32_t mpsc_ring_count(mpsc_ring_t *ring);
+uint32_t mpsc_ring_capacity(mpsc_ring_t *ring);
+
+/**
+ * Count of dropped items and max count of items in the ring since the last call
+ */
+void mpsc_ring_stats(mpsc_ring_t *ring, uint32_t *overruns, uint32_t *max_count);
@@ -0,0 +1,119 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#include "spsc.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_LINE 64
+
+struct spsc_ring_s {
+    uint8_t     *buf;
+    size_t      item_size;
+    uint32_t    mask;
+
+    /* Producer side */
+    uint32_t    head __attribute__((aligned(CACHE_LINE)));
+    uint32_t    overruns;
+    uint32_t    max_count;
+
+    /* Consumer side */
+    uint32_t    tail __attribute__((aligned(CACHE_LINE)));
+};
+
+spsc_ring_t * spsc_ring_create(size_t item_size, uint32_t capacity) {
+    spsc_ring_t *ring;
+    uint32_t    size = 1;
+
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    if (posix_memalign((void **) &ring, CACHE_LINE, sizeof(spsc_ring_t))) {
+        return NULL;
+    }
+    memset(ring, 0, sizeof(spsc_ring_t));
+
+    ring->item_size = item_size;
+    ring->mask = size - 1;
+    ring->buf = malloc(item_size * size);
+
+    return ring;
+}
+
+void spsc_ring_destroy(spsc_ring_t *ring) {
+    free(ring->buf);
+    free(ring);
+}
+
+void * spsc_ring_write_begin(spsc_ring_t *ring) {
+    uint32_t head = ring->head;
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    uint32_t count = head - tail;
+
+    if (count > ring->mask) {
+        __atomic_add_fetch(&ring->overruns, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    if (count + 1 > __atomic_load_n(&ring->max_count, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&ring->max_count, count + 1, __ATOMIC_RELAXED);
+    }
+
+    return ring->buf + (head & ring->mask) * ring->item_size;
+}
+
+void spsc_ring_write_end(spsc_ring_t *ring) {
+    __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+bool spsc_ring_put(spsc_ring_t *ring, const void *item) {
+    void *slot = spsc_ring_write_begin(ring);
+
+    if (!slot) {
+        return false;
+    }
+    memcpy(slot, item, ring->item_size);
+    spsc_ring_write_end(ring);
+
+    return true;
+}
+
+void * spsc_ring_read_begin(spsc_ring_t *ring) {
+    uint32_t tail = ring->tail;
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    if (head == tail) {
+        return NULL;
+    }
+
+    return ring->buf + (tail & ring->mask) * ring->item_size;
+}
+
+void spsc_ring_read_end(spsc_ring_t *ring) {
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+}
+
+void spsc_ring_clear(spsc_ring_t *ring) {
+    __atomic_store_n(&ring->tail, __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+}
+
+uint32_t spsc_ring_count(spsc_ring_t *ring) {
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+uint32_t spsc_ring_capacity(spsc_ring_t *ring) {
+    return ring->mask + 1;
+}
+
+void spsc_ring_stats(spsc_ring_t *ring, uint32_t *overruns, uint32_t *max_count) {
+    if (overruns) {
+        *overruns = __atomic_exchange_n(&ring->overruns, 0, __ATOMIC_RELAXED);
+    }
+    if (max_count) {
+        *max_count = __atomic_exchange_n(&ring->max_count, 0, __ATOMIC_RELAXED);
+    }
+}
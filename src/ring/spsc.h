@@ -0,0 +1,57 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Lock-free single producer / single consumer ring of fixed size items.
+ *
+ * Items are written and read in place: get a slot with *_begin(), fill or
+ * use it, then release with *_end(). Producer never waits, a full ring
+ * drops the item and counts an overrun.
+ */
+
+typedef struct spsc_ring_s spsc_ring_t;
+
+/**
+ * Create ring. Capacity is rounded up to power of 2
+ */
+spsc_ring_t * spsc_ring_create(size_t item_size, uint32_t capacity);
+void spsc_ring_destroy(spsc_ring_t *ring);
+
+/**
+ * Slot for the next item or NULL if ring is full
+ */
+void * spsc_ring_write_begin(spsc_ring_t *ring);
+void spsc_ring_write_end(spsc_ring_t *ring);
+
+/**
+ * Copy item to the ring
+ */
+bool spsc_ring_put(spsc_ring_t *ring, const void *item);
+
+/**
+ * Oldest item or NULL if ring is empty
+ */
+void * spsc_ring_read_begin(spsc_ring_t *ring);
+void spsc_ring_read_end(spsc_ring_t *ring);
+
+/**
+ * Drop all items. Call from consumer side
+ */
+void spsc_ring_clear(spsc_ring_t *ring);
+
+uint32_t spsc_ring_count(spsc_ring_t *ring);
+uint32_t spsc_ring_capacity(spsc_ring_t *ring);
+
+/**
+ * Count of dropped items and max count of items in the ring since the last call
+ */
+void spsc_ring_stats(spsc_ring_t *ring, uint32_t *overruns, uint32_t *max_count);
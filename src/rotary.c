@@ -9,7 +9,6 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <fcntl.h>
-#include <linux/input.h>
 
 #include "rotary.h"
 #include "keyboard.h"
@@ -20,26 +19,21 @@ static lv_indev_state_t prev_state;
 
 
 static void rotary_input_read(lv_indev_drv_t *drv, lv_indev_data_t *data) {
-    struct input_event  in;
     rotary_t            *rotary = (rotary_t*) drv->user_data;
     int32_t             diff = 0;
-    bool                send = false;
 
     if (remain_diff == 0) {
-        while (read(rotary->fd, &in, sizeof(struct input_event)) > 0) {
-            if (in.type == EV_REL) {
-                diff += in.value;
-                send = true;
-            }
-        }
+        float speed = 0.0f;
 
-        if (send) {
+        diff = input_take(rotary->input, &speed);
+
+        if (diff != 0) {
             backlight_tick();
 
             if (rotary->left[0] == 0 && rotary->right[0] == 0) {
-                int32_t *diff_copy = (int32_t *) malloc(sizeof(int32_t));
-                *diff_copy = diff;
-                lv_event_send(lv_scr_act(), EVENT_ROTARY, (void *) diff_copy);
+                event_rotary_t event = { .diff = diff, .speed = speed };
+
+                lv_event_send(lv_scr_act(), EVENT_ROTARY, (void *) &event);
             } else {
                 data->continue_reading = 1;
                 remain_diff = diff;
@@ -75,12 +69,13 @@ rotary_t * rotary_init(char *dev_name) {
         return NULL;
     }
 
-    fcntl(fd, F_SETFL, O_ASYNC | O_NONBLOCK);
+    fcntl(fd, F_SETFL, O_NONBLOCK);
 
     rotary_t *rotary = malloc(sizeof(rotary_t));
 
     memset(rotary, 0, sizeof(rotary_t));
     rotary->fd = fd;
+    rotary->input = input_add(fd);
 
     lv_indev_drv_init(&rotary->indev_drv);
 
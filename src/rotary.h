@@ -11,9 +11,11 @@
 #include <stdint.h>
 #include "lvgl/lvgl.h"
 #include "events.h"
+#include "input.h"
 
 typedef struct {
     int             fd;
+    input_dev_t     *input;
     uint16_t        left[3];
     uint16_t        right[3];
     uint8_t         mode;
@@ -8,53 +8,140 @@
 
 #include "scheduler.h"
 
-#include <queue>
-#include <mutex>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
 
 extern "C" {
     #include "lvgl/lvgl.h"
+    #include "ring/mpsc.h"
 }
 
-#define QUEUE_MAX_SIZE  64
+#define QUEUE_SIZE      64
+#define ARG_INLINE_SIZE 256
+#define COALESCE_SIZE   16
+
+/* Pending function without args */
+struct coalesce_t {
+    std::atomic<scheduler_fn_t> fn;
+    std::atomic<bool>           pending;
+};
 
 struct item_t {
-    scheduler_fn_t fn;
-    void    *arg;
+    scheduler_fn_t          fn;
+    void                    *arg;
+    coalesce_t              *coalesce;
+    alignas(8) uint8_t      data[ARG_INLINE_SIZE];
 };
 
-static std::queue<item_t> queue;
-static std::mutex m_mutex;
+static mpsc_ring_t              *queue = mpsc_ring_create(sizeof(item_t), QUEUE_SIZE);
+static coalesce_t               coalesce[COALESCE_SIZE];
 
-void scheduler_put(scheduler_fn_t fn, void * arg, size_t arg_size) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    if (queue.size() > QUEUE_MAX_SIZE){
-        LV_LOG_ERROR("Scheduler queue overflow");
-        return;
+static std::atomic<uint32_t>    stat_coalesced;
+static std::atomic<uint32_t>    stat_heap_args;
+
+/* Ring counters are reset on every read, they are kept here until scheduler_get_stats() with reset */
+static uint32_t                 stat_max_depth;
+static uint32_t                 stat_drops;
+
+static coalesce_t * find_coalesce(scheduler_fn_t fn) {
+    for (size_t i = 0; i < COALESCE_SIZE; i++) {
+        scheduler_fn_t cur = coalesce[i].fn.load(std::memory_order_acquire);
+
+        if (cur == nullptr && coalesce[i].fn.compare_exchange_strong(cur, fn)) {
+            return &coalesce[i];
+        }
+        /* cur is updated by failed exchange */
+        if (cur == fn) {
+            return &coalesce[i];
+        }
+    }
+    return nullptr;
+}
+
+static bool enqueue(scheduler_fn_t fn, void *arg, size_t arg_size, coalesce_t *c) {
+    item_t *item = (item_t *) mpsc_ring_write_begin(queue);
+
+    if (!item) {
+        return false;
+    }
+
+    item->fn = fn;
+    item->coalesce = c;
+    if (arg_size > ARG_INLINE_SIZE) {
+        item->arg = malloc(arg_size);
+        stat_heap_args++;
+    } else if (arg_size) {
+        item->arg = item->data;
+    } else {
+        item->arg = nullptr;
     }
-    void *arg_copy = nullptr;
     if (arg_size) {
-        arg_copy = malloc(arg_size);
-        memcpy(arg_copy, arg, arg_size);
+        memcpy(item->arg, arg, arg_size);
+    }
+    mpsc_ring_write_end(queue, item);
+
+    return true;
+}
+
+void scheduler_put(scheduler_fn_t fn, void * arg, size_t arg_size) {
+    if (!enqueue(fn, arg, arg_size, nullptr)) {
+        LV_LOG_ERROR("Scheduler queue overflow");
     }
-    item_t item = {fn, arg_copy};
-    queue.push(item);
 }
 
 void scheduler_put_noargs(scheduler_fn_t fn) {
-    return scheduler_put(fn, NULL, 0);
+    coalesce_t *c = find_coalesce(fn);
+
+    if (c && c->pending.exchange(true)) {
+        stat_coalesced++;
+        return;
+    }
+    if (!enqueue(fn, NULL, 0, c)) {
+        if (c) {
+            c->pending.store(false);
+        }
+        LV_LOG_ERROR("Scheduler queue overflow");
+    }
 }
 
 void scheduler_work() {
-    item_t item;
-    while (!queue.empty()) {
-        {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            item = queue.front();
-            queue.pop();
+    item_t *item;
+
+    while ((item = (item_t *) mpsc_ring_read_begin(queue)) != NULL) {
+        if (item->coalesce) {
+            /* New calls during execution should be scheduled again */
+            item->coalesce->pending.store(false);
         }
-        item.fn(item.arg);
-        if (item.arg) {
-            free(item.arg);
+        item->fn(item->arg);
+        if (item->arg && item->arg != item->data) {
+            free(item->arg);
         }
+        mpsc_ring_read_end(queue);
+    }
+}
+
+void scheduler_get_stats(scheduler_stats_t *stats, bool reset) {
+    uint32_t overruns, max_count;
+
+    mpsc_ring_stats(queue, &overruns, &max_count);
+
+    stat_drops += overruns;
+    if (max_count > stat_max_depth) {
+        stat_max_depth = max_count;
+    }
+
+    stats->depth = mpsc_ring_count(queue);
+    stats->max_depth = stat_max_depth;
+    stats->drops = stat_drops;
+
+    if (reset) {
+        stats->coalesced = stat_coalesced.exchange(0);
+        stats->heap_args = stat_heap_args.exchange(0);
+        stat_max_depth = 0;
+        stat_drops = 0;
+    } else {
+        stats->coalesced = stat_coalesced.load();
+        stats->heap_args = stat_heap_args.load();
     }
 }
@@ -8,22 +8,34 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 typedef void (* scheduler_fn_t)(void *);
 
+typedef struct {
+    uint32_t    depth;
+    uint32_t    max_depth;
+    uint32_t    drops;
+    uint32_t    coalesced;
+    uint32_t    heap_args;  /* Args bigger than inline slot storage */
+} scheduler_stats_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /**
- * Schedule execution function in main thread
+ * Schedule execution function in main thread. Could be called from any thread.
+ * Argument is copied, pointer passed to fn is valid only during the call
  */
 void scheduler_put(scheduler_fn_t fn, void *arg, size_t arg_size);
 
 
 /**
- * Schedule execution function without arguments in main thread
+ * Schedule execution function without arguments in main thread.
+ * Function already waiting for execution is not scheduled again
  */
 void scheduler_put_noargs(scheduler_fn_t fn);
 
@@ -32,6 +44,11 @@ void scheduler_put_noargs(scheduler_fn_t fn);
  */
 void scheduler_work();
 
+/**
+ * Get queue counters, optionally resetting them. Call from main thread
+ */
+void scheduler_get_stats(scheduler_stats_t *stats, bool reset);
+
 #ifdef __cplusplus
 }
 #endif
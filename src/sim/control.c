@@ -0,0 +1,194 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ *
+ *  Control calls of aether_x6100_control for the host simulator. Only the state
+ *  needed by the synthetic flow is kept, the rest is accepted and ignored.
+ *
+ *  The library headers are included, so the compiler checks these definitions
+ *  against the prototypes the GUI is built with.
+ */
+
+#include "state.h"
+
+#include <aether_radio/x6100_control/control.h>
+#include <aether_radio/x6100_control/low/flow.h>
+#include <aether_radio/x6100_control/low/gpio.h>
+
+#include <stdlib.h>
+#include <time.h>
+
+#define VFO_COUNT       2
+#define ATU_TUNE_TIME   1500    /* ms */
+#define PATCHED_REV     3       /* Latest base board firmware features */
+
+static uint32_t     vfo_freq[VFO_COUNT] = { 14074000, 14074000 };
+static uint32_t     vfo;
+static bool         ptt;
+static bool         modem;
+static uint32_t     txpwr;      /* 0.1 W */
+
+static bool         atu_tune;
+static uint64_t     atu_start;
+
+static uint64_t now_ms() {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/* State */
+
+uint32_t sim_state_freq() {
+    uint32_t x = __atomic_load_n(&vfo, __ATOMIC_RELAXED);
+
+    return __atomic_load_n(&vfo_freq[x % VFO_COUNT], __ATOMIC_RELAXED);
+}
+
+static bool atu_tuning(bool *done) {
+    if (!__atomic_load_n(&atu_tune, __ATOMIC_ACQUIRE)) {
+        *done = false;
+        return false;
+    }
+    *done = now_ms() - __atomic_load_n(&atu_start, __ATOMIC_RELAXED) > ATU_TUNE_TIME;
+    return !*done;
+}
+
+bool sim_state_tx() {
+    bool done;
+
+    return __atomic_load_n(&ptt, __ATOMIC_RELAXED) || __atomic_load_n(&modem, __ATOMIC_RELAXED) || atu_tuning(&done);
+}
+
+float sim_state_txpwr() {
+    return __atomic_load_n(&txpwr, __ATOMIC_RELAXED) * 0.1f;
+}
+
+bool sim_state_atu_done() {
+    bool done;
+
+    atu_tuning(&done);
+    return done;
+}
+
+/* Control */
+
+bool x6100_control_init() {
+    return true;
+}
+
+void x6100_control_idle() {
+}
+
+void x6100_control_poweroff() {
+    exit(0);
+}
+
+uint8_t x6100_control_get_patched_revision() {
+    return PATCHED_REV;
+}
+
+bool x6100_control_cmd(x6100_cmd_enum_t cmd, uint32_t arg) {
+    return true;
+}
+
+void x6100_control_vfo_freq_set(x6100_vfo_t x, uint32_t freq) {
+    __atomic_store_n(&vfo_freq[x % VFO_COUNT], freq, __ATOMIC_RELAXED);
+}
+
+void x6100_control_vfo_set(x6100_vfo_t x) {
+    __atomic_store_n(&vfo, x, __ATOMIC_RELAXED);
+}
+
+void x6100_control_ptt_set(bool on) {
+    __atomic_store_n(&ptt, on, __ATOMIC_RELAXED);
+}
+
+void x6100_control_modem_set(bool on) {
+    __atomic_store_n(&modem, on, __ATOMIC_RELAXED);
+}
+
+void x6100_control_txpwr_set(float pwr) {
+    __atomic_store_n(&txpwr, (uint32_t) (pwr * 10.0f + 0.5f), __ATOMIC_RELAXED);
+}
+
+void x6100_control_atu_tune(bool on) {
+    __atomic_store_n(&atu_start, now_ms(), __ATOMIC_RELAXED);
+    __atomic_store_n(&atu_tune, on, __ATOMIC_RELEASE);
+}
+
+void x6100_control_vfo_mode_set(x6100_vfo_t x, x6100_mode_t mode) {}
+void x6100_control_vfo_agc_set(x6100_vfo_t x, x6100_agc_t agc) {}
+void x6100_control_vfo_att_set(x6100_vfo_t x, x6100_att_t att) {}
+void x6100_control_vfo_pre_set(x6100_vfo_t x, x6100_pre_t pre) {}
+
+void x6100_control_split_set(uint8_t on) {}
+void x6100_control_rfg_set(uint8_t x) {}
+void x6100_control_rxvol_set(uint8_t x) {}
+void x6100_control_sql_set(uint8_t x) {}
+void x6100_control_atu_set(uint8_t on) {}
+void x6100_control_output_gain_set(float x) {}
+void x6100_control_charger_set(bool on) {}
+void x6100_control_bias_drive_set(uint16_t x) {}
+void x6100_control_bias_final_set(uint16_t x) {}
+void x6100_control_swrscan_set(bool on) {}
+void x6100_control_spmode_set(uint8_t x) {}
+void x6100_control_tx_i_offset_set(int32_t x) {}
+void x6100_control_tx_q_offset_set(int32_t x) {}
+
+void x6100_control_mic_set(x6100_mic_sel_t mic) {}
+void x6100_control_hmic_set(uint8_t level) {}
+void x6100_control_imic_set(uint8_t level) {}
+void x6100_control_record_set(bool on) {}
+void x6100_control_linein_set(uint8_t level) {}
+void x6100_control_lineout_set(uint8_t level) {}
+
+void x6100_control_comp_set(bool on) {}
+void x6100_control_comp_level_set(x6100_comp_level_t level) {}
+void x6100_control_comp_threshold_set(float x) {}
+void x6100_control_comp_makeup_set(float x) {}
+
+void x6100_control_vox_set(bool on) {}
+void x6100_control_vox_ag_set(uint8_t x) {}
+void x6100_control_vox_delay_set(uint16_t x) {}
+void x6100_control_vox_gain_set(uint8_t x) {}
+
+void x6100_control_key_tone_set(uint16_t x) {}
+void x6100_control_key_speed_set(uint8_t x) {}
+void x6100_control_key_mode_set(x6100_key_mode_t x) {}
+void x6100_control_iambic_mode_set(x6100_iambic_mode_t x) {}
+void x6100_control_key_vol_set(uint16_t x) {}
+void x6100_control_key_train_set(uint8_t on) {}
+void x6100_control_qsk_time_set(uint16_t x) {}
+void x6100_control_key_ratio_set(float x) {}
+
+void x6100_control_agc_time_set(uint16_t x) {}
+void x6100_control_agc_hang_set(uint8_t on) {}
+void x6100_control_agc_knee_set(int8_t x) {}
+void x6100_control_agc_slope_set(uint8_t x) {}
+
+void x6100_control_dnf_set(uint8_t on) {}
+void x6100_control_dnf_center_set(uint16_t x) {}
+void x6100_control_dnf_width_set(uint16_t x) {}
+void x6100_control_dnf_update_set(uint16_t on) {}
+void x6100_control_nb_set(uint8_t on) {}
+void x6100_control_nb_level_set(uint8_t x) {}
+void x6100_control_nb_width_set(uint8_t x) {}
+void x6100_control_nr_set(uint8_t on) {}
+void x6100_control_nr_level_set(uint8_t x) {}
+
+/* GPIO */
+
+bool x6100_gpio_init() {
+    return true;
+}
+
+void x6100_gpio_set(x6100_pin_t pin, int value) {}
+
+/* Flow restart has nothing to reset, packets are synthesized on read */
+
+bool x6100_flow_restart() {
+    return true;
+}
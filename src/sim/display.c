@@ -0,0 +1,130 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#include "display.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static lv_color_t   frame[SIM_DISPLAY_WIDTH * SIM_DISPLAY_HEIGHT];
+static uint32_t     frame_num;
+
+static const char   *frames_dir;
+static uint32_t     frames_every = 1;
+static FILE         *frames_log;
+
+static bool         deadline_set;
+static uint64_t     deadline_ms;
+
+static uint64_t now_ms() {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+void sim_display_init() {
+    const char *seconds = getenv("X6100_SIM_SECONDS");
+    const char *every = getenv("X6100_SIM_FRAMES_EVERY");
+
+    if (seconds) {
+        deadline_set = true;
+        deadline_ms = now_ms() + atof(seconds) * 1000;
+    }
+
+    if (every && atoi(every) > 0) {
+        frames_every = atoi(every);
+    }
+
+    frames_dir = getenv("X6100_SIM_FRAMES");
+
+    if (frames_dir) {
+        char path[512];
+
+        snprintf(path, sizeof(path), "%s/frames.txt", frames_dir);
+        frames_log = fopen(path, "w");
+
+        if (!frames_log) {
+            LV_LOG_ERROR("Can't create %s", path);
+            frames_dir = NULL;
+        }
+    }
+}
+
+/* FNV-1a of RGB, does not depend on the padding byte */
+static uint64_t frame_hash() {
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (size_t i = 0; i < SIM_DISPLAY_WIDTH * SIM_DISPLAY_HEIGHT; i++) {
+        uint8_t rgb[3] = { frame[i].ch.red, frame[i].ch.green, frame[i].ch.blue };
+
+        for (int k = 0; k < 3; k++) {
+            hash = (hash ^ rgb[k]) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+static void frame_dump() {
+    char path[512];
+
+    snprintf(path, sizeof(path), "%s/frame_%06u.ppm", frames_dir, frame_num);
+
+    FILE *f = fopen(path, "wb");
+
+    if (!f) {
+        LV_LOG_ERROR("Can't create %s", path);
+        return;
+    }
+
+    fprintf(f, "P6\n%d %d\n255\n", SIM_DISPLAY_WIDTH, SIM_DISPLAY_HEIGHT);
+
+    for (size_t i = 0; i < SIM_DISPLAY_WIDTH * SIM_DISPLAY_HEIGHT; i++) {
+        uint8_t rgb[3] = { frame[i].ch.red, frame[i].ch.green, frame[i].ch.blue };
+
+        fwrite(rgb, 1, sizeof(rgb), f);
+    }
+    fclose(f);
+}
+
+void sim_display_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
+    int32_t w = lv_area_get_width(area);
+
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        memcpy(&frame[y * SIM_DISPLAY_WIDTH + area->x1], color_p, w * sizeof(lv_color_t));
+        color_p += w;
+    }
+
+    if (lv_disp_flush_is_last(disp_drv)) {
+        if (frames_dir) {
+            fprintf(frames_log, "%06u %016llx\n", frame_num, (unsigned long long) frame_hash());
+            fflush(frames_log);
+
+            if (frame_num % frames_every == 0) {
+                frame_dump();
+            }
+        }
+        frame_num++;
+    }
+
+    lv_disp_flush_ready(disp_drv);
+}
+
+bool sim_running() {
+    return !deadline_set || now_ms() < deadline_ms;
+}
+
+char * sim_input_dev(int n) {
+    char name[32];
+    char *path;
+
+    snprintf(name, sizeof(name), "X6100_SIM_EVENT%i", n);
+    path = getenv(name);
+
+    return path ? path : "/dev/null";
+}
@@ -0,0 +1,35 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#pragma once
+
+#include "lvgl/lvgl.h"
+
+/*
+ * Offscreen display and inputs of the host simulator.
+ *
+ * Environment:
+ *   X6100_SIM_SECONDS      stop the main loop after this time
+ *   X6100_SIM_FRAMES       directory for frame dumps (PPM) and frames.txt with a hash per frame
+ *   X6100_SIM_FRAMES_EVERY dump every N-th frame, hashes are written for all
+ *   X6100_SIM_EVENT<n>     file or FIFO with struct input_event records instead of /dev/input/event<n>
+ */
+
+#define SIM_DISPLAY_WIDTH   800
+#define SIM_DISPLAY_HEIGHT  480
+
+void sim_display_init();
+void sim_display_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+
+/**
+ * False when the run time is over
+ */
+bool sim_running();
+
+/**
+ * Input device path for /dev/input/event<n>, /dev/null if it is not set
+ */
+char * sim_input_dev(int n);
@@ -0,0 +1,76 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ *
+ *  Flow packets for the host simulator, paced by the clock like the base board
+ */
+
+#include "gen.h"
+#include "state.h"
+
+#include "lvgl/lvgl.h"
+
+#include <aether_radio/x6100_control/low/flow.h>
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_LAG_NS      (1000 * 1000000LL)  /* Skip packets instead of catching up */
+#define PACK_SAMPLES    (sizeof(((x6100_flow_t *) NULL)->samples) / (sizeof(float complex)))
+
+static int64_t  next_ns;
+static int64_t  period_ns;
+
+static int64_t now_ns() {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+bool x6100_flow_init() {
+    const char *spec = getenv("X6100_SIM_IQ");
+
+    sim_gen_init(spec ? spec : SIM_GEN_DEFAULT);
+
+    period_ns = PACK_SAMPLES * 1000000000LL / SIM_GEN_RATE;
+    next_ns = now_ns();
+
+    LV_LOG_USER("Synthetic flow, %s", spec ? spec : SIM_GEN_DEFAULT);
+    return true;
+}
+
+bool x6100_flow_read(x6100_flow_t *pack) {
+    int64_t now = now_ns();
+
+    if (now < next_ns) {
+        return false;
+    }
+    if (now - next_ns > MAX_LAG_NS) {
+        LV_LOG_WARN("Flow is late for %lld ms", (long long) (now - next_ns) / 1000000);
+        next_ns = now;
+    }
+    next_ns += period_ns;
+
+    bool tx = sim_state_tx();
+
+    memset(pack, 0, sizeof(*pack));
+
+    pack->vext = 138;
+    pack->vbat = 82;
+    pack->batcap = 100;
+    pack->flag.vext = 1;
+    pack->flag.tx = tx;
+    pack->flag.atu_status = sim_state_atu_done();
+
+    if (tx) {
+        pack->tx_power = sim_state_txpwr() * 10.0f;
+        pack->vswr = 11;
+    }
+
+    sim_gen_fill((float complex *) ((char *) pack + offsetof(x6100_flow_t, samples)), PACK_SAMPLES, sim_state_freq());
+    return true;
+}
@@ -0,0 +1,353 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#include "gen.h"
+
+#include "lvgl/lvgl.h"
+#include "src/ft8/worker.h"
+
+#include <ctype.h>
+#include <ft8lib/constants.h>
+#include <liquid/liquid.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_SOURCES     16
+#define FIELDS          5
+
+#define CW_RAMP         0.005f  /* s, keying edges */
+#define CW_TEXT         "CQ CQ DE R1CBU R1CBU K"
+
+#define FT8_TEXT        "CQ R2RFE KO85"
+#define FT8_START       0.5     /* s, from the slot start */
+#define FT8_AUDIO       10000   /* Hz, synthesized above baseband for the Hilbert transform */
+#define FT8_WORKER_RATE 8000    /* Same as in dialog_ft8.c, only the encoder is used */
+
+typedef enum {
+    SOURCE_NOISE,
+    SOURCE_TONE,
+    SOURCE_CW,
+    SOURCE_FT8,
+    SOURCE_FILE,
+} source_type_t;
+
+typedef struct {
+    source_type_t   type;
+    int64_t         freq;
+    float           amp;
+    double          phase;
+
+    /* CW */
+    uint8_t         *keying;    /* One item per dot time */
+    size_t          keying_len;
+    size_t          dot_len;
+    size_t          pos;
+    float           env;
+
+    /* FT8 */
+    float complex   *wave;
+    size_t          wave_len;
+
+    /* File */
+    FILE            *file;
+} source_t;
+
+static source_t     sources[MAX_SOURCES];
+static size_t       sources_count;
+
+static uint64_t     clock_pos;  /* samples since init */
+static double       clock_start;
+static uint32_t     rng = 1;
+
+static const struct {
+    char        c;
+    const char  *code;
+} morse[] = {
+    { 'A', ".-" },    { 'B', "-..." },  { 'C', "-.-." },  { 'D', "-.." },   { 'E', "." },
+    { 'F', "..-." },  { 'G', "--." },   { 'H', "...." },  { 'I', ".." },    { 'J', ".---" },
+    { 'K', "-.-" },   { 'L', ".-.." },  { 'M', "--" },    { 'N', "-." },    { 'O', "---" },
+    { 'P', ".--." },  { 'Q', "--.-" },  { 'R', ".-." },   { 'S', "..." },   { 'T', "-" },
+    { 'U', "..-" },   { 'V', "...-" },  { 'W', ".--" },   { 'X', "-..-" },  { 'Y', "-.--" },
+    { 'Z', "--.." },  { '0', "-----" }, { '1', ".----" }, { '2', "..---" }, { '3', "...--" },
+    { '4', "....-" }, { '5', "....." }, { '6', "-...." }, { '7', "--..." }, { '8', "---.." },
+    { '9', "----." }, { '/', "-..-." }, { '?', "..--.." }, { '.', ".-.-.-" }, { ',', "--..--" },
+};
+
+/* Fixed seed, so runs with the same sources give the same noise */
+static float randn() {
+    float u[2];
+
+    for (int i = 0; i < 2; i++) {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        u[i] = (rng + 1.0f) / 4294967296.0f;
+    }
+    return sqrtf(-2.0f * logf(u[0])) * cosf(2.0f * M_PI * u[1]);
+}
+
+static const char * morse_code(char c) {
+    for (size_t i = 0; i < sizeof(morse) / sizeof(morse[0]); i++) {
+        if (morse[i].c == c) {
+            return morse[i].code;
+        }
+    }
+    return NULL;
+}
+
+static void keying_add(source_t *src, uint8_t on, size_t dots) {
+    src->keying = realloc(src->keying, src->keying_len + dots);
+    memset(src->keying + src->keying_len, on, dots);
+    src->keying_len += dots;
+}
+
+static bool cw_init(source_t *src, int wpm, const char *text) {
+    if (wpm <= 0) {
+        return false;
+    }
+    src->dot_len = SIM_GEN_RATE * 1.2f / wpm;
+
+    for (const char *c = text; *c; c++) {
+        if (*c == ' ') {
+            keying_add(src, 0, 4);  /* 7 with the letter gap */
+            continue;
+        }
+
+        const char *code = morse_code(toupper(*c));
+
+        if (!code) {
+            continue;
+        }
+        for (const char *e = code; *e; e++) {
+            keying_add(src, 1, *e == '.' ? 1 : 3);
+            keying_add(src, 0, 1);
+        }
+        keying_add(src, 0, 2);
+    }
+    keying_add(src, 0, 14);
+
+    return true;
+}
+
+static bool ft8_init(source_t *src, const char *text) {
+    int16_t     *tx;
+    uint32_t    n_tx;
+    bool        res;
+
+    /* Worker for the encoder only, FT8 dialog inits its own later */
+    ftx_worker_init(FT8_WORKER_RATE, FTX_PROTOCOL_FT8);
+    res = ftx_worker_generate_tx_samples(text, FT8_AUDIO, SIM_GEN_RATE, &tx, &n_tx);
+    ftx_worker_free();
+
+    if (!res) {
+        return false;
+    }
+
+    firhilbf hilb = firhilbf_create(15, 60.0f);
+
+    src->wave = malloc(n_tx * sizeof(float complex));
+    src->wave_len = n_tx;
+
+    for (uint32_t i = 0; i < n_tx; i++) {
+        float complex x;
+
+        firhilbf_r2c_execute(hilb, tx[i] / 32767.0f, &x);
+        src->wave[i] = x * cexpf(-I * 2.0f * M_PI * FT8_AUDIO * i / SIM_GEN_RATE);
+    }
+
+    firhilbf_destroy(hilb);
+    free(tx);
+    return true;
+}
+
+static bool source_parse(char *str) {
+    char    *field[FIELDS] = { 0 };
+    size_t  n = 0;
+
+    /* The last field is the rest of the string, text could have any chars */
+    field[n++] = str;
+
+    while (n < FIELDS && (str = strchr(str, ':'))) {
+        *str++ = 0;
+        field[n++] = str;
+    }
+
+    source_t src = { 0 };
+
+    if (strcmp(field[0], "noise") == 0 && n == 2) {
+        src.type = SOURCE_NOISE;
+        src.amp = powf(10.0f, atof(field[1]) / 20.0f) / sqrtf(2.0f);
+    } else if (strcmp(field[0], "tone") == 0 && n == 3) {
+        src.type = SOURCE_TONE;
+    } else if (strcmp(field[0], "cw") == 0 && n >= 3) {
+        src.type = SOURCE_CW;
+
+        if (!cw_init(&src, n > 3 ? atoi(field[3]) : 20, n > 4 ? field[4] : CW_TEXT)) {
+            return false;
+        }
+    } else if (strcmp(field[0], "ft8") == 0 && n >= 3) {
+        src.type = SOURCE_FT8;
+
+        if (!ft8_init(&src, n > 3 ? field[3] : FT8_TEXT)) {
+            return false;
+        }
+    } else if (strcmp(field[0], "file") == 0 && n == 2) {
+        src.type = SOURCE_FILE;
+        src.file = fopen(field[1], "rb");
+
+        if (!src.file) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+
+    if (src.type != SOURCE_NOISE && src.type != SOURCE_FILE) {
+        src.freq = atoll(field[1]);
+        src.amp = powf(10.0f, atof(field[2]) / 20.0f);
+    }
+
+    sources[sources_count++] = src;
+    return true;
+}
+
+void sim_gen_init(const char *spec) {
+    struct timespec now;
+    char            *list = strdup(spec);
+    char            *save;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    clock_start = now.tv_sec + now.tv_nsec * 1e-9;
+
+    for (char *item = strtok_r(list, ",", &save); item; item = strtok_r(NULL, ",", &save)) {
+        if (sources_count >= MAX_SOURCES) {
+            LV_LOG_WARN("Too many sources, %s is skipped", item);
+            continue;
+        }
+
+        char *copy = strdup(item);
+
+        if (!source_parse(item)) {
+            LV_LOG_WARN("Wrong IQ source %s", copy);
+        }
+        free(copy);
+    }
+    free(list);
+}
+
+/* Next sample of the carrier, signals out of the receiver band are not aliased */
+static float complex rotate(source_t *src, uint32_t center) {
+    int64_t offset = src->freq - (int64_t) center;
+
+    if (offset <= -SIM_GEN_RATE / 2 || offset >= SIM_GEN_RATE / 2) {
+        return 0.0f;
+    }
+
+    float complex x = cexpf(I * src->phase);
+
+    src->phase = remainder(src->phase + 2.0 * M_PI * offset / SIM_GEN_RATE, 2.0 * M_PI);
+    return x;
+}
+
+static void fill_cw(source_t *src, float complex *samples, size_t n, uint32_t center) {
+    float step = 1.0f / (CW_RAMP * SIM_GEN_RATE);
+
+    for (size_t i = 0; i < n; i++) {
+        uint8_t on = src->keying[src->pos / src->dot_len];
+
+        if (on && src->env < 1.0f) {
+            src->env = fminf(src->env + step, 1.0f);
+        } else if (!on && src->env > 0.0f) {
+            src->env = fmaxf(src->env - step, 0.0f);
+        }
+
+        float complex x = rotate(src, center);
+
+        if (src->env > 0.0f) {
+            samples[i] += x * src->amp * (0.5f - 0.5f * cosf(M_PI * src->env));
+        }
+        if (++src->pos >= src->keying_len * src->dot_len) {
+            src->pos = 0;
+        }
+    }
+}
+
+/* Aligned to the wall clock, so the decoder sees the signal in the right place of the slot */
+static void fill_ft8(source_t *src, float complex *samples, size_t n, uint32_t center) {
+    double  now = clock_start + (double) clock_pos / SIM_GEN_RATE;
+    int64_t slot_pos = (fmod(now, FT8_SLOT_TIME) - FT8_START) * SIM_GEN_RATE;
+
+    for (size_t i = 0; i < n; i++, slot_pos++) {
+        float complex x = rotate(src, center);
+
+        if (slot_pos >= 0 && (size_t) slot_pos < src->wave_len) {
+            samples[i] += src->wave[slot_pos] * x * src->amp;
+        }
+    }
+}
+
+static void fill_file(source_t *src, float complex *samples, size_t n) {
+    float complex   buf[n];
+    size_t          done = 0;
+    bool            rewound = false;
+
+    while (done < n) {
+        size_t res = fread(buf + done, sizeof(float complex), n - done, src->file);
+
+        if (res == 0) {
+            if (rewound) {
+                break;  /* Empty file */
+            }
+            rewind(src->file);
+            rewound = true;
+            continue;
+        }
+        rewound = false;
+        done += res;
+    }
+
+    for (size_t i = 0; i < done; i++) {
+        samples[i] += buf[i];
+    }
+}
+
+void sim_gen_fill(float complex *samples, size_t n, uint32_t center) {
+    memset(samples, 0, n * sizeof(float complex));
+
+    for (size_t s = 0; s < sources_count; s++) {
+        source_t *src = &sources[s];
+
+        switch (src->type) {
+            case SOURCE_NOISE:
+                for (size_t i = 0; i < n; i++) {
+                    samples[i] += (randn() + I * randn()) * src->amp;
+                }
+                break;
+
+            case SOURCE_TONE:
+                for (size_t i = 0; i < n; i++) {
+                    samples[i] += rotate(src, center) * src->amp;
+                }
+                break;
+
+            case SOURCE_CW:
+                fill_cw(src, samples, n, center);
+                break;
+
+            case SOURCE_FT8:
+                fill_ft8(src, samples, n, center);
+                break;
+
+            case SOURCE_FILE:
+                fill_file(src, samples, n);
+                break;
+        }
+    }
+    clock_pos += n;
+}
@@ -0,0 +1,39 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#pragma once
+
+#include <complex.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Synthetic IQ for the host simulator.
+ *
+ * Sources are described by a comma separated list, fields are separated by ':'.
+ * Frequencies are absolute, so signals move on the spectrum when VFO is tuned.
+ * Levels are dB relative to a full scale sample (noise level is per sample).
+ *
+ *   noise:<dB>
+ *   tone:<Hz>:<dB>
+ *   cw:<Hz>:<dB>[:<wpm>[:<text>]]
+ *   ft8:<Hz>:<dB>[:<text>]        lowest tone frequency, sent in every slot
+ *   file:<path>                   raw interleaved float32 IQ at SIM_GEN_RATE, looped
+ */
+
+#define SIM_GEN_RATE    100000
+#define SIM_GEN_DEFAULT "noise:-110,tone:7080000:-70,cw:7025000:-85:20,ft8:7075000:-95,ft8:7075600:-100:CQ R1CBU KO85"
+
+/**
+ * Parse the sources list. Unknown or broken entries are skipped with a warning
+ */
+void sim_gen_init(const char *spec);
+
+/**
+ * Fill the next n samples, center is the current receiver frequency
+ */
+void sim_gen_fill(float complex *samples, size_t n, uint32_t center);
@@ -0,0 +1,34 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Radio state kept by the control stubs for the synthetic flow
+ */
+
+/**
+ * Frequency of the receiving VFO, Hz
+ */
+uint32_t sim_state_freq();
+
+/**
+ * Transmitter is on: PTT, modem or ATU tuning
+ */
+bool sim_state_tx();
+
+/**
+ * Output power set by the GUI, W
+ */
+float sim_state_txpwr();
+
+/**
+ * ATU tuning is finished, cleared when the GUI stops tuning
+ */
+bool sim_state_atu_done();
@@ -0,0 +1,344 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#include "simd.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <float.h>
+
+#if defined(SIMD_USE_NEON)
+#include <arm_neon.h>
+#elif defined(SIMD_USE_SSE)
+#include <emmintrin.h>
+#endif
+
+/* 10 * log10(2) */
+#define DB_PER_OCTAVE   3.0102999566f
+
+/* log2(1 + t) = t * P(t), t in [0, 1) */
+#define LOG2_C0     1.442681468e+00f
+#define LOG2_C1     -7.203587727e-01f
+#define LOG2_C2     4.686588791e-01f
+#define LOG2_C3     -3.016380097e-01f
+#define LOG2_C4     1.444710957e-01f
+#define LOG2_C5     -3.382204597e-02f
+
+static inline float log2_approx(float x) {
+    union { float f; uint32_t i; } v = { .f = x < FLT_MIN ? FLT_MIN : x };
+
+    float e = (float) ((int32_t) (v.i >> 23) - 127);
+
+    v.i = (v.i & 0x007FFFFF) | 0x3F800000;
+
+    float t = v.f - 1.0f;
+    float p = LOG2_C5;
+
+    p = p * t + LOG2_C4;
+    p = p * t + LOG2_C3;
+    p = p * t + LOG2_C2;
+    p = p * t + LOG2_C1;
+    p = p * t + LOG2_C0;
+
+    return e + p * t;
+}
+
+static void clamp_scale(const float *x, float *out, float min, float scale, size_t n);
+
+static inline void interp_lut(const uint8_t *src, const uint16_t *idx, const uint8_t *frac, int32_t offset,
+                              const uint32_t *lut, uint32_t *out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t *p = src + (idx[i] - offset);
+        uint8_t       y = p[0] + ((frac[i] * (p[1] - p[0])) >> 3);
+
+        out[i] = lut[y];
+    }
+}
+
+#if defined(SIMD_USE_NEON)
+
+const char * simd_backend() {
+    return "neon";
+}
+
+void simd_power_cf(const float *x, float *out, size_t n) {
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        float32x4x2_t v = vld2q_f32(x + i * 2);
+        float32x4_t   p = vmulq_f32(v.val[0], v.val[0]);
+
+        p = vmlaq_f32(p, v.val[1], v.val[1]);
+        vst1q_f32(out + i, p);
+    }
+    for (; i < n; i++) {
+        out[i] = x[i * 2] * x[i * 2] + x[i * 2 + 1] * x[i * 2 + 1];
+    }
+}
+
+void simd_power_ema_cf(const float *x, float *psd, float gamma, float alpha, size_t n) {
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        float32x4x2_t v = vld2q_f32(x + i * 2);
+        float32x4_t   p = vmulq_f32(v.val[0], v.val[0]);
+
+        p = vmlaq_f32(p, v.val[1], v.val[1]);
+        p = vmulq_n_f32(p, alpha);
+        p = vmlaq_n_f32(p, vld1q_f32(psd + i), gamma);
+        vst1q_f32(psd + i, p);
+    }
+    for (; i < n; i++) {
+        float p = x[i * 2] * x[i * 2] + x[i * 2 + 1] * x[i * 2 + 1];
+
+        psd[i] = gamma * psd[i] + alpha * p;
+    }
+}
+
+static void clamp_scale(const float *x, float *out, float min, float scale, size_t n) {
+    float32x4_t vmin = vdupq_n_f32(min);
+    size_t      i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vmaxq_f32(vld1q_f32(x + i), vmin);
+
+        vst1q_f32(out + i, vmulq_n_f32(v, scale));
+    }
+    for (; i < n; i++) {
+        out[i] = (x[i] > min ? x[i] : min) * scale;
+    }
+}
+
+void simd_power_to_db(const float *x, float *out, float offset, size_t n) {
+    float32x4_t vmin = vdupq_n_f32(FLT_MIN);
+    float32x4_t voffset = vdupq_n_f32(offset);
+    size_t      i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        uint32x4_t  bits = vreinterpretq_u32_f32(vmaxq_f32(vld1q_f32(x + i), vmin));
+        int32x4_t   exp = vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vdupq_n_s32(127));
+        float32x4_t e = vcvtq_f32_s32(exp);
+
+        bits = vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007FFFFF)), vdupq_n_u32(0x3F800000));
+
+        float32x4_t t = vsubq_f32(vreinterpretq_f32_u32(bits), vdupq_n_f32(1.0f));
+        float32x4_t p = vdupq_n_f32(LOG2_C5);
+
+        p = vmlaq_f32(vdupq_n_f32(LOG2_C4), p, t);
+        p = vmlaq_f32(vdupq_n_f32(LOG2_C3), p, t);
+        p = vmlaq_f32(vdupq_n_f32(LOG2_C2), p, t);
+        p = vmlaq_f32(vdupq_n_f32(LOG2_C1), p, t);
+        p = vmlaq_f32(vdupq_n_f32(LOG2_C0), p, t);
+        p = vmlaq_f32(e, p, t);
+
+        vst1q_f32(out + i, vmlaq_n_f32(voffset, p, DB_PER_OCTAVE));
+    }
+    for (; i < n; i++) {
+        out[i] = DB_PER_OCTAVE * log2_approx(x[i]) + offset;
+    }
+}
+
+/* Gather pair of neighbour bins into lane k */
+#define GATHER_LANE(k) \
+    p = src + (idx[i + k] - offset); \
+    y0 = vld1_lane_u8(p, y0, k); \
+    y1 = vld1_lane_u8(p + 1, y1, k);
+
+void simd_interp_lut(const uint8_t *src, const uint16_t *idx, const uint8_t *frac, int32_t offset,
+                     const uint32_t *lut, uint32_t *out, size_t n) {
+    size_t  i = 0;
+    uint8_t y[8];
+
+    for (; i + 8 <= n; i += 8) {
+        const uint8_t   *p;
+        uint8x8_t       y0 = vdup_n_u8(0);
+        uint8x8_t       y1 = vdup_n_u8(0);
+
+        GATHER_LANE(0) GATHER_LANE(1) GATHER_LANE(2) GATHER_LANE(3)
+        GATHER_LANE(4) GATHER_LANE(5) GATHER_LANE(6) GATHER_LANE(7)
+
+        int16x8_t d = vreinterpretq_s16_u16(vsubl_u8(y1, y0));
+        int16x8_t f = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(frac + i)));
+
+        d = vshrq_n_s16(vmulq_s16(d, f), 3);
+        vst1_u8(y, vadd_u8(y0, vmovn_u16(vreinterpretq_u16_s16(d))));
+
+        for (int k = 0; k < 8; k++) {
+            out[i + k] = lut[y[k]];
+        }
+    }
+    interp_lut(src, idx + i, frac + i, offset, lut, out + i, n - i);
+}
+
+#undef GATHER_LANE
+
+#elif defined(SIMD_USE_SSE)
+
+const char * simd_backend() {
+    return "sse";
+}
+
+/* |x|^2 of 4 complex samples */
+static inline __m128 power4(const float *x) {
+    __m128 a = _mm_loadu_ps(x);
+    __m128 b = _mm_loadu_ps(x + 4);
+
+    a = _mm_mul_ps(a, a);
+    b = _mm_mul_ps(b, b);
+
+    __m128 re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+
+    return _mm_add_ps(re, im);
+}
+
+void simd_power_cf(const float *x, float *out, size_t n) {
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(out + i, power4(x + i * 2));
+    }
+    for (; i < n; i++) {
+        out[i] = x[i * 2] * x[i * 2] + x[i * 2 + 1] * x[i * 2 + 1];
+    }
+}
+
+void simd_power_ema_cf(const float *x, float *psd, float gamma, float alpha, size_t n) {
+    __m128 vgamma = _mm_set1_ps(gamma);
+    __m128 valpha = _mm_set1_ps(alpha);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128 p = _mm_mul_ps(power4(x + i * 2), valpha);
+
+        p = _mm_add_ps(p, _mm_mul_ps(_mm_loadu_ps(psd + i), vgamma));
+        _mm_storeu_ps(psd + i, p);
+    }
+    for (; i < n; i++) {
+        float p = x[i * 2] * x[i * 2] + x[i * 2 + 1] * x[i * 2 + 1];
+
+        psd[i] = gamma * psd[i] + alpha * p;
+    }
+}
+
+static void clamp_scale(const float *x, float *out, float min, float scale, size_t n) {
+    __m128 vmin = _mm_set1_ps(min);
+    __m128 vscale = _mm_set1_ps(scale);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_max_ps(_mm_loadu_ps(x + i), vmin);
+
+        _mm_storeu_ps(out + i, _mm_mul_ps(v, vscale));
+    }
+    for (; i < n; i++) {
+        out[i] = (x[i] > min ? x[i] : min) * scale;
+    }
+}
+
+void simd_power_to_db(const float *x, float *out, float offset, size_t n) {
+    __m128 vmin = _mm_set1_ps(FLT_MIN);
+    __m128 one = _mm_set1_ps(1.0f);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i bits = _mm_castps_si128(_mm_max_ps(_mm_loadu_ps(x + i), vmin));
+        __m128i exp = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+        __m128  e = _mm_cvtepi32_ps(exp);
+
+        bits = _mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000));
+
+        __m128 t = _mm_sub_ps(_mm_castsi128_ps(bits), one);
+        __m128 p = _mm_set1_ps(LOG2_C5);
+
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(LOG2_C4));
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(LOG2_C3));
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(LOG2_C2));
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(LOG2_C1));
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(LOG2_C0));
+        p = _mm_add_ps(_mm_mul_ps(p, t), e);
+
+        p = _mm_add_ps(_mm_mul_ps(p, _mm_set1_ps(DB_PER_OCTAVE)), _mm_set1_ps(offset));
+        _mm_storeu_ps(out + i, p);
+    }
+    for (; i < n; i++) {
+        out[i] = DB_PER_OCTAVE * log2_approx(x[i]) + offset;
+    }
+}
+
+void simd_interp_lut(const uint8_t *src, const uint16_t *idx, const uint8_t *frac, int32_t offset,
+                     const uint32_t *lut, uint32_t *out, size_t n) {
+    size_t  i = 0;
+    uint8_t y[16];
+
+    for (; i + 8 <= n; i += 8) {
+        const uint8_t *p[8];
+
+        for (int k = 0; k < 8; k++) {
+            p[k] = src + (idx[i + k] - offset);
+        }
+
+        __m128i y0 = _mm_setr_epi16(p[0][0], p[1][0], p[2][0], p[3][0], p[4][0], p[5][0], p[6][0], p[7][0]);
+        __m128i y1 = _mm_setr_epi16(p[0][1], p[1][1], p[2][1], p[3][1], p[4][1], p[5][1], p[6][1], p[7][1]);
+        __m128i f = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (frac + i)), _mm_setzero_si128());
+        __m128i d = _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(y1, y0), f), 3);
+        __m128i v = _mm_and_si128(_mm_add_epi16(y0, d), _mm_set1_epi16(0xFF));
+
+        _mm_storeu_si128((__m128i *) y, _mm_packus_epi16(v, v));
+
+        for (int k = 0; k < 8; k++) {
+            out[i + k] = lut[y[k]];
+        }
+    }
+    interp_lut(src, idx + i, frac + i, offset, lut, out + i, n - i);
+}
+
+#else
+
+const char * simd_backend() {
+    return "scalar";
+}
+
+void simd_interp_lut(const uint8_t *src, const uint16_t *idx, const uint8_t *frac, int32_t offset,
+                     const uint32_t *lut, uint32_t *out, size_t n) {
+    interp_lut(src, idx, frac, offset, lut, out, n);
+}
+
+void simd_power_cf(const float *x, float *out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = x[i * 2] * x[i * 2] + x[i * 2 + 1] * x[i * 2 + 1];
+    }
+}
+
+void simd_power_ema_cf(const float *x, float *psd, float gamma, float alpha, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        float p = x[i * 2] * x[i * 2] + x[i * 2 + 1] * x[i * 2 + 1];
+
+        psd[i] = gamma * psd[i] + alpha * p;
+    }
+}
+
+static void clamp_scale(const float *x, float *out, float min, float scale, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (x[i] > min ? x[i] : min) * scale;
+    }
+}
+
+void simd_power_to_db(const float *x, float *out, float offset, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = DB_PER_OCTAVE * log2_approx(x[i]) + offset;
+    }
+}
+
+#endif
+
+void simd_fftshift_clamp(const float *x, float *out, float min, float scale, size_t n) {
+    size_t n_2 = n / 2;
+
+    /* Shift is a swap of two contiguous halves */
+    clamp_scale(x + n_2, out, min, scale, n - n_2);
+    clamp_scale(x, out + n - n_2, min, scale, n_2);
+}
@@ -0,0 +1,74 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Vectorized kernels for the spectrum/waterfall periodograms.
+ *
+ * Backend is chosen at compile time: SIMD_USE_NEON, SIMD_USE_SSE or
+ * SIMD_USE_SCALAR. Without an explicit choice NEON is used on ARM, SSE2 on
+ * x86 and plain C elsewhere. All complex arrays are interleaved (re, im).
+ */
+
+#if !defined(SIMD_USE_NEON) && !defined(SIMD_USE_SSE) && !defined(SIMD_USE_SCALAR)
+#   if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#       define SIMD_USE_NEON
+#   elif defined(__SSE2__)
+#       define SIMD_USE_SSE
+#   else
+#       define SIMD_USE_SCALAR
+#   endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Name of the compiled backend
+ */
+const char * simd_backend();
+
+/**
+ * Power of complex samples: out[i] = |x[i]|^2
+ */
+void simd_power_cf(const float *x, float *out, size_t n);
+
+/**
+ * Exponential averaging of power: psd[i] = gamma * psd[i] + alpha * |x[i]|^2
+ */
+void simd_power_ema_cf(const float *x, float *psd, float gamma, float alpha, size_t n);
+
+/**
+ * FFT shift with lower limit and scale: out[i] = max(min, x[(i + n/2) % n]) * scale
+ */
+void simd_fftshift_clamp(const float *x, float *out, float min, float scale, size_t n);
+
+/**
+ * Power to dB with fast approximate log10: out[i] = 10 * log10(x[i]) + offset
+ *
+ * Max error is about 3e-5 dB, x should be positive
+ */
+void simd_power_to_db(const float *x, float *out, float offset, size_t n);
+
+/**
+ * Waterfall row: interpolate between neighbour bins and map through palette
+ *
+ * y = src[j] + ((frac[i] * (src[j + 1] - src[j])) >> 3), j = idx[i] - offset
+ * out[i] = lut[y]
+ *
+ * All j should be in [0, len(src) - 2]
+ */
+void simd_interp_lut(const uint8_t *src, const uint16_t *idx, const uint8_t *frac, int32_t offset,
+                     const uint32_t *lut, uint32_t *out, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
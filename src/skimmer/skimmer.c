@@ -0,0 +1,394 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#include "skimmer.h"
+#include "../cw_decoder.h"
+
+#include <complex.h>
+#include <ctype.h>
+#include <float.h>
+#include <liquid/liquid.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FILTER_LEN      4           /* Semi-length of the prototype filter, in symbols */
+#define FILTER_AS       60.0f
+#define LEVEL_BETA      0.7f        /* Fast enough for the key up in 1-2 samples */
+#define PEAK_DECAY      0.05f       /* dB per sample */
+#define PEAK_MARGIN     6.0f        /* dB, key down threshold below the peak of strong signal */
+#define NOISE_BETA      0.1f
+#define NOISE_WINDOW    1000.0      /* ms, noise floor is the minimum of the last two windows... */
+#define NOISE_BIAS      2.2f        /* ...and the mean is 3.4 dB above it for NOISE_BETA */
+#define NOISE_SETTLE    100.0       /* ms, floor is not yet smoothed */
+#define ACTIVATE_DB     6.0f        /* Over the key down threshold to take a decoder... */
+#define ACTIVATE_TIME   15.0f       /* ms, ...for longer than a noise spike */
+#define IDLE_TIMEOUT    15000.0     /* ms, the decoder is returned without the loud key down */
+#define FILL_BLOCKS     (FILTER_LEN * 4)    /* Delay line of the filter bank */
+
+typedef struct {
+    cw_decoder_t    *dec;           /* NULL for idle channel */
+    float           power;          /* Smoothed */
+    float           level;          /* dB */
+    float           peak;           /* dB */
+    float           floor;          /* Power smoothed for the noise windows */
+    float           min_cur;        /* Floor minimum of the current noise window */
+    float           min_prev;
+    bool            on;
+    float           loud_ms;        /* Time over the activation level */
+    double          last_loud;      /* ms */
+    uint16_t        wpm;            /* While loud, the noise keying after the signal spoils it */
+    char            word[SKIMMER_CALL_SIZE];
+    char            call[SKIMMER_CALL_SIZE];
+    char            text[SKIMMER_TEXT_SIZE];
+} channel_t;
+
+struct skimmer_s {
+    firpfbch2_crcf  bank;
+    uint16_t        channels;
+    float           ch_width;       /* Hz */
+    float           ch_ms;          /* Duration of the channel sample */
+
+    cfloat          *input;         /* channels / 2 */
+    uint16_t        input_count;
+    cfloat          *output;        /* channels */
+
+    uint16_t        first;          /* Bank channel of ch[1] */
+    uint16_t        count;          /* Decoded channels */
+    channel_t       *ch;            /* count + 2, edges are neighbours for the peak check only */
+
+    uint8_t         active;
+    uint8_t         max_decoders;
+
+    float           snr;
+    float           gist;
+    double          time_ms;
+    double          window_end;     /* ms */
+    uint32_t        blocks;
+};
+
+/* Prefix with a letter, digit, 1-4 letters suffix. Like R1CBU, 2E0ABC, but not 5NN */
+static bool is_call_part(const char *str, size_t len) {
+    int32_t digit = -1;
+    bool    letter = false;
+
+    if (len < 3 || len > 7) {
+        return false;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        if (!isalnum((unsigned char) str[i])) {
+            return false;
+        }
+        if (isdigit((unsigned char) str[i])) {
+            digit = i;
+        }
+    }
+
+    if (digit < 1 || len - digit - 1 < 1 || len - digit - 1 > 4) {
+        return false;
+    }
+
+    for (int32_t i = 0; i < digit; i++) {
+        if (isalpha((unsigned char) str[i])) {
+            letter = true;
+        }
+    }
+
+    return letter;
+}
+
+/* Callsign with optional portable parts, like K1ABC/P */
+static bool is_call(const char *word) {
+    const char *part = word;
+
+    while (true) {
+        const char *end = strchr(part, '/');
+        size_t      len = end ? (size_t) (end - part) : strlen(part);
+
+        if (is_call_part(part, len)) {
+            return true;
+        }
+        if (!end) {
+            return false;
+        }
+        part = end + 1;
+    }
+}
+
+static void append_text(channel_t *c, const char *text) {
+    size_t len = strlen(text);
+    size_t cur = strlen(c->text);
+
+    if (len >= SKIMMER_TEXT_SIZE) {
+        return;
+    }
+
+    if (cur + len >= SKIMMER_TEXT_SIZE) {
+        size_t shift = cur + len - (SKIMMER_TEXT_SIZE - 1);
+
+        memmove(c->text, c->text + shift, cur - shift + 1);
+        cur -= shift;
+    }
+
+    strcpy(c->text + cur, text);
+}
+
+static void text_cb(const char *text, void *user_data) {
+    channel_t *c = (channel_t *) user_data;
+
+    append_text(c, text);
+
+    if (strcmp(text, " ") == 0) {
+        if (is_call(c->word)) {
+            strcpy(c->call, c->word);
+        }
+        c->word[0] = '\0';
+    } else if (strlen(c->word) + strlen(text) < SKIMMER_CALL_SIZE) {
+        strcat(c->word, text);
+    } else {
+        /* Too long for the callsign, skip until the word end */
+        strcpy(c->word, "<");
+    }
+}
+
+static void channel_release(skimmer_t *s, channel_t *c) {
+    cw_decoder_destroy(c->dec);
+
+    c->dec = NULL;
+    c->wpm = 0;
+    c->word[0] = '\0';
+    c->call[0] = '\0';
+    c->text[0] = '\0';
+    s->active--;
+}
+
+static void channel_update(skimmer_t *s, channel_t *c) {
+    channel_t   *left = c - 1;
+    channel_t   *right = c + 1;
+    float       level = c->level;
+
+    /* Pauses between the characters are in every window, a carrier is the noise */
+    float noise = 10.0f * log10f(fminf(c->min_cur, c->min_prev) * NOISE_BIAS + 1e-20f);
+    float threshold = fmaxf(noise + s->snr, c->peak - PEAK_MARGIN);
+
+    if (c->on) {
+        if (level < threshold - s->gist) {
+            c->on = false;
+        }
+    } else if (level > threshold && level >= left->level && level >= right->level && !left->on && !right->on) {
+        /* Signal leaks into the neighbours, the one with the decoder keeps it */
+        if (c->dec || (!left->dec && !right->dec)) {
+            c->on = true;
+        }
+    }
+
+    if (c->on && level > noise + s->snr + ACTIVATE_DB) {
+        c->loud_ms += s->ch_ms;
+    } else {
+        c->loud_ms = 0.0f;
+    }
+
+    /* Noise in the decoded channel is keyed too, but it is never loud for long */
+    if (c->loud_ms >= ACTIVATE_TIME) {
+        c->last_loud = s->time_ms;
+    }
+
+    if (!c->dec) {
+        if (c->loud_ms < ACTIVATE_TIME || s->active >= s->max_decoders) {
+            return;
+        }
+        c->dec = cw_decoder_create(text_cb, c);
+        s->active++;
+    }
+
+    cw_decoder_signal(c->dec, c->on, s->ch_ms);
+
+    if (c->loud_ms >= ACTIVATE_TIME) {
+        c->wpm = cw_decoder_wpm(c->dec);
+    }
+
+    if (s->time_ms - c->last_loud > IDLE_TIMEOUT) {
+        channel_release(s, c);
+    }
+}
+
+static void process_block(skimmer_t *s) {
+    firpfbch2_crcf_execute(s->bank, s->input, s->output);
+
+    if (s->blocks < FILL_BLOCKS) {
+        s->blocks++;
+        return;
+    }
+
+    for (uint16_t i = 0; i < s->count + 2; i++) {
+        channel_t   *c = &s->ch[i];
+        cfloat      y = s->output[s->first - 1 + i];
+        float       power = crealf(y) * crealf(y) + cimagf(y) * cimagf(y);
+
+        if (s->time_ms > 0.0) {
+            c->power += (power - c->power) * LEVEL_BETA;
+            c->floor += (power - c->floor) * NOISE_BETA;
+        } else {
+            c->power = power;
+            c->floor = power;
+        }
+        c->level = 10.0f * log10f(c->power + 1e-20f);
+        c->peak = fmaxf(c->level, c->peak - PEAK_DECAY);
+
+        if (s->time_ms >= NOISE_SETTLE) {
+            c->min_cur = fminf(c->min_cur, c->floor);
+        }
+    }
+
+    s->time_ms += s->ch_ms;
+
+    /* First window is only for the noise floor */
+    if (s->time_ms >= NOISE_WINDOW) {
+        for (uint16_t i = 1; i <= s->count; i++) {
+            channel_update(s, &s->ch[i]);
+        }
+    }
+
+    if (s->time_ms >= s->window_end) {
+        for (uint16_t i = 0; i < s->count + 2; i++) {
+            s->ch[i].min_prev = s->ch[i].min_cur;
+            s->ch[i].min_cur = FLT_MAX;
+        }
+        s->window_end += NOISE_WINDOW;
+    }
+}
+
+skimmer_t * skimmer_create(uint32_t rate, uint16_t channels, uint16_t from, uint16_t to, uint8_t max_decoders) {
+    skimmer_t *s = calloc(1, sizeof(skimmer_t));
+
+    s->bank = firpfbch2_crcf_create_kaiser(LIQUID_ANALYZER, channels, FILTER_LEN, FILTER_AS);
+    s->channels = channels;
+    s->ch_width = (float) rate / channels;
+    s->ch_ms = 1000.0f * (channels / 2) / rate;
+
+    s->input = malloc(sizeof(cfloat) * channels / 2);
+    s->output = malloc(sizeof(cfloat) * channels);
+
+    /* Only positive freqs, the audio is analytic */
+    int32_t first = lroundf(from / s->ch_width);
+    int32_t last = lroundf(to / s->ch_width);
+
+    if (first < 1) {
+        first = 1;
+    }
+    if (last > channels / 2 - 2) {
+        last = channels / 2 - 2;
+    }
+    if (last < first) {
+        last = first;
+    }
+
+    s->first = first;
+    s->count = last - first + 1;
+    s->ch = calloc(s->count + 2, sizeof(channel_t));
+
+    for (uint16_t i = 0; i < s->count + 2; i++) {
+        s->ch[i].min_cur = FLT_MAX;
+        s->ch[i].min_prev = FLT_MAX;
+    }
+    s->max_decoders = max_decoders;
+    s->window_end = NOISE_WINDOW;
+
+    s->snr = 5.0f;
+    s->gist = 1.0f;
+
+    return s;
+}
+
+void skimmer_destroy(skimmer_t *s) {
+    for (uint16_t i = 1; i <= s->count; i++) {
+        if (s->ch[i].dec) {
+            cw_decoder_destroy(s->ch[i].dec);
+        }
+    }
+
+    firpfbch2_crcf_destroy(s->bank);
+    free(s->input);
+    free(s->output);
+    free(s->ch);
+    free(s);
+}
+
+void skimmer_set_snr(skimmer_t *s, float snr, float gist) {
+    s->snr = snr;
+    s->gist = gist;
+}
+
+void skimmer_put_audio_samples(skimmer_t *s, unsigned int n, cfloat *samples) {
+    uint16_t block = s->channels / 2;
+
+    while (n) {
+        uint16_t part = block - s->input_count;
+
+        if (part > n) {
+            part = n;
+        }
+
+        memcpy(&s->input[s->input_count], samples, sizeof(cfloat) * part);
+        s->input_count += part;
+        samples += part;
+        n -= part;
+
+        if (s->input_count == block) {
+            process_block(s);
+            s->input_count = 0;
+        }
+    }
+}
+
+static int compare_last_loud(const void *p1, const void *p2) {
+    const channel_t *c1 = *(const channel_t **) p1;
+    const channel_t *c2 = *(const channel_t **) p2;
+
+    return (c1->last_loud > c2->last_loud) ? -1 : (c1->last_loud < c2->last_loud);
+}
+
+static int compare_freq(const void *p1, const void *p2) {
+    const channel_t *c1 = *(const channel_t **) p1;
+    const channel_t *c2 = *(const channel_t **) p2;
+
+    return (c1 > c2) - (c1 < c2);
+}
+
+size_t skimmer_list(skimmer_t *s, skimmer_item_t *items, size_t max) {
+    channel_t   *heard[s->active + 1];
+    size_t      n = 0;
+
+    for (uint16_t i = 1; i <= s->count; i++) {
+        if (s->ch[i].dec) {
+            heard[n++] = &s->ch[i];
+        }
+    }
+
+    qsort(heard, n, sizeof(channel_t *), compare_last_loud);
+
+    if (n > max) {
+        n = max;
+    }
+
+    qsort(heard, n, sizeof(channel_t *), compare_freq);
+
+    for (size_t i = 0; i < n; i++) {
+        channel_t *c = heard[i];
+
+        items[i].freq = lroundf((s->first + (c - &s->ch[1])) * s->ch_width);
+        items[i].wpm = c->wpm;
+        strcpy(items[i].call, c->call);
+        strcpy(items[i].text, c->text);
+    }
+
+    return n;
+}
+
+uint8_t skimmer_active(skimmer_t *s) {
+    return s->active;
+}
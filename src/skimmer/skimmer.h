@@ -0,0 +1,66 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  Xiegu X6100 LVGL GUI
+ */
+
+#pragma once
+
+#include "../helpers.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * CW skimmer. The audio passband is split by the polyphase filter bank
+ * (2x oversampled, so a tone between two channels is not lost) into narrow
+ * channels. A channel with a keyed signal above own noise floor gets a CW
+ * decoder from the pool, the decoder is returned after the silence.
+ *
+ * Not thread safe, all calls should be from the audio thread
+ */
+
+#define SKIMMER_CALL_SIZE   16
+#define SKIMMER_TEXT_SIZE   32
+
+typedef struct skimmer_s skimmer_t;
+
+typedef struct {
+    uint16_t    freq;                       /* Hz, channel center */
+    uint16_t    wpm;
+    char        call[SKIMMER_CALL_SIZE];    /* Last decoded callsign or empty */
+    char        text[SKIMMER_TEXT_SIZE];    /* Tail of the decoded text */
+} skimmer_item_t;
+
+/**
+ * Channels between from and to Hz are decoded, channels is count of the filter
+ * bank channels over the whole rate (even). Not more than max_decoders are active
+ */
+skimmer_t * skimmer_create(uint32_t rate, uint16_t channels, uint16_t from, uint16_t to, uint8_t max_decoders);
+void skimmer_destroy(skimmer_t *s);
+
+/**
+ * Key down threshold over the noise floor and hysteresis of the key up, dB
+ */
+void skimmer_set_snr(skimmer_t *s, float snr, float gist);
+
+void skimmer_put_audio_samples(skimmer_t *s, unsigned int n, cfloat *samples);
+
+/**
+ * Recently heard channels, sorted by freq. Returns count of items
+ */
+size_t skimmer_list(skimmer_t *s, skimmer_item_t *items, size_t max);
+
+/**
+ * Channels with the decoder
+ */
+uint8_t skimmer_active(skimmer_t *s);
+
+#ifdef __cplusplus
+}
+#endif
@@ -19,6 +19,7 @@
 #include "scheduler.h"
 #include "styles.h"
 #include "util.h"
+#include "render/spectrum_render.h"
 
 #include <pthread.h>
 #include <stdlib.h>
@@ -46,6 +47,9 @@ static float   spectrum_buf[SPECTRUM_SIZE];
 static peak_t  spectrum_peak[SPECTRUM_SIZE];
 static uint8_t zoom_factor = 1;
 
+static lv_point_t main_points[SPECTRUM_SIZE];
+static lv_point_t peak_points[SPECTRUM_SIZE];
+
 static bool spectrum_tx = false;
 
 static int32_t filter_from = 0;
@@ -78,8 +82,7 @@ static void on_cur_freq_change(Subject *subj, void *user_data);
 static void spectrum_draw_cb(lv_event_t *e) {
     lv_obj_t          *obj      = lv_event_get_target(e);
     lv_draw_ctx_t     *draw_ctx = lv_event_get_draw_ctx(e);
-    lv_draw_line_dsc_t main_line_dsc;
-    lv_draw_line_dsc_t peak_line_dsc;
+    lv_color_t         trace_color = lv_color_hex(0x00B300);
 
     if (!spectrum_buf) {
         return;
@@ -93,18 +96,6 @@ static void spectrum_draw_cb(lv_event_t *e) {
         max = grid_max;
     }
 
-    /* Lines */
-
-    lv_draw_line_dsc_init(&main_line_dsc);
-
-    main_line_dsc.color = lv_color_hex(0x00B300);
-    main_line_dsc.width = 1;
-
-    lv_draw_line_dsc_init(&peak_line_dsc);
-
-    peak_line_dsc.color = lv_color_hex(0x555555);
-    peak_line_dsc.width = 1;
-
     lv_coord_t x1 = obj->coords.x1;
     lv_coord_t y1 = obj->coords.y1;
 
@@ -113,48 +104,36 @@ static void spectrum_draw_cb(lv_event_t *e) {
 
     x1 += lo_offset * zoom_factor * w / width_hz;
 
-    lv_point_t main_a, main_b;
-    lv_point_t peak_a, peak_b;
+    lv_point_t bottom_left = { .x = x1, .y = y1 + h };
+    bool       draw_peak = params.spectrum_peak.x && !spectrum_tx;
 
-    if (!params.spectrum_filled.x) {
-        main_b.x = x1;
-        main_b.y = y1 + h;
-    }
-
-    peak_b.x = x1;
-    peak_b.y = y1 + h;
+    /* Traces, rasterized directly into the draw buffer */
 
     for (uint16_t i = 0; i < SPECTRUM_SIZE; i++) {
-        float    v = (spectrum_buf[i] - min) / (max - min);
-        uint16_t x = i * w / SPECTRUM_SIZE;
+        float      v = (spectrum_buf[i] - min) / (max - min);
+        lv_coord_t x = x1 + i * w / SPECTRUM_SIZE;
 
-        /* Peak */
+        main_points[i].x = x;
+        main_points[i].y = y1 + (1.0f - v) * h;
 
-        if (params.spectrum_peak.x && !spectrum_tx) {
+        if (draw_peak) {
             float v_peak = (spectrum_peak[i].val - min) / (max - min);
 
-            peak_a.x = x1 + x;
-            peak_a.y = y1 + (1.0f - v_peak) * h;
-
-            lv_draw_line(draw_ctx, &peak_line_dsc, &peak_a, &peak_b);
-
-            peak_b = peak_a;
+            peak_points[i].x = x;
+            peak_points[i].y = y1 + (1.0f - v_peak) * h;
         }
+    }
 
-        /* Main */
-
-        main_a.x = x1 + x;
-        main_a.y = y1 + (1.0f - v) * h;
+    spectrum_canvas_t canvas;
 
-        if (params.spectrum_filled.x) {
-            main_b.x = main_a.x;
-            main_b.y = y1 + h;
+    if (spectrum_canvas_init(&canvas, draw_ctx)) {
+        if (draw_peak) {
+            spectrum_render_outline(&canvas, bottom_left, peak_points, SPECTRUM_SIZE, lv_color_hex(0x555555));
         }
-
-        lv_draw_line(draw_ctx, &main_line_dsc, &main_a, &main_b);
-
-        if (!params.spectrum_filled.x) {
-            main_b = main_a;
+        if (params.spectrum_filled.x) {
+            spectrum_render_filled(&canvas, main_points, SPECTRUM_SIZE, y1 + h, trace_color);
+        } else {
+            spectrum_render_outline(&canvas, bottom_left, main_points, SPECTRUM_SIZE, trace_color);
         }
     }
 
@@ -209,6 +188,17 @@ static void spectrum_draw_cb(lv_event_t *e) {
         lv_draw_rect(draw_ctx, &rect_dsc, &area);
     }
 
+    /* Visor lines */
+
+    lv_draw_line_dsc_t line_dsc;
+    lv_point_t         line_a = { .y = y1 + h - visor_height };
+    lv_point_t         line_b = { .y = y1 + h };
+
+    lv_draw_line_dsc_init(&line_dsc);
+
+    line_dsc.color = trace_color;
+    line_dsc.width = 1;
+
     if (rtty_get_state() != RTTY_OFF) {
         int32_t from, to;
 
@@ -218,34 +208,28 @@ static void spectrum_draw_cb(lv_event_t *e) {
         f1 = (int64_t)(w * from) / w_hz;
         f2 = (int64_t)(w * to) / w_hz;
 
-        main_a.x = x1 + w / 2 + f1;
-        main_a.y = y1 + h - visor_height;
-        main_b.x = main_a.x;
-        main_b.y = y1 + h;
-        lv_draw_line(draw_ctx, &main_line_dsc, &main_a, &main_b);
+        line_a.x = x1 + w / 2 + f1;
+        line_b.x = line_a.x;
+        lv_draw_line(draw_ctx, &line_dsc, &line_a, &line_b);
 
-        main_a.x = x1 + w / 2 + f2;
-        main_b.x = main_a.x;
-        lv_draw_line(draw_ctx, &main_line_dsc, &main_a, &main_b);
+        line_a.x = x1 + w / 2 + f2;
+        line_b.x = line_a.x;
+        lv_draw_line(draw_ctx, &line_dsc, &line_a, &line_b);
     }
 
     /* Center */
 
-    main_line_dsc.width = 1;
-
-    main_a.x = x1 + w / 2;
-    main_a.y = y1 + h - visor_height;
-    main_b.x = main_a.x;
-    main_b.y = y1 + h;
+    line_a.x = x1 + w / 2;
+    line_b.x = line_a.x;
 
     if (recorder_is_on()) {
-        main_line_dsc.color = lv_color_hex(0xFF0000);
+        line_dsc.color = lv_color_hex(0xFF0000);
     } else if (cur_mode == x6100_mode_cw || cur_mode == x6100_mode_cwr) {
         // Hide LO line on CW
-        main_line_dsc.opa = LV_OPA_0;
+        line_dsc.opa = LV_OPA_0;
     }
 
-    lv_draw_line(draw_ctx, &main_line_dsc, &main_a, &main_b);
+    lv_draw_line(draw_ctx, &line_dsc, &line_a, &line_b);
 }
 
 static void tx_cb(lv_event_t *e) {
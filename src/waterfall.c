@@ -18,6 +18,7 @@
 #include "util.h"
 #include "pubsub_ids.h"
 #include "scheduler.h"
+#include "render/wf_render.h"
 
 #include <stdlib.h>
 #include <math.h>
@@ -41,12 +42,10 @@ static int32_t          width_hz = 100000;
 static float            grid_min = DEFAULT_MIN;
 static float            grid_max = DEFAULT_MAX;
 
-static lv_img_dsc_t     *frame;
+static lv_img_dsc_t     frame;
 static uint8_t          delay = 0;
 
-static int32_t          *freq_offsets;
-static uint16_t         last_row_id;
-static uint8_t          *waterfall_cache;
+static wf_render_t      *render;
 
 static int32_t          radio_center_freq = 0;
 static int32_t          wf_center_freq = 0;
@@ -95,17 +94,12 @@ lv_obj_t * waterfall_init(lv_obj_t * parent) {
     return obj;
 }
 
-static void scroll_down() {
-    last_row_id = (last_row_id + 1) % height;
-}
-
 void waterfall_data(float *data_buf, uint16_t size, bool tx) {
     if (delay)
     {
         delay--;
         return;
     }
-    scroll_down();
 
     float min, max;
     if (tx) {
@@ -116,7 +110,7 @@ void waterfall_data(float *data_buf, uint16_t size, bool tx) {
         max = grid_max;
     }
 
-    freq_offsets[last_row_id] = radio_center_freq + lo_offset;
+    uint8_t *row = wf_render_row_buf(render);
 
     for (uint16_t x = 0; x < size; x++) {
         float       v = (data_buf[x] - min) / (max - min);
@@ -127,9 +121,9 @@ void waterfall_data(float *data_buf, uint16_t size, bool tx) {
             v = 1.0f;
         }
 
-        uint8_t id = v * 255;
-        waterfall_cache[last_row_id * size + x] = id;
+        row[x] = v * 255;
     }
+    wf_render_commit_row(render, radio_center_freq + lo_offset);
     scheduler_put_noargs(refresh_waterfall);
 }
 
@@ -154,19 +148,18 @@ void waterfall_set_height(lv_coord_t h) {
 
     height = lv_obj_get_height(obj);
 
-    frame = lv_img_buf_alloc(WIDTH, height, LV_IMG_CF_TRUE_COLOR);
+    render = wf_render_create(WIDTH, height, WATERFALL_NFFT, width_hz);
+    wf_render_clear(render, radio_center_freq);
+
+    frame.header.cf = LV_IMG_CF_TRUE_COLOR;
+    frame.header.w = WIDTH;
+    frame.header.h = height;
+    frame.data_size = WIDTH * height * PX_BYTES;
+    frame.data = (const uint8_t *) render->rows;
 
     img = lv_img_create(obj);
     lv_obj_align(img, LV_ALIGN_CENTER, 0, 0);
-    lv_img_set_src(img, frame);
-
-    freq_offsets = malloc(height * sizeof(*freq_offsets));
-    for (size_t i = 0; i < height; i++) {
-        freq_offsets[i] = radio_center_freq;
-    }
-    last_row_id = 0;
-    waterfall_cache = malloc(WATERFALL_NFFT * height);
-    memset(waterfall_cache, 0, WATERFALL_NFFT * height);
+    lv_img_set_src(img, &frame);
 
     lv_obj_add_event_cb(img, do_scroll_cb, LV_EVENT_DRAW_POST_END, NULL);
 
@@ -229,48 +222,16 @@ void waterfall_refresh_period_set(uint8_t k) {
 }
 
 static void redraw_cb(lv_event_t * e) {
-    int32_t src_x_offset;
-    uint16_t src_y, src_x0, dst_y, dst_x;
-
     uint8_t current_zoom = 1;
     if (params.waterfall_zoom.x) {
         current_zoom = zoom;
     }
 
-    lv_color_t black = lv_color_black();
-    lv_color_t px_color;
-
-    // Closest left id for screen pixel
-    uint16_t x0_arr[WIDTH];
-    // Actual point offset, multiplied by 8
-    uint8_t x0_dist[WIDTH];
-    for (uint16_t i = 0; i < WIDTH; i++) {
-        // Position on screen, center x is 0
-        float rel_screen_position = (((float) i + 0.5) / WIDTH) - 0.5f;
-        float src_px = ((rel_screen_position / current_zoom) + 0.5f) * WATERFALL_NFFT + 0.5f;
-        x0_arr[i] = src_px;
-        x0_dist[i] = (src_px - x0_arr[i]) * 8;
-    }
+    wf_render_set_view(render, wf_center_freq, current_zoom, wf_palette);
 
-    for (src_y = 0; src_y < height; src_y++) {
-        dst_y = ((height - src_y + last_row_id) % height);
-        src_x_offset = (freq_offsets[src_y] - wf_center_freq) * WATERFALL_NFFT / width_hz;
-        if ((src_x_offset > WATERFALL_NFFT) || (src_x_offset < -WATERFALL_NFFT)) {
-            memset((lv_color_t *)frame->data + dst_y * WIDTH, 0, WIDTH * PX_BYTES);
-        } else {
-            for (dst_x = 0; dst_x < WIDTH; dst_x++) {
-                src_x0 = x0_arr[dst_x] - src_x_offset;
-                if ((src_x0 < 0) || (src_x0 >= WATERFALL_NFFT - 1)) {
-                    px_color = black;
-                } else {
-                    uint8_t * y0_p = waterfall_cache + (src_y * WATERFALL_NFFT + src_x0);
-                    uint8_t y = *y0_p + ((x0_dist[dst_x] * (*(y0_p+1) - *y0_p)) >> 3);
-                    px_color = (lv_color_t)wf_palette[y];
-                }
-                *((lv_color_t*)frame->data + (dst_y * WIDTH + dst_x)) = px_color;
-            }
-        }
-    }
+    /* Rendered rows are contiguous, just move the image window */
+    frame.data = (const uint8_t *) wf_render_frame(render);
+    lv_img_cache_invalidate_src(&frame);
 }
 
 static void refresh_waterfall( void * arg) {
@@ -0,0 +1,129 @@
+extern "C" {
+    #include "../src/cfg/atu_index.h"
+}
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#define STEP 25000
+
+/* Same as the former linear scan over the rows, with the adjacent rows removed on save */
+struct Ref {
+    std::map<int32_t, std::map<int32_t, uint32_t>> ants;
+
+    void put(int32_t ant, int32_t freq, uint32_t network) {
+        auto &points = ants[ant];
+
+        for (auto it = points.begin(); it != points.end();) {
+            if (std::abs(it->first - freq) <= STEP) {
+                it = points.erase(it);
+            } else {
+                it++;
+            }
+        }
+        points[freq] = network;
+    }
+
+    bool find(int32_t ant, int32_t freq, uint32_t *network) {
+        int32_t min_diff = STEP + 1;
+        bool    found = false;
+
+        for (auto &p : ants[ant]) {
+            int32_t diff = std::abs(p.first - freq);
+
+            if (diff < min_diff) {
+                min_diff = diff;
+                *network = p.second;
+                found = true;
+            }
+        }
+        return found;
+    }
+};
+
+TEST_CASE("ATU index nearest point", "[atu_index]") {
+    atu_index_t *idx = atu_index_create();
+    uint32_t     network = 0;
+
+    REQUIRE_FALSE(atu_index_find(idx, 1, 7000000, STEP, &network));
+
+    atu_index_put(idx, 1, 7000000, 100, STEP);
+    atu_index_put(idx, 1, 7100000, 200, STEP);
+    atu_index_put(idx, 2, 7050000, 300, STEP);
+
+    REQUIRE(atu_index_find(idx, 1, 7010000, STEP, &network));
+    REQUIRE(network == 100);
+    REQUIRE(atu_index_find(idx, 1, 7090000, STEP, &network));
+    REQUIRE(network == 200);
+    REQUIRE_FALSE(atu_index_find(idx, 1, 7050000, STEP, &network));
+    REQUIRE(atu_index_find(idx, 2, 7050000, STEP, &network));
+    REQUIRE(network == 300);
+    REQUIRE_FALSE(atu_index_find(idx, 3, 7050000, STEP, &network));
+
+    /* Equal distance - lower freq */
+    atu_index_put(idx, 1, 7040000, 150, 0);
+    REQUIRE(atu_index_find(idx, 1, 7020000, STEP, &network));
+    REQUIRE(network == 100);
+
+    atu_index_destroy(idx);
+}
+
+TEST_CASE("ATU index replaces adjacent points", "[atu_index]") {
+    atu_index_t *idx = atu_index_create();
+    uint32_t     network = 0;
+
+    atu_index_put(idx, 1, 7000000, 1, STEP);
+    atu_index_put(idx, 1, 7030000, 2, STEP);
+    atu_index_put(idx, 1, 7060000, 3, STEP);
+    REQUIRE(atu_index_count(idx, 1) == 3);
+
+    atu_index_put(idx, 1, 7015000, 4, STEP);
+    REQUIRE(atu_index_count(idx, 1) == 2);
+    REQUIRE(atu_index_find(idx, 1, 7000000, STEP, &network));
+    REQUIRE(network == 4);
+
+    atu_index_put(idx, 1, 7060000, 5, STEP);
+    REQUIRE(atu_index_count(idx, 1) == 2);
+    REQUIRE(atu_index_find(idx, 1, 7060000, STEP, &network));
+    REQUIRE(network == 5);
+
+    atu_index_destroy(idx);
+}
+
+TEST_CASE("ATU index matches linear scan", "[atu_index]") {
+    atu_index_t *idx = atu_index_create();
+    Ref          ref;
+
+    srand(1);
+
+    for (int i = 0; i < 3000; i++) {
+        int32_t  ant = rand() % 3;
+        int32_t  freq = 1800000 + rand() % 28000000;
+        uint32_t network = rand();
+
+        atu_index_put(idx, ant, freq, network, STEP);
+        ref.put(ant, freq, network);
+    }
+
+    bool same = true;
+
+    for (int i = 0; i < 20000; i++) {
+        int32_t  ant = rand() % 4;
+        int32_t  freq = 1700000 + rand() % 28200000;
+        uint32_t a = 0, b = 0;
+        bool     found_a = atu_index_find(idx, ant, freq, STEP, &a);
+        bool     found_b = ref.find(ant, freq, &b);
+
+        same &= (found_a == found_b) && (a == b);
+    }
+    REQUIRE(same);
+
+    for (int32_t ant = 0; ant < 3; ant++) {
+        REQUIRE(atu_index_count(idx, ant) == ref.ants[ant].size());
+    }
+
+    atu_index_destroy(idx);
+}
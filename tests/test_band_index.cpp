@@ -0,0 +1,160 @@
+extern "C" {
+    #include "../src/cfg/band_index.h"
+}
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+#define kHz 1000
+#define MHz (1000 * kHz)
+
+static band_info_t bands[] = {
+    {1,   (char *) "160m",          1810000,   2000000,   1},
+    {3,   (char *) "40m CW",        7000000,   7040000,   1},
+    {4,   (char *) "40m SSB",       7040000,   7200000,   1},
+    {6,   (char *) "20m CW",        14000000,  14070000,  1},
+    {7,   (char *) "20m SSB",       14070000,  14350000,  1},
+    {8,   (char *) "17m",           18068000,  18168000,  1},
+    {100, (char *) "Broadcast 75m", 3900000,   4000000,   0},
+    {201, (char *) "CB A",          26055000,  26295000,  1},
+    {302, (char *) "70cm",          432000000, 438000000, 1},
+};
+
+#define BANDS_COUNT (sizeof(bands) / sizeof(bands[0]))
+
+/* Same as the former SQL queries */
+static int32_t ref_by_freq(const band_info_t *b, size_t n, uint32_t freq, uint32_t *start, uint32_t *stop) {
+    int32_t     id = -1;
+    uint32_t    prev_stop = 0, next_start = UINT32_MAX;
+
+    for (size_t i = 0; i < n; i++) {
+        if (b[i].active != 1) continue;
+
+        if (b[i].start_freq <= freq && freq <= b[i].stop_freq && b[i].id > id) {
+            id = b[i].id;
+            *start = b[i].start_freq;
+            *stop = b[i].stop_freq;
+        }
+        if (b[i].stop_freq < freq && b[i].stop_freq > prev_stop) prev_stop = b[i].stop_freq;
+        if (b[i].start_freq > freq && b[i].start_freq < next_start) next_start = b[i].start_freq;
+    }
+    if (id < 0) {
+        *start = prev_stop;
+        *stop = next_start;
+    }
+    return id;
+}
+
+static int32_t ref_next(const band_info_t *b, size_t n, uint32_t freq, bool up, int32_t cur_id) {
+    const band_info_t *res = NULL;
+
+    for (size_t i = 0; i < n; i++) {
+        if (b[i].active != 1 || b[i].id == cur_id) continue;
+
+        if (up && freq <= b[i].start_freq && (!res || b[i].start_freq < res->start_freq)) res = &b[i];
+        if (!up && freq >= b[i].stop_freq && (!res || b[i].start_freq > res->start_freq)) res = &b[i];
+    }
+    return res ? res->id : -1;
+}
+
+TEST_CASE("Band by pk", "[band_index]") {
+    band_index_t *idx = band_index_create(bands, BANDS_COUNT);
+
+    band_info_t *info = band_index_by_pk(idx, 7);
+    REQUIRE(info != NULL);
+    REQUIRE(info->start_freq == 14070 * kHz);
+    REQUIRE(info->stop_freq == 14350 * kHz);
+    REQUIRE(std::string(info->name) == "20m SSB");
+
+    REQUIRE(band_index_by_pk(idx, 100) != NULL);
+    REQUIRE(band_index_by_pk(idx, 2) == NULL);
+
+    band_index_destroy(idx);
+}
+
+TEST_CASE("Band by freq", "[band_index]") {
+    band_index_t *idx = band_index_create(bands, BANDS_COUNT);
+
+    REQUIRE(band_index_by_freq(idx, 14 * MHz - 1)->id == -1);
+    REQUIRE(band_index_by_freq(idx, 14 * MHz)->id == 6);
+    REQUIRE(band_index_by_freq(idx, 14070 * kHz - 1)->id == 6);
+    REQUIRE(band_index_by_freq(idx, 14070 * kHz)->id == 7);
+    REQUIRE(band_index_by_freq(idx, 14350 * kHz)->id == 7);
+
+    /* Broadcast bands are not active */
+    band_info_t *gap = band_index_by_freq(idx, 3950 * kHz);
+    REQUIRE(gap->id == -1);
+    REQUIRE(gap->start_freq == 2000000);
+    REQUIRE(gap->stop_freq == 7000000);
+
+    gap = band_index_by_freq(idx, 100 * kHz);
+    REQUIRE(gap->start_freq == 0);
+    REQUIRE(gap->stop_freq == 1810000);
+
+    gap = band_index_by_freq(idx, 500 * MHz);
+    REQUIRE(gap->start_freq == 438000000);
+    REQUIRE(gap->stop_freq == UINT32_MAX);
+
+    band_index_destroy(idx);
+}
+
+TEST_CASE("Next band", "[band_index]") {
+    band_index_t *idx = band_index_create(bands, BANDS_COUNT);
+
+    REQUIRE(band_index_next(idx, 14000 * kHz - 1, true, -1)->id == 6);
+    REQUIRE(band_index_next(idx, 14000 * kHz, true, 6)->id == 7);
+    REQUIRE(band_index_next(idx, 14070 * kHz, true, 7)->id == 8);
+    REQUIRE(band_index_next(idx, 600 * MHz, true, -1) == NULL);
+
+    REQUIRE(band_index_next(idx, 14350 * kHz + 1, false, -1)->id == 7);
+    REQUIRE(band_index_next(idx, 14350 * kHz, false, 7)->id == 6);
+    REQUIRE(band_index_next(idx, 14070 * kHz, false, 6)->id == 4);
+    REQUIRE(band_index_next(idx, 1000 * kHz, false, -1) == NULL);
+
+    band_index_destroy(idx);
+}
+
+TEST_CASE("Random bands match reference", "[band_index]") {
+    srand(1);
+
+    for (int round = 0; round < 50; round++) {
+        std::vector<band_info_t> b;
+        size_t n = 1 + rand() % 20;
+
+        for (size_t i = 0; i < n; i++) {
+            uint32_t start = (rand() % 1000) * 1000;
+            uint32_t len = (rand() % 200) * 1000;
+
+            b.push_back({(int32_t) (i * 3 + rand() % 3), NULL, start, start + len, rand() % 4 != 0});
+        }
+
+        band_index_t *idx = band_index_create(b.data(), b.size());
+
+        for (uint32_t freq = 0; freq < 1300000; freq += 500) {
+            uint32_t start, stop;
+            int32_t  id = ref_by_freq(b.data(), b.size(), freq, &start, &stop);
+            band_info_t *info = band_index_by_freq(idx, freq);
+
+            REQUIRE(info->id == id);
+            REQUIRE(info->start_freq == start);
+            REQUIRE(info->stop_freq == stop);
+
+            for (int up = 0; up < 2; up++) {
+                int32_t cur_id = rand() % 2 ? id : -1;
+                band_info_t *next = band_index_next(idx, freq, up, cur_id);
+                int32_t ref = ref_next(b.data(), b.size(), freq, up, cur_id);
+
+                if (ref < 0) {
+                    REQUIRE(next == NULL);
+                } else {
+                    REQUIRE(next != NULL);
+                    /* Bands with the same edge could go in any order */
+                    REQUIRE(next->start_freq == band_index_by_pk(idx, ref)->start_freq);
+                }
+            }
+        }
+        band_index_destroy(idx);
+    }
+}
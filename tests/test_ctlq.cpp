@@ -0,0 +1,141 @@
+extern "C" {
+    #include "../src/ctlq/ctlq.h"
+}
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static std::vector<int32_t> sent;
+static std::atomic<bool>    hold;
+
+static void record_fn(const ctlq_cmd_t *cmd) {
+    while (hold) {
+        std::this_thread::yield();
+    }
+    sent.push_back(cmd->val.i);
+}
+
+static ctlq_cmd_t cmd(uintptr_t key, int32_t val) {
+    ctlq_cmd_t c = {};
+
+    c.fn = record_fn;
+    c.key = key;
+    c.val.i = val;
+    return c;
+}
+
+TEST_CASE("Commands are coalesced by key and keep order", "[ctlq]") {
+    ctlq_t *q = ctlq_create(16, nullptr, nullptr);
+    sent.clear();
+
+    ctlq_cmd_t c;
+
+    c = cmd(1, 10);  ctlq_put(q, &c);
+    c = cmd(0, 20);  ctlq_put(q, &c);
+    c = cmd(2, 30);  ctlq_put(q, &c);
+    c = cmd(1, 11);  ctlq_put(q, &c);
+    c = cmd(1, 12);  ctlq_put(q, &c);
+    c = cmd(0, 21);  ctlq_put(q, &c);
+    c = cmd(0, 22);  ctlq_put(q, &c);
+
+    /* Not started - executed by flush */
+    ctlq_flush(q);
+    REQUIRE(sent == std::vector<int32_t>{20, 30, 12, 21, 22});
+
+    ctlq_stats_t stats;
+    ctlq_stats(q, &stats);
+    REQUIRE(stats.coalesced == 2);
+    REQUIRE(stats.max_pending == 5);
+    REQUIRE(stats.overflows == 0);
+
+    ctlq_destroy(q);
+}
+
+TEST_CASE("Thread sends only the latest value while bus is busy", "[ctlq]") {
+    ctlq_t *q = ctlq_create(8, nullptr, nullptr);
+    sent.clear();
+    REQUIRE(ctlq_start(q));
+
+    hold = true;
+
+    ctlq_cmd_t c = cmd(1, 0);
+    ctlq_put(q, &c);
+
+    /* Wait for the thread to take the first one */
+    ctlq_stats_t stats;
+    do {
+        std::this_thread::yield();
+        ctlq_stats(q, &stats);
+    } while (stats.max_pending == 0);
+
+    for (int32_t i = 1; i <= 1000; i++) {
+        c = cmd(1, i);
+        ctlq_put(q, &c);
+    }
+    hold = false;
+    ctlq_flush(q);
+
+    REQUIRE(sent.back() == 1000);
+    REQUIRE(sent.size() <= 3);
+
+    ctlq_destroy(q);
+}
+
+TEST_CASE("Full queue executes in caller after pending", "[ctlq]") {
+    ctlq_t *q = ctlq_create(2, nullptr, nullptr);
+    sent.clear();
+
+    for (int32_t i = 0; i < 5; i++) {
+        ctlq_cmd_t c = cmd(0, i);
+        ctlq_put(q, &c);
+    }
+    ctlq_flush(q);
+
+    REQUIRE(sent == std::vector<int32_t>{0, 1, 2, 3, 4});
+
+    ctlq_stats_t stats;
+    ctlq_stats(q, &stats);
+    REQUIRE(stats.overflows == 1);
+
+    ctlq_destroy(q);
+}
+
+static std::atomic<int> locked;
+
+static void lock_fn() {
+    locked++;
+}
+
+static void unlock_fn() {
+    locked--;
+}
+
+static void check_lock_fn(const ctlq_cmd_t *) {
+    sent.push_back(locked);
+}
+
+TEST_CASE("Commands are executed under lock", "[ctlq]") {
+    ctlq_t *q = ctlq_create(8, lock_fn, unlock_fn);
+    sent.clear();
+    REQUIRE(ctlq_start(q));
+
+    ctlq_cmd_t c = {};
+    c.fn = check_lock_fn;
+
+    for (int i = 0; i < 3; i++) {
+        ctlq_put(q, &c);
+    }
+    ctlq_flush(q);
+
+    REQUIRE(sent == std::vector<int32_t>{1, 1, 1});
+    REQUIRE(locked == 0);
+
+    ctlq_stats_t stats;
+    ctlq_stats(q, &stats);
+    REQUIRE(stats.commands == 3);
+
+    ctlq_destroy(q);
+}
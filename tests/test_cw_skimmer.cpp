@@ -0,0 +1,164 @@
+extern "C" {
+    #include "../src/cw_decoder.h"
+}
+#include "../src/skimmer/skimmer.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#define RATE        44100
+#define CHANNELS    512
+#define BLOCK       1024
+#define RAMP        0.005f  /* s, keying edges */
+
+struct Station {
+    float               freq;
+    float               amp;
+    std::vector<bool>   keying;     /* Per 1 ms */
+};
+
+static const char * morse_code(char c) {
+    for (cw_characters_t *ch = &cw_characters[0]; ch->morse; ch++) {
+        if (ch->character[0] == c && ch->character[1] == '\0') {
+            return ch->morse;
+        }
+    }
+    return NULL;
+}
+
+static Station make_station(float freq, float amp, int wpm, const char *text) {
+    Station st = {freq, amp, {}};
+    int     dot = 1200 / wpm;
+
+    auto key = [&](bool on, int dots) {
+        st.keying.insert(st.keying.end(), dots * dot, on);
+    };
+
+    for (const char *c = text; *c; c++) {
+        if (*c == ' ') {
+            key(false, 4);
+            continue;
+        }
+        for (const char *e = morse_code(*c); *e; e++) {
+            key(true, *e == '.' ? 1 : 3);
+            key(false, 1);
+        }
+        key(false, 2);
+    }
+    key(false, 7);
+    return st;
+}
+
+static void run(skimmer_t *s, std::vector<Station> &stations, float sec, float noise = 0.02f) {
+    std::mt19937                    gen(1);
+    std::normal_distribution<float> norm(0.0f, noise);
+    std::vector<float>              env(stations.size(), 0.0f);
+    cfloat                          buf[BLOCK];
+    size_t                          total = sec * RATE;
+
+    for (size_t t = 0; t < total; t += BLOCK) {
+        for (size_t i = 0; i < BLOCK; i++) {
+            size_t  n = t + i;
+            size_t  ms = n * 1000 / RATE;
+            cfloat  x(norm(gen), norm(gen));
+
+            for (size_t k = 0; k < stations.size(); k++) {
+                Station &st = stations[k];
+                bool    on = ms < st.keying.size() && st.keying[ms];
+
+                env[k] += on ? 1.0f / (RAMP * RATE) : -1.0f / (RAMP * RATE);
+                env[k] = std::fmin(1.0f, std::fmax(0.0f, env[k]));
+
+                float phase = 2.0f * M_PI * st.freq * n / RATE;
+
+                x += st.amp * env[k] * cfloat(cosf(phase), sinf(phase));
+            }
+            buf[i] = x;
+        }
+        skimmer_put_audio_samples(s, BLOCK, buf);
+    }
+}
+
+static const skimmer_item_t * find(std::vector<skimmer_item_t> &items, float freq) {
+    for (auto &item : items) {
+        if (std::fabs(item.freq - freq) <= (float) RATE / CHANNELS) {
+            return &item;
+        }
+    }
+    return NULL;
+}
+
+TEST_CASE("Skimmer decodes stations in own channels", "[cw_skimmer]") {
+    skimmer_t               *s = skimmer_create(RATE, CHANNELS, 150, 3000, 8);
+    std::vector<Station>    stations = {
+        make_station(600.0f, 0.05f, 20, "CQ CQ DE R1CBU R1CBU K"),
+        make_station(1130.0f, 0.02f, 28, "CQ TEST UA3ABC UA3ABC TEST"),
+        make_station(2200.0f, 0.03f, 16, "TU 5NN DL1ABC 5NN"),
+    };
+
+    run(s, stations, 15.0f);
+
+    std::vector<skimmer_item_t> items(8);
+
+    items.resize(skimmer_list(s, items.data(), items.size()));
+
+    REQUIRE(items.size() == 3);
+    REQUIRE(skimmer_active(s) == 3);
+
+    for (size_t i = 1; i < items.size(); i++) {
+        REQUIRE(items[i - 1].freq < items[i].freq);
+    }
+
+    const skimmer_item_t *item = find(items, 600.0f);
+
+    REQUIRE(item);
+    REQUIRE(std::string(item->call) == "R1CBU");
+    REQUIRE(std::abs(item->wpm - 20) <= 3);
+
+    item = find(items, 1130.0f);
+    REQUIRE(item);
+    REQUIRE(std::string(item->call) == "UA3ABC");
+    REQUIRE(std::abs(item->wpm - 28) <= 3);
+
+    item = find(items, 2200.0f);
+    REQUIRE(item);
+    REQUIRE(std::string(item->call) == "DL1ABC");
+    REQUIRE(std::abs(item->wpm - 16) <= 3);
+
+    skimmer_destroy(s);
+}
+
+TEST_CASE("Skimmer keeps decoders off the noise", "[cw_skimmer]") {
+    skimmer_t               *s = skimmer_create(RATE, CHANNELS, 150, 3000, 8);
+    std::vector<Station>    stations;
+
+    run(s, stations, 10.0f);
+
+    REQUIRE(skimmer_active(s) == 0);
+
+    skimmer_destroy(s);
+}
+
+TEST_CASE("Skimmer returns decoders after the silence", "[cw_skimmer]") {
+    skimmer_t               *s = skimmer_create(RATE, CHANNELS, 150, 3000, 2);
+    std::vector<Station>    stations = {
+        make_station(500.0f, 0.05f, 20, "CQ R1CBU"),
+        make_station(900.0f, 0.05f, 20, "CQ UA3ABC"),
+        make_station(1500.0f, 0.05f, 20, "CQ DL1ABC"),
+    };
+
+    run(s, stations, 3.0f);
+    REQUIRE(skimmer_active(s) == 2);
+
+    std::vector<Station> silence;
+
+    run(s, silence, 20.0f);
+    REQUIRE(skimmer_active(s) == 0);
+
+    skimmer_destroy(s);
+}
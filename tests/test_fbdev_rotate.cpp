@@ -0,0 +1,181 @@
+extern "C" {
+    #include "../lv_drivers/display/fbdev_rotate.h"
+}
+#include "../lv_drivers/display/fbdev.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Physical framebuffer, logical screen is 800 x 480 with 90 degrees rotation
+static const uint32_t FB_W = 480;
+static const uint32_t FB_H = 800;
+
+struct area_t {
+    int32_t x1, y1, x2, y2;
+};
+
+static std::vector<uint32_t> random_pixels(std::mt19937 &gen, size_t n) {
+    std::vector<uint32_t> res(n);
+    for (auto &x : res) {
+        x = gen();
+    }
+    return res;
+}
+
+// Same as draw_buf_rotate_90() in LVGL's lv_refr.c
+static void lvgl_rotate_90(bool invert_i, int32_t area_w, int32_t area_h, const uint32_t *orig_color_p,
+                           uint32_t *rot_buf) {
+    uint32_t invert = (area_w * area_h) - 1;
+    uint32_t initial_i = ((area_w - 1) * area_h);
+    for (int32_t y = 0; y < area_h; y++) {
+        uint32_t i = initial_i + y;
+        if (invert_i)
+            i = invert - i;
+        for (int32_t x = 0; x < area_w; x++) {
+            rot_buf[i] = *(orig_color_p++);
+            if (invert_i)
+                i += area_h;
+            else
+                i -= area_h;
+        }
+    }
+}
+
+// LVGL's software rotation by 90 degrees and flush of the rotated area to the framebuffer
+static void lvgl_flush_90(std::vector<uint32_t> &fb, const area_t &area, const uint32_t *pixels) {
+    int32_t w = area.x2 - area.x1 + 1;
+    int32_t h = area.y2 - area.y1 + 1;
+    std::vector<uint32_t> rot(w * h);
+
+    lvgl_rotate_90(false, w, h, pixels, rot.data());
+
+    area_t fb_area;
+    fb_area.y2 = FB_H - area.x1 - 1;
+    fb_area.y1 = FB_H - area.x2 - 1;
+    fb_area.x1 = area.y1;
+    fb_area.x2 = area.y2;
+
+    int32_t fb_w = fb_area.x2 - fb_area.x1 + 1;
+    for (int32_t y = fb_area.y1; y <= fb_area.y2; y++) {
+        for (int32_t x = fb_area.x1; x <= fb_area.x2; x++) {
+            fb[y * FB_W + x] = rot[(y - fb_area.y1) * fb_w + (x - fb_area.x1)];
+        }
+    }
+}
+
+TEST_CASE("Rotation by 90 matches LVGL", "[fbdev]") {
+    std::mt19937 gen(1);
+    std::vector<uint32_t> expected(FB_W * FB_H, 0);
+    std::vector<uint32_t> fb(FB_W * FB_H, 0);
+    std::vector<area_t> areas = {
+        {0, 0, 799, 479}, {0, 0, 0, 0}, {799, 479, 799, 479}, {1, 2, 4, 5},
+        {13, 7, 90, 33}, {100, 200, 163, 263}, {0, 100, 799, 102}, {600, 0, 601, 479},
+    };
+
+    for (int i = 0; i < 50; i++) {
+        int32_t x1 = gen() % 800;
+        int32_t y1 = gen() % 480;
+        areas.push_back({x1, y1, x1 + (int32_t)(gen() % (800 - x1)), y1 + (int32_t)(gen() % (480 - y1))});
+    }
+
+    for (auto &area : areas) {
+        int32_t w = area.x2 - area.x1 + 1;
+        int32_t h = area.y2 - area.y1 + 1;
+        auto pixels = random_pixels(gen, w * h);
+
+        lvgl_flush_90(expected, area, pixels.data());
+
+        uint32_t *dst = fb.data() + (FB_H - 1 - area.x2) * FB_W + area.y1;
+        fbdev_rotate_copy(dst, FB_W, pixels.data(), w, w, h, FBDEV_ROT_90);
+
+        REQUIRE(fb == expected);
+    }
+}
+
+TEST_CASE("Rotation by 180 and 270", "[fbdev]") {
+    std::mt19937 gen(2);
+
+    for (uint32_t w : {1u, 3u, 4u, 37u, 64u}) {
+        for (uint32_t h : {1u, 5u, 8u, 33u}) {
+            // Source with stride bigger than width
+            uint32_t src_stride = w + 3;
+            auto src = random_pixels(gen, src_stride * h);
+
+            std::vector<uint32_t> out(w * h);
+            fbdev_rotate_copy(out.data(), w, src.data(), src_stride, w, h, FBDEV_ROT_180);
+            for (uint32_t y = 0; y < h; y++) {
+                for (uint32_t x = 0; x < w; x++) {
+                    REQUIRE(out[y * w + x] == src[(h - 1 - y) * src_stride + (w - 1 - x)]);
+                }
+            }
+
+            // Output is h wide and w high
+            std::vector<uint32_t> out270(w * h);
+            fbdev_rotate_copy(out270.data(), h, src.data(), src_stride, w, h, FBDEV_ROT_270);
+            for (uint32_t r = 0; r < w; r++) {
+                for (uint32_t c = 0; c < h; c++) {
+                    REQUIRE(out270[r * h + c] == src[(h - 1 - c) * src_stride + r]);
+                }
+            }
+
+            std::vector<uint32_t> out0(w * h);
+            fbdev_rotate_copy(out0.data(), w, src.data(), src_stride, w, h, FBDEV_ROT_NONE);
+            for (uint32_t y = 0; y < h; y++) {
+                for (uint32_t x = 0; x < w; x++) {
+                    REQUIRE(out0[y * w + x] == src[y * src_stride + x]);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Flush of hardware rotated areas", "[fbdev]") {
+    std::mt19937 gen(3);
+    std::vector<uint32_t> expected(FB_W * FB_H, 0);
+    std::vector<uint32_t> fb(FB_W * FB_H, 0);
+
+    lv_disp_draw_buf_t  draw_buf;
+    lv_disp_drv_t       drv;
+
+    lv_disp_draw_buf_init(&draw_buf, fb.data(), NULL, 0);
+    lv_disp_drv_init(&drv);
+    drv.draw_buf = &draw_buf;
+    drv.rotated = LV_DISP_ROT_90;
+    drv.sw_rotate = 0;
+
+    fbdev_init_mem(fb.data(), FB_W, FB_H);
+
+    // Logical areas right of the physical width, and partly off the screen
+    std::vector<area_t> areas = {
+        {600, 0, 799, 479}, {0, 0, 799, 479}, {479, 100, 480, 200}, {700, 400, 900, 600},
+    };
+
+    for (auto &area : areas) {
+        int32_t w = area.x2 - area.x1 + 1;
+        int32_t h = area.y2 - area.y1 + 1;
+        auto pixels = random_pixels(gen, w * h);
+
+        // Expected is the visible part only
+        area_t vis = {area.x1, area.y1, std::min(area.x2, 799), std::min(area.y2, 479)};
+        int32_t vis_w = vis.x2 - vis.x1 + 1;
+        std::vector<uint32_t> vis_pixels;
+
+        for (int32_t y = vis.y1; y <= vis.y2; y++) {
+            auto row = pixels.begin() + (y - area.y1) * w;
+            vis_pixels.insert(vis_pixels.end(), row, row + vis_w);
+        }
+        lvgl_flush_90(expected, vis, vis_pixels.data());
+
+        lv_area_t lv_area = {(lv_coord_t) area.x1, (lv_coord_t) area.y1, (lv_coord_t) area.x2, (lv_coord_t) area.y2};
+
+        draw_buf.flushing = 1;
+        fbdev_flush(&drv, &lv_area, (lv_color_t *) pixels.data());
+
+        REQUIRE(draw_buf.flushing == 0);
+        REQUIRE(fb == expected);
+    }
+}
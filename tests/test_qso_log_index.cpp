@@ -0,0 +1,45 @@
+extern "C" {
+    #include "../src/qso_log_index.h"
+}
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdio>
+
+TEST_CASE("Worked before lookup", "[qso_log_index]") {
+    qso_log_index_t *idx = qso_log_index_create();
+
+    REQUIRE(qso_log_index_search(idx, "R2RFE", MODE_FT8, BAND_20M) == SEARCH_WORKED_NO);
+
+    qso_log_index_add(idx, "R2RFE", BAND_20M, MODE_FT8);
+    REQUIRE(qso_log_index_size(idx) == 1);
+    REQUIRE(qso_log_index_search(idx, "r2rfe", MODE_FT8, BAND_20M) == SEARCH_WORKED_SAME_MODE);
+    REQUIRE(qso_log_index_search(idx, "R2RFE", MODE_FT4, BAND_20M) == SEARCH_WORKED_YES);
+    REQUIRE(qso_log_index_search(idx, "R2RFE", MODE_FT8, BAND_40M) == SEARCH_WORKED_YES);
+    REQUIRE(qso_log_index_search(idx, "R2RF", MODE_FT8, BAND_20M) == SEARCH_WORKED_NO);
+
+    qso_log_index_add(idx, "r2rfe", BAND_40M, MODE_FT8);
+    REQUIRE(qso_log_index_size(idx) == 1);
+    REQUIRE(qso_log_index_search(idx, "R2RFE", MODE_FT8, BAND_40M) == SEARCH_WORKED_SAME_MODE);
+
+    qso_log_index_destroy(idx);
+}
+
+TEST_CASE("Worked before index grows", "[qso_log_index]") {
+    qso_log_index_t *idx = qso_log_index_create();
+    char            call[16];
+
+    for (int i = 0; i < 20000; i++) {
+        snprintf(call, sizeof(call), "X%dAB", i);
+        qso_log_index_add(idx, call, BAND_20M, MODE_FT8);
+    }
+    REQUIRE(qso_log_index_size(idx) == 20000);
+
+    for (int i = 0; i < 20000; i++) {
+        snprintf(call, sizeof(call), "X%dAB", i);
+        REQUIRE(qso_log_index_search(idx, call, MODE_FT8, BAND_20M) == SEARCH_WORKED_SAME_MODE);
+    }
+    REQUIRE(qso_log_index_search(idx, "X20000AB", MODE_FT8, BAND_20M) == SEARCH_WORKED_NO);
+
+    qso_log_index_destroy(idx);
+}
@@ -0,0 +1,168 @@
+extern "C" {
+    #include "../src/ring/spsc.h"
+    #include "../src/ring/mpsc.h"
+}
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+TEST_CASE("SPSC ring order and overrun", "[ring]") {
+    spsc_ring_t *ring = spsc_ring_create(sizeof(uint32_t), 6);
+    REQUIRE(spsc_ring_capacity(ring) == 8);
+    REQUIRE(spsc_ring_read_begin(ring) == nullptr);
+
+    for (uint32_t i = 0; i < 10; i++) {
+        spsc_ring_put(ring, &i);
+    }
+    REQUIRE(spsc_ring_count(ring) == 8);
+
+    uint32_t overruns, max_count;
+    spsc_ring_stats(ring, &overruns, &max_count);
+    REQUIRE(overruns == 2);
+    REQUIRE(max_count == 8);
+
+    for (uint32_t i = 0; i < 8; i++) {
+        uint32_t *item = (uint32_t *)spsc_ring_read_begin(ring);
+        REQUIRE(item != nullptr);
+        REQUIRE(*item == i);
+        spsc_ring_read_end(ring);
+    }
+    REQUIRE(spsc_ring_read_begin(ring) == nullptr);
+
+    spsc_ring_destroy(ring);
+}
+
+TEST_CASE("SPSC ring clear", "[ring]") {
+    spsc_ring_t *ring = spsc_ring_create(sizeof(uint32_t), 4);
+    for (uint32_t i = 0; i < 3; i++) {
+        spsc_ring_put(ring, &i);
+    }
+    spsc_ring_clear(ring);
+    REQUIRE(spsc_ring_count(ring) == 0);
+    REQUIRE(spsc_ring_read_begin(ring) == nullptr);
+    spsc_ring_destroy(ring);
+}
+
+TEST_CASE("SPSC ring between threads", "[ring]") {
+    const uint32_t count = 200000;
+    spsc_ring_t *ring = spsc_ring_create(sizeof(uint32_t), 64);
+
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < count; i++) {
+            while (!spsc_ring_put(ring, &i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    bool ordered = true;
+    while (expected < count) {
+        uint32_t *item = (uint32_t *)spsc_ring_read_begin(ring);
+        if (!item) {
+            std::this_thread::yield();
+            continue;
+        }
+        ordered &= (*item == expected);
+        expected++;
+        spsc_ring_read_end(ring);
+    }
+    producer.join();
+
+    REQUIRE(ordered);
+    spsc_ring_destroy(ring);
+}
+
+TEST_CASE("MPSC ring order and overrun", "[ring]") {
+    mpsc_ring_t *ring = mpsc_ring_create(sizeof(uint32_t), 6);
+    REQUIRE(mpsc_ring_capacity(ring) == 8);
+    REQUIRE(mpsc_ring_read_begin(ring) == nullptr);
+
+    for (uint32_t i = 0; i < 10; i++) {
+        mpsc_ring_put(ring, &i);
+    }
+    REQUIRE(mpsc_ring_count(ring) == 8);
+
+    uint32_t overruns, max_count;
+    mpsc_ring_stats(ring, &overruns, &max_count);
+    REQUIRE(overruns == 2);
+    REQUIRE(max_count == 8);
+
+    for (uint32_t i = 0; i < 8; i++) {
+        uint32_t *item = (uint32_t *)mpsc_ring_read_begin(ring);
+        REQUIRE(item != nullptr);
+        REQUIRE(*item == i);
+        mpsc_ring_read_end(ring);
+    }
+    REQUIRE(mpsc_ring_read_begin(ring) == nullptr);
+
+    uint32_t v = 100;
+    REQUIRE(mpsc_ring_put(ring, &v));
+    REQUIRE(*(uint32_t *)mpsc_ring_read_begin(ring) == 100);
+    mpsc_ring_read_end(ring);
+
+    mpsc_ring_destroy(ring);
+}
+
+TEST_CASE("MPSC ring hides unpublished slot", "[ring]") {
+    mpsc_ring_t *ring = mpsc_ring_create(sizeof(uint32_t), 4);
+
+    uint32_t *first = (uint32_t *)mpsc_ring_write_begin(ring);
+    uint32_t two = 2;
+    mpsc_ring_put(ring, &two);
+    REQUIRE(mpsc_ring_read_begin(ring) == nullptr);
+
+    *first = 1;
+    mpsc_ring_write_end(ring, first);
+    REQUIRE(*(uint32_t *)mpsc_ring_read_begin(ring) == 1);
+    mpsc_ring_read_end(ring);
+    REQUIRE(*(uint32_t *)mpsc_ring_read_begin(ring) == 2);
+    mpsc_ring_read_end(ring);
+
+    mpsc_ring_destroy(ring);
+}
+
+TEST_CASE("MPSC ring between threads", "[ring]") {
+    const uint32_t producers = 4;
+    const uint32_t count = 50000;
+    mpsc_ring_t *ring = mpsc_ring_create(sizeof(uint32_t), 64);
+    std::vector<std::thread> threads;
+
+    for (uint32_t p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t item = (p << 24) | i;
+
+                while (!mpsc_ring_put(ring, &item)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<uint32_t> expected(producers, 0);
+    bool ordered = true;
+
+    for (uint32_t n = 0; n < producers * count;) {
+        uint32_t *item = (uint32_t *)mpsc_ring_read_begin(ring);
+        if (!item) {
+            std::this_thread::yield();
+            continue;
+        }
+        uint32_t p = *item >> 24;
+        ordered &= (p < producers) && ((*item & 0xFFFFFF) == expected[p]);
+        expected[p]++;
+        n++;
+        mpsc_ring_read_end(ring);
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    REQUIRE(ordered);
+    REQUIRE(mpsc_ring_read_begin(ring) == nullptr);
+    mpsc_ring_destroy(ring);
+}
@@ -0,0 +1,107 @@
+extern "C" {
+    #include "../src/simd/simd.h"
+}
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+
+using Catch::Matchers::WithinAbs;
+using Catch::Matchers::WithinRel;
+
+// Odd size to check tails of vectorized loops
+static const size_t N = 1027;
+
+static std::vector<std::complex<float>> random_samples(size_t n) {
+    std::mt19937 gen(42);
+    std::normal_distribution<float> dist(0.0f, 0.01f);
+    std::vector<std::complex<float>> res(n);
+    for (auto &x : res) {
+        x = {dist(gen), dist(gen)};
+    }
+    return res;
+}
+
+TEST_CASE("Power of complex samples", "[simd]") {
+    auto x = random_samples(N);
+    std::vector<float> out(N);
+
+    simd_power_cf((float *)x.data(), out.data(), N);
+    for (size_t i = 0; i < N; i++) {
+        REQUIRE_THAT(out[i], WithinRel(std::norm(x[i]), 1e-6f));
+    }
+}
+
+TEST_CASE("Exponential averaging of power", "[simd]") {
+    auto x = random_samples(N);
+    std::vector<float> psd(N), ref(N);
+    float alpha = 0.4f, gamma = 1.0f - alpha;
+
+    for (size_t i = 0; i < N; i++) {
+        psd[i] = ref[i] = 1e-4f * (i % 17);
+    }
+    simd_power_ema_cf((float *)x.data(), psd.data(), gamma, alpha, N);
+    for (size_t i = 0; i < N; i++) {
+        ref[i] = gamma * ref[i] + alpha * std::norm(x[i]);
+        REQUIRE_THAT(psd[i], WithinRel(ref[i], 1e-6f));
+    }
+}
+
+TEST_CASE("FFT shift with limit and scale", "[simd]") {
+    for (size_t n : {N, (size_t)800, (size_t)1024}) {
+        std::vector<float> x(n), out(n);
+        for (size_t i = 0; i < n; i++) {
+            x[i] = (i % 3) ? (float)i : 0.0f;
+        }
+        simd_fftshift_clamp(x.data(), out.data(), 0.5f, 2.0f, n);
+        for (size_t i = 0; i < n; i++) {
+            float ref = std::max(0.5f, x[(i + n / 2) % n]) * 2.0f;
+            REQUIRE(out[i] == ref);
+        }
+    }
+}
+
+TEST_CASE("Fast power to dB", "[simd]") {
+    std::vector<float> x, out;
+    // From LIQUID_SPGRAM_PSD_MIN to large values
+    for (float v = 1e-12f; v < 1e6f; v *= 1.0137f) {
+        x.push_back(v);
+    }
+    out.resize(x.size());
+    simd_power_to_db(x.data(), out.data(), -30.0f, x.size());
+    for (size_t i = 0; i < x.size(); i++) {
+        REQUIRE_THAT(out[i], WithinAbs(10.0f * log10f(x[i]) - 30.0f, 1e-4));
+    }
+}
+
+TEST_CASE("Waterfall row interpolation with palette", "[simd]") {
+    std::mt19937 gen(7);
+    std::vector<uint8_t> src(N + 1);
+    std::vector<uint16_t> idx(N);
+    std::vector<uint8_t> frac(N);
+    std::vector<uint32_t> lut(256);
+    std::vector<uint32_t> out(N);
+    const int32_t offset = 3;
+
+    for (auto &x : src) {
+        x = gen() & 0xFF;
+    }
+    for (size_t i = 0; i < 256; i++) {
+        lut[i] = i * 0x010203;
+    }
+    for (size_t i = 0; i < N; i++) {
+        idx[i] = (gen() % (N - 4)) + offset;
+        frac[i] = gen() % 8;
+    }
+
+    simd_interp_lut(src.data(), idx.data(), frac.data(), offset, lut.data(), out.data(), N);
+    for (size_t i = 0; i < N; i++) {
+        const uint8_t *p = src.data() + (idx[i] - offset);
+        uint8_t y = p[0] + ((frac[i] * (p[1] - p[0])) >> 3);
+        REQUIRE(out[i] == lut[y]);
+    }
+}
@@ -0,0 +1,145 @@
+#include "../src/cfg/subjects.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static void count_cb(Subject *subj, void *user_data) {
+    (*(int *)user_data)++;
+}
+
+static void atomic_count_cb(Subject *subj, void *user_data) {
+    (*(std::atomic<int> *)user_data)++;
+}
+
+static void record_cb(Subject *subj, void *user_data) {
+    ((std::vector<int32_t> *)user_data)->push_back(subject_get_int(subj));
+}
+
+TEST_CASE("Observer is called on change only", "[subjects]") {
+    Subject *subj = subject_create_int(1);
+    int     calls = 0;
+
+    Observer *observer = subject_add_observer(subj, count_cb, &calls);
+
+    subject_set_int(subj, 1);
+    REQUIRE(calls == 0);
+    subject_set_int(subj, 2);
+    REQUIRE(calls == 1);
+
+    observer_del(observer);
+    subject_set_int(subj, 3);
+    REQUIRE(calls == 1);
+    delete subj;
+}
+
+static Observer *self_del_observer;
+
+static void self_del_cb(Subject *subj, void *user_data) {
+    (*(int *)user_data)++;
+    observer_del(self_del_observer);
+}
+
+TEST_CASE("Observer could delete itself during notification", "[subjects]") {
+    Subject *subj = subject_create_int(0);
+    int     calls = 0, other_calls = 0;
+
+    self_del_observer = subject_add_observer(subj, self_del_cb, &calls);
+    Observer *other = subject_add_observer(subj, count_cb, &other_calls);
+
+    subject_set_int(subj, 1);
+    subject_set_int(subj, 2);
+    REQUIRE(calls == 1);
+    REQUIRE(other_calls == 2);
+
+    observer_del(other);
+    delete subj;
+}
+
+TEST_CASE("Delayed observer is called at once in own thread", "[subjects]") {
+    Subject *subj = subject_create_int(0);
+    int     calls = 0;
+
+    ObserverDelayed *observer = subject_add_delayed_observer(subj, count_cb, &calls);
+
+    subject_set_int(subj, 1);
+    REQUIRE(calls == 1);
+    observer_delayed_notify_all();
+    REQUIRE(calls == 1);
+
+    observer_delayed_del(observer);
+    delete subj;
+}
+
+TEST_CASE("Delayed notifications from other thread are coalesced", "[subjects]") {
+    Subject                 *a = subject_create_int(0);
+    Subject                 *b = subject_create_int(0);
+    std::vector<int32_t>    values;
+
+    ObserverDelayed *obs_a = subject_add_delayed_observer(a, record_cb, &values);
+    ObserverDelayed *obs_b = subject_add_delayed_observer(b, record_cb, &values);
+
+    std::thread([&]() {
+        for (int32_t i = 1; i <= 100; i++) {
+            subject_set_int(b, i * 10);
+            subject_set_int(a, i);
+        }
+    }).join();
+
+    REQUIRE(values.empty());
+    observer_delayed_notify_all();
+    REQUIRE(values == std::vector<int32_t>{1000, 100});
+
+    observer_delayed_notify_all();
+    REQUIRE(values.size() == 2);
+
+    std::thread([&]() { subject_set_int(a, 5); }).join();
+    observer_delayed_notify_all();
+    REQUIRE(values.back() == 5);
+
+    observer_delayed_del(obs_a);
+    observer_delayed_del(obs_b);
+    delete a;
+    delete b;
+}
+
+TEST_CASE("Deleted delayed observer is not called", "[subjects]") {
+    Subject *subj = subject_create_int(0);
+    int     calls = 0;
+
+    ObserverDelayed *observer = subject_add_delayed_observer(subj, count_cb, &calls);
+
+    std::thread([&]() { subject_set_int(subj, 1); }).join();
+    observer_delayed_del(observer);
+    observer_delayed_notify_all();
+    REQUIRE(calls == 0);
+    delete subj;
+}
+
+TEST_CASE("Subscribe and unsubscribe while other thread sets", "[subjects]") {
+    Subject             *subj = subject_create_int(0);
+    std::atomic<bool>   stop = false;
+    std::atomic<int>    calls = 0;
+
+    std::thread setter([&]() {
+        for (int32_t i = 1; !stop; i++) {
+            subject_set_int(subj, i);
+        }
+    });
+
+    for (int i = 0; i < 2000; i++) {
+        Observer        *observer = subject_add_observer(subj, atomic_count_cb, &calls);
+        ObserverDelayed *delayed = subject_add_delayed_observer(subj, atomic_count_cb, &calls);
+
+        observer_delayed_notify_all();
+        observer_del(observer);
+        observer_delayed_del(delayed);
+    }
+
+    stop = true;
+    setter.join();
+    observer_delayed_notify_all();
+    delete subj;
+}